@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <CLI11.hpp>
+
+#include "Types.hpp"
+#include "Utils.hpp"
+#include "../Setups.hpp"
+
+#include "AssetPack.hpp"
+#include "XxHash.hpp"
+
+namespace AAP {
+    namespace {
+        struct PackedFile {
+            std::filesystem::path path;
+            std::string name;
+            u64 size;
+            /// XXH64 of the contents, lets the engine share identical assets without hashing them at load time
+            u64 contentHash;
+            /// Output of CompressChunked, empty if the file is stored as is
+            std::string compressed;
+        };
+
+        bool WritePadding(std::ofstream& file, u64 count) {
+            static const char zeros[4096] = {};
+
+            while (count > 0) {
+                const u64 chunk = std::min<u64>(count, sizeof(zeros));
+                file.write(zeros, chunk);
+                count -= chunk;
+            }
+
+            return file.good();
+        }
+    } // namespace
+
+    void CLIPackSetup(CLI::App& app) {
+        CLI::App* pack = app.add_subcommand("pack", "Packs a directory into a single memory-mappable asset pack");
+
+        static std::string directory = "";
+        pack->add_option("-d,--directory", directory, "Directory whose files are packed, recursively")->required();
+
+        static std::string outputName = "assets.axpk";
+        pack->add_option("-o,--output", outputName, "Name of the output file");
+
+        static u32 alignment = Axle::AssetPack::DEFAULT_ALIGNMENT;
+        pack->add_option("-a,--alignment", alignment, "Alignment in bytes of every packed file, a power of two");
+
+        static bool compress = false;
+        pack->add_flag("-c,--compress", compress, "Compress the files that shrink, in independent chunks");
+
+        static u32 chunkSize = Axle::AssetPack::DEFAULT_CHUNK_SIZE;
+        pack->add_option("--chunk-size", chunkSize, "Uncompressed size in bytes of every compressed chunk");
+
+        pack->callback([&]() {
+            const std::filesystem::path root = directory;
+
+            if (!std::filesystem::is_directory(root)) {
+                fprintf(stderr, "pack: '%s' is not a directory\n", directory.c_str());
+                return;
+            }
+
+            if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+                fprintf(stderr, "pack: the alignment must be a power of two, got %u\n", alignment);
+                return;
+            }
+
+            if (chunkSize == 0) {
+                fprintf(stderr, "pack: the chunk size can't be 0\n");
+                return;
+            }
+
+            // Gather the files, skipping the output in case it's written inside the packed directory
+            std::error_code ec;
+            const std::filesystem::path output = std::filesystem::weakly_canonical(outputName, ec);
+            std::vector<PackedFile> files;
+
+            for (const auto& item : std::filesystem::recursive_directory_iterator(root)) {
+                if (!item.is_regular_file() || std::filesystem::weakly_canonical(item.path(), ec) == output)
+                    continue;
+
+                if (item.file_size() == 0) {
+                    fprintf(stderr, "pack: skipping empty file '%s'\n", item.path().string().c_str());
+                    continue;
+                }
+
+                std::string name = std::filesystem::relative(item.path(), root).lexically_normal().generic_string();
+                files.push_back({item.path(), std::move(name), item.file_size(), 0, {}});
+            }
+
+            // Sorted so the same directory always produces the same pack
+            std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) {
+                return a.name < b.name;
+            });
+
+            // Already compressed formats (png, jpg, ...) don't shrink, those are stored as is
+            u64 uncompressedSize = 0;
+            for (PackedFile& file : files) {
+                std::vector<u8> content = ReadFile(file.path.string().c_str());
+                file.contentHash = Axle::XxHash::Hash64(content.data(), content.size());
+
+                if (!compress)
+                    continue;
+
+                std::string compressed = Axle::AssetPack::CompressChunked(
+                    reinterpret_cast<const char*>(content.data()), content.size(), chunkSize);
+
+                if (compressed.size() < content.size())
+                    file.compressed = std::move(compressed);
+            }
+
+            std::vector<Axle::AssetPack::TocFile> tocFiles;
+            for (const PackedFile& file : files) {
+                const bool compressed = !file.compressed.empty();
+                tocFiles.push_back({file.name,
+                                    file.size,
+                                    compressed ? file.compressed.size() : file.size,
+                                    compressed ? Axle::AssetPack::ENTRY_COMPRESSED : 0,
+                                    file.contentHash});
+                uncompressedSize += file.size;
+            }
+
+            const Axle::AssetPack::Toc toc = Axle::AssetPack::BuildToc(tocFiles, alignment, chunkSize);
+
+            // Write everything
+            std::ofstream out(outputName, std::ios::binary);
+
+            if (!out.is_open()) {
+                fprintf(stderr, "pack: could not open '%s'\n", outputName.c_str());
+                return;
+            }
+
+            out.write(reinterpret_cast<const char*>(&toc.header), sizeof(toc.header));
+            out.write(reinterpret_cast<const char*>(toc.entries.data()),
+                      toc.entries.size() * sizeof(Axle::AssetPack::Entry));
+            out.write(toc.names.data(), toc.names.size());
+
+            u64 written = toc.header.namesOffset + toc.header.namesSize;
+
+            for (u64 i = 0; i < files.size(); ++i) {
+                if (!WritePadding(out, toc.offsets[i] - written)) {
+                    fprintf(stderr, "pack: failed to pack '%s'\n", files[i].path.string().c_str());
+                    return;
+                }
+
+                if (!files[i].compressed.empty()) {
+                    out.write(files[i].compressed.data(), files[i].compressed.size());
+                    written = toc.offsets[i] + files[i].compressed.size();
+                    continue;
+                }
+
+                std::vector<u8> content = ReadFile(files[i].path.string().c_str());
+
+                if (content.size() != files[i].size) {
+                    fprintf(stderr, "pack: failed to pack '%s'\n", files[i].path.string().c_str());
+                    return;
+                }
+
+                out.write(reinterpret_cast<const char*>(content.data()), content.size());
+                written = toc.offsets[i] + files[i].size;
+            }
+
+            if (!out.good()) {
+                fprintf(stderr, "pack: failed to write to '%s'\n", outputName.c_str());
+                return;
+            }
+
+            printf("Packed %zu files into '%s' (%llu bytes, %llu bytes of uncompressed data)\n",
+                   files.size(),
+                   outputName.c_str(),
+                   static_cast<unsigned long long>(toc.header.packSize),
+                   static_cast<unsigned long long>(uncompressedSize));
+        });
+    }
+} // namespace AAP
@@ -9,4 +9,11 @@ namespace AAP {
      * @param app A reference to the CLI app
      * */
     void CLIShaderSetup(CLI::App& app);
+
+    /**
+     * Creates the pack subcommand which is used for packing a directory into a single asset pack
+     *
+     * @param app A reference to the CLI app
+     * */
+    void CLIPackSetup(CLI::App& app);
 } // namespace AAP
@@ -13,6 +13,10 @@ int main(int argc, char** argv) {
     CLIShaderSetup(app);
     // -----------------------------------
 
+    // ASSET PACKING ----------------------
+    CLIPackSetup(app);
+    // -----------------------------------
+
     CLI11_PARSE(app, argc, argv);
     return 0;
 }
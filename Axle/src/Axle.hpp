@@ -10,5 +10,6 @@
 #include "Core/Error/Panic.hpp"
 
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Parallel/Parallel.hpp"
 
 #include "Core/Layer/Layer.hpp"
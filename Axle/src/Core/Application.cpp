@@ -8,6 +8,8 @@
 #include "Core/Core.hpp"
 #include "Core/Events/EventHandler.hpp"
 #include "Core/Events/Event.hpp"
+#include "Core/Resource/FileWatcher.hpp"
+#include "Core/Resource/ResourceManager.hpp"
 #include "Core/Input/InputState.hpp"
 #include "Core/Layer/Layer.hpp"
 #include "Window/Window.hpp"
@@ -112,17 +114,58 @@ namespace Axle {
 
         // Main loop logic
         // ---------------
-        for (Layer* layer : *(app->m_LayerStack))
-            cw::JobSystem::Schedule(
-                [layer, app]() {
+
+        // Every stage runs one node per layer. The graphs are built once and replayed every tick, so a stage only
+        // costs a job per layer and an atomic per node.
+        f64 alpha = 0.0;
+        cw::JobGraph attachGraph;
+        cw::JobGraph updateGraph;
+        cw::JobGraph commitGraph;
+        cw::JobGraph detachGraph;
+
+        for (Layer* layer : *(app->m_LayerStack)) {
+            attachGraph.AddNode(
+                [layer]() {
                     ZoneScopedN("Layer OnAttach");
                     layer->OnAttach();
                 },
+                {},
+                cw::JobPriority::Medium,
+                cw::InvalidThreadIndex,
+                "Layer OnAttach");
+
+            updateGraph.AddNode(
+                [layer, app]() {
+                    ZoneScopedN("Layer update");
+                    layer->OnUpdate(app->m_DeltaTime);
+                },
+                {},
+                cw::JobPriority::Medium,
+                cw::InvalidThreadIndex,
+                "Layer update");
+
+            commitGraph.AddNode(
+                [layer, &alpha]() {
+                    ZoneScopedN("Layer CommitSnapshot");
+                    layer->CommitSnapshot(alpha);
+                },
+                {},
+                cw::JobPriority::Medium,
+                cw::InvalidThreadIndex,
+                "Layer CommitSnapshot");
+
+            detachGraph.AddNode(
+                [layer]() {
+                    ZoneScopedN("Layer OnDettach");
+                    layer->OnDettach();
+                },
+                {},
                 cw::JobPriority::Medium,
                 cw::InvalidThreadIndex,
-                LAYERS_TAG);
+                "Layer OnDettach");
+        }
 
-        AX_SCHEDULE_TAG_AND_WAIT(LAYERS_TAG);
+        co_await attachGraph.Run();
 
         f64 previous = glfwGetTime();
         f64 lag = 0.0;
@@ -143,55 +186,23 @@ namespace Axle {
                 // Update logic
                 // --------------------------
 
-                for (Layer* layer : *(app->m_LayerStack))
-                    cw::JobSystem::Schedule(
-                        [layer, app]() {
-                            ZoneScopedN("Layer update");
-                            layer->OnUpdate(app->m_DeltaTime);
-                        },
-                        cw::JobPriority::Medium,
-                        cw::InvalidThreadIndex,
-                        LAYERS_TAG);
-
-                AX_SCHEDULE_TAG_AND_WAIT(LAYERS_TAG);
+                co_await updateGraph.Run();
                 // --------------------------
                 lag -= app->m_DeltaTime;
                 FrameMarkNamed("Update Tick");
             }
 
-            const f64 alpha = lag / app->m_DeltaTime;
+            alpha = lag / app->m_DeltaTime;
 
-            for (Layer* layer : *(app->m_LayerStack))
-                cw::JobSystem::Schedule(
-                    [layer, alpha]() {
-                        ZoneScopedN("Layer CommitSnapshot");
-                        layer->CommitSnapshot(alpha);
-                    },
-                    cw::JobPriority::Medium,
-                    cw::InvalidThreadIndex,
-                    LAYERS_TAG);
+            co_await commitGraph.Run();
 
-            AX_SCHEDULE_TAG_AND_WAIT(LAYERS_TAG);
-
-            // Sleep until the next tick is due, minus a small margin
+            // Sleep until the next tick is due, the timer wheel wakes us within a few microseconds of it
             f64 timeUntilNextTick = app->m_DeltaTime - lag;
-            // if (timeUntilNextTick > 0.002) // only sleep if more than 2ms away
-            //     std::this_thread::sleep_for(std::chrono::duration<f64>(timeUntilNextTick - 0.001)); // wake 1ms early
-            if (timeUntilNextTick > 0.002) // only sleep if more than 2ms away
-                co_await cw::WaitFor(std::chrono::milliseconds(static_cast<u64>((timeUntilNextTick - 0.001) * 1000)));
+            co_await cw::WaitFor(
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<f64>(timeUntilNextTick)));
         }
 
-        for (Layer* layer : *(app->m_LayerStack))
-            cw::JobSystem::Schedule(
-                [layer]() {
-                    ZoneScopedN("Layer OnDettach");
-                    layer->OnDettach();
-                },
-                cw::JobPriority::Medium,
-                cw::InvalidThreadIndex,
-                LAYERS_TAG);
-
-        AX_SCHEDULE_TAG_AND_WAIT(LAYERS_TAG);
+        co_await detachGraph.Run();
 
         source.request_stop();
         co_return;
@@ -211,6 +222,11 @@ namespace Axle {
             f64 elapsed = current - previous;
             previous = current;
 
+            // Faults the render thread took during the previous frame, a stall on first-touch I/O shows as major ones
+            ResourceManager::SampleFrameFaults();
+            // Job system counters of the previous frame, for the inspector
+            cw::JobSystem::SampleStats();
+
             // Render logic
             // --------------------------
 
@@ -223,12 +239,12 @@ namespace Axle {
                 InputManager::ProcessCurrentPresses();
             }
 
-            {
-                ZoneScopedN("Process Events");
-                EventHandler::ProcessEvents(app->m_LayerStack->rbegin(), app->m_LayerStack->rend());
-            }
+            // No zone around it, it would stay open while the coroutine is suspended and the render thread runs other
+            // jobs. The event jobs have their own zones.
+            co_await EventHandler::ProcessEvents(app->m_LayerStack->rbegin(), app->m_LayerStack->rend());
 
-            AX_SCHEDULE_TAG_AND_WAIT(EVENT_INPUT_TAG);
+            // Swaps in the GPU objects of the assets changed on disk, a single atomic load when nothing changed
+            FileWatcher::Update();
 
             if (!app->m_Minimized.load(std::memory_order_acquire)) {
                 for (Layer* layer : *(app->m_LayerStack)) {
@@ -277,10 +293,8 @@ namespace Axle {
     }
 
     void Application::OnEvent(Event& event) {
-        EventDispatcher dispatcher(event);
-
-        dispatcher.Dispatch<WindowCloseEvent>(AX_BIND_EVENT_FN(OnWindowClose));
-        dispatcher.Dispatch<KeyPressedEvent>(AX_BIND_EVENT_FN(OnKeyPressed));
+        TypedEventDispatcher<WindowCloseEvent, KeyPressedEvent>::Dispatch(
+            event, AX_BIND_EVENT_FN(OnWindowClose), AX_BIND_EVENT_FN(OnKeyPressed));
     }
 
     bool Application::OnKeyPressed(KeyPressedEvent& event) {
@@ -39,6 +39,41 @@ namespace Axle {
     /// Enum that defines the event category
     enum class EventCategory { None = 0, Window, Input, Render };
 
+    /// A set of event types, one bit per EventType
+    using EventMask = u64;
+
+    static_assert(static_cast<u32>(EventType::AppRender) < 64, "EventMask has a bit per event type");
+
+    /// Every event type, what a layer receives unless it subscribes to less
+    inline constexpr EventMask AllEvents = ~EventMask(0);
+
+    constexpr EventMask EventTypeMask(EventType type) {
+        return EventMask(1) << static_cast<u32>(type);
+    }
+
+    /**
+     * @returns The event types from first to last, both included
+     * */
+    constexpr EventMask EventTypeRangeMask(EventType first, EventType last) {
+        return (EventTypeMask(last) << 1) - EventTypeMask(first);
+    }
+
+    /**
+     * @returns The event types of a category, the events are laid out by category in EventType
+     * */
+    constexpr EventMask EventCategoryMask(EventCategory category) {
+        switch (category) {
+        case EventCategory::Window:
+            return EventTypeRangeMask(EventType::WindowClose, EventType::WindowMoved);
+        case EventCategory::Input:
+            return EventTypeRangeMask(EventType::KeyPressed, EventType::MouseScrolled);
+        case EventCategory::Render:
+            return EventTypeMask(EventType::AppRender);
+        default:
+            return 0;
+        }
+    }
+
     /**
      * Base class for all events.
      */
@@ -65,12 +100,12 @@ namespace Axle {
     };
 
     // Macros that simplifies creating different types of events
-#define DEFINE_EVENT_TYPE(type)               \
-    static EventType GetStaticType() {        \
-        return EventType::type;               \
-    }                                         \
-    EventType GetEventType() const override { \
-        return GetStaticType();               \
+#define DEFINE_EVENT_TYPE(type)                  \
+    static constexpr EventType GetStaticType() { \
+        return EventType::type;                  \
+    }                                            \
+    EventType GetEventType() const override {    \
+        return GetStaticType();                  \
     }
 
 #define DEFINE_EVENT_CATEGORY(category)               \
@@ -84,16 +119,18 @@ namespace Axle {
         using EventFn = std::function<bool(T&)>;
 
         EventDispatcher(Event& event)
-            : m_Event(event) {}
+            : m_Event(event),
+              m_Type(event.GetEventType()) {}
 
         /**
          * Dispatches the event to the given function if it coincides the type
          *
+         * @param func Called with the event as a T&, returns whether it handled it
          * @returns true if the event was dispatched succesfully, false otherwise
          * */
-        template <typename T>
-        bool Dispatch(EventFn<T> func) {
-            if (m_Event.GetEventType() == T::GetStaticType()) {
+        template <typename T, typename F>
+        bool Dispatch(F&& func) {
+            if (m_Type == T::GetStaticType()) {
                 m_Event.Handle(func(static_cast<T&>(m_Event)));
                 return true;
             }
@@ -102,6 +139,50 @@ namespace Axle {
 
     private:
         Event& m_Event;
+        /// Read once, every Dispatch compares against it
+        EventType m_Type;
+    };
+
+    /**
+     * Dispatcher for a set of event types known at compile time, each with its own handler. The type is read once
+     * and compared against constants, the handlers are called directly and can be inlined.
+     *
+     * The same list gives the mask a layer subscribes to, so it only receives the events it handles:
+     *
+     *     using Events = TypedEventDispatcher<KeyPressedEvent, WindowResizeEvent>;
+     *
+     *     void OnAttach() override { SubscribeEvents(Events::Mask); }
+     *     void OnEvent(Event& event) override {
+     *         Events::Dispatch(event, AX_BIND_EVENT_FN(OnKeyPressed), AX_BIND_EVENT_FN(OnWindowResize));
+     *     }
+     * */
+    template <typename... Ts>
+        requires(std::derived_from<Ts, Event> && ...)
+    class TypedEventDispatcher {
+    public:
+        static constexpr EventMask Mask = (EventTypeMask(Ts::GetStaticType()) | ... | EventMask(0));
+
+        /**
+         * Dispatches the event to the handler of its type, the handlers go in the same order as the types.
+         *
+         * @returns true if one of the types matched, false otherwise
+         * */
+        template <typename... Fs>
+            requires(sizeof...(Fs) == sizeof...(Ts))
+        static bool Dispatch(Event& event, Fs&&... handlers) {
+            const EventType type = event.GetEventType();
+            return (TryDispatch<Ts>(event, type, handlers) || ...);
+        }
+
+    private:
+        template <typename T, typename F>
+        static bool TryDispatch(Event& event, EventType type, F& handler) {
+            if (type != T::GetStaticType())
+                return false;
+
+            event.Handle(handler(static_cast<T&>(event)));
+            return true;
+        }
     };
 
     // Different event types
@@ -12,6 +12,17 @@
 namespace Axle {
     std::unique_ptr<EventHandler> EventHandler::s_Instance;
 
+    EventHandler::EventHandler()
+        : m_NoEvents(std::make_unique<cw::JobCounter>()) {}
+
+    // Here because the job graph and counter are only declared in the header
+    EventHandler::~EventHandler() = default;
+
+    cw::WaitOnCounterTag EventHandler::ProcessEvents(std::vector<Layer*>::reverse_iterator begin,
+                                                     std::vector<Layer*>::reverse_iterator end) {
+        return s_Instance->ProcessEventsImpl(begin, end);
+    }
+
     void EventHandler::Init() {
         if (s_Instance != nullptr) {
             AX_CORE_WARN(LogChannel::Events,
@@ -29,47 +40,84 @@ namespace Axle {
         AX_CORE_INFO(LogChannel::Events, "Event handler deleted...");
     }
 
-    void EventHandler::SubmitEventImpl(std::unique_ptr<Event> event) {
-        std::scoped_lock lock(m_Mutex);
-        m_EventQueue.emplace_back(std::move(event));
-    }
+    void EventHandler::NotifyChunk(u32 stage, u32 chunk, u32 chunks) {
+        ZoneScopedN("Notify Events");
+
+        const u64 count = m_Batch->Size();
+        const u64 first = count * chunk / chunks;
+        const u64 last = count * (chunk + 1) / chunks;
 
-    void EventHandler::Notify(Event& event,
-                              std::vector<Layer*>::reverse_iterator begin,
-                              std::vector<Layer*>::reverse_iterator end) {
         // Always send to the Application first
-        Application::GetInstance().OnEvent(event);
-        if (event.IsHandled())
+        if (stage == 0) {
+            for (u64 i = first; i < last; ++i) {
+                Event& event = (*m_Batch)[i];
+                if (!event.IsHandled())
+                    Application::GetInstance().OnEvent(event);
+            }
             return;
+        }
+
+        Layer* layer = *(m_Begin + (stage - 1));
+        const EventMask mask = layer->GetEventMask();
+
+        for (u64 i = first; i < last; ++i) {
+            // Layers that don't subscribe to the type don't even touch the event
+            if (!(mask & EventTypeMask(m_Batch->GetType(i))))
+                continue;
 
-        for (; begin != end; begin++) {
-            if (event.IsHandled())
-                break;
-            (*begin)->OnEvent(event);
+            Event& event = (*m_Batch)[i];
+            if (!event.IsHandled())
+                layer->OnEvent(event);
         }
     }
 
-    void EventHandler::ProcessEventsImpl(std::vector<Layer*>::reverse_iterator begin,
-                                         std::vector<Layer*>::reverse_iterator end) {
-        std::vector<std::unique_ptr<Event>> eventsToProcess;
+    void EventHandler::BuildGraph(u32 stages, u32 chunks) {
+        m_Graph = std::make_unique<cw::JobGraph>();
+        m_GraphStages = stages;
+        m_GraphChunks = chunks;
 
-        // Swap the event queue with a local vector to minimize lock time and to also clear the queue for new events
-        {
-            std::scoped_lock lock(m_Mutex);
-            eventsToProcess.swap(m_EventQueue);
-        }
+        // Node of chunk c in stage s is s * chunks + c
+        for (u32 stage = 0; stage < stages; ++stage) {
+            for (u32 chunk = 0; chunk < chunks; ++chunk) {
+                std::array<cw::NodeId, 2> dependencies;
+                u64 count = 0;
+                if (stage > 0)
+                    dependencies[count++] = (stage - 1) * chunks + chunk;
+                if (chunk > 0)
+                    dependencies[count++] = stage * chunks + chunk - 1;
 
-        for (auto& event : eventsToProcess) {
-            Event* ptr = event.release();
-            cw::JobSystem::Schedule(
-                [this, ptr, begin, end]() {
-                    ZoneScopedN("Notify Event");
-                    Notify(*ptr, begin, end);
-                    delete ptr;
-                },
-                cw::JobPriority::Medium,
-                cw::InvalidThreadIndex,
-                EVENT_INPUT_TAG);
+                m_Graph->AddNode([this, stage, chunk, chunks]() { NotifyChunk(stage, chunk, chunks); },
+                                 std::span<const cw::NodeId>(dependencies.data(), count),
+                                 cw::JobPriority::Medium,
+                                 cw::InvalidThreadIndex,
+                                 "Notify Events");
+            }
         }
     }
+
+    cw::WaitOnCounterTag EventHandler::ProcessEventsImpl(std::vector<Layer*>::reverse_iterator begin,
+                                                         std::vector<Layer*>::reverse_iterator end) {
+        m_Batch = &SwapQueues();
+        m_Begin = begin;
+
+        if (m_Batch->IsEmpty())
+            return cw::WaitOnCounter(*m_NoEvents);
+
+        // The Application plus one per layer
+        const u32 stages = static_cast<u32>(std::distance(begin, end)) + 1;
+        if (!m_Graph || m_GraphStages != stages || m_GraphChunks != m_FanOut)
+            BuildGraph(stages, m_FanOut);
+
+        return m_Graph->Run();
+    }
+
+    EventQueue& EventHandler::SwapQueues() {
+        // The previous batch was notified, the caller awaited it, so its events can go
+        m_Queues[m_SubmitQueue ^ 1].Clear();
+
+        // Swap under the lock to minimize its time, submitters only ever touch the current queue
+        std::scoped_lock lock(m_Mutex);
+        m_SubmitQueue ^= 1;
+        return m_Queues[m_SubmitQueue ^ 1];
+    }
 } // namespace Axle
@@ -4,8 +4,15 @@
 
 #include "../Core.hpp"
 #include "Event.hpp"
+#include "EventQueue.hpp"
 #include "Core/Layer/Layer.hpp"
 
+namespace cw {
+    class JobGraph;
+    class JobCounter;
+    struct WaitOnCounterTag;
+} // namespace cw
+
 namespace Axle {
     /**
      * The EventHandler class represents the event system. All events created: input, window, etc. Are handled here.
@@ -14,14 +21,18 @@ namespace Axle {
      * receive notifications on window events, but it does not want to manually check the window class.
      *
      * This way everything is centralized, eliminating spaggeti references.
+     *
+     * Every event goes to the Application first and then to the layers from the top of the stack down, until one of
+     * them handles it. Layers only get the types they subscribed to, see Layer::SubscribeEvents. Each of them sees the
+     * events in the order they were submitted and never from two threads at once.
      */
     class AXLE_API EventHandler {
     public:
         EventHandler(const EventHandler&) = delete;
         EventHandler& operator=(const EventHandler&) = delete;
 
-        EventHandler() {}
-        ~EventHandler() {}
+        EventHandler();
+        ~EventHandler();
 
         /**
          * Initializes the event handler and its singleton
@@ -41,63 +52,108 @@ namespace Axle {
          * Add an event to the event handler and it will be notified automatically.
          * This function is not recommended to be called manually, you should use the macro: AX_SUBMIT_EVENT
          *
-         * @param event An event wrapped in a unique_ptr
+         * @param event The event, copied or moved into the queue of the current batch
          */
-        inline static void SubmitEvent(std::unique_ptr<Event> event) {
-            s_Instance->SubmitEventImpl(std::move(event));
+        template <typename T>
+            requires std::derived_from<std::decay_t<T>, Event>
+        inline static void SubmitEvent(T&& event) {
+            std::scoped_lock lock(s_Instance->m_Mutex);
+            s_Instance->m_Queues[s_Instance->m_SubmitQueue].Push(std::forward<T>(event));
         }
 
         /**
          * Processes all the events in the queue and notifies the subscribers.
          * This method should be called every frame to ensure that all events are processed.
          *
-         * It is safe to call this method multiple times per frame, but it is recommended to call it only once.
+         * The batch is split in as many chunks as the fan-out. A job notifies one chunk to the Application or to one
+         * layer, and it starts once that chunk went through the previous one and the previous chunk through this one.
+         * While a layer handles a chunk the next layer handles the chunk before it, like a pipeline.
+         *
+         * Important: Has to be awaited before it's called again, that's when the previous batch is freed.
          *
          * @param begin The begining iterator of the layer you want to push events to
          * @param end The end iterator of the layers
+         * @returns Something to co_await on to suspend until every event has been notified
          */
-        inline static void ProcessEvents(std::vector<Layer*>::reverse_iterator begin,
-                                         std::vector<Layer*>::reverse_iterator end) {
-            s_Instance->ProcessEventsImpl(begin, end);
+        static cw::WaitOnCounterTag ProcessEvents(std::vector<Layer*>::reverse_iterator begin,
+                                                  std::vector<Layer*>::reverse_iterator end);
+
+        /**
+         * Sets how many chunks each batch of events is split in. More chunks let more layers work at the same time
+         * but cost a job per chunk and layer.
+         *
+         * This function is NOT thread safe, call it between frames.
+         *
+         * @param chunks The fan-out, at least 1
+         */
+        inline static void SetFanOut(u32 chunks) {
+            s_Instance->m_FanOut = std::max<u32>(chunks, 1);
         }
 
 #ifdef AXLE_TESTING
         // Version withouth the parallelized job system
         inline static void ProcessEventsTest(std::vector<Layer*>::reverse_iterator begin,
                                              std::vector<Layer*>::reverse_iterator end) {
-            std::vector<std::unique_ptr<Event>> eventsToProcess;
-
-            // Swap the event queue with a local vector to minimize lock time and to also clear the queue for new events
-            {
-                std::scoped_lock lock(s_Instance->m_Mutex);
-                eventsToProcess.swap(s_Instance->m_EventQueue);
+            s_Instance->m_Batch = &s_Instance->SwapQueues();
+            s_Instance->m_Begin = begin;
+
+            // Any order that respects the dependencies of the chunks gives the same result
+            const u32 stages = static_cast<u32>(std::distance(begin, end)) + 1;
+            for (u32 chunk = 0; chunk < s_Instance->m_FanOut; ++chunk) {
+                for (u32 stage = 0; stage < stages; ++stage)
+                    s_Instance->NotifyChunk(stage, chunk, s_Instance->m_FanOut);
             }
 
-            for (auto& event : eventsToProcess) {
-                s_Instance->Notify(*event, begin, end);
-            }
+            s_Instance->m_Batch->Clear();
         }
 #endif // AXLE_TESTING
 
     private:
         // Static methods implementations
-        void SubmitEventImpl(std::unique_ptr<Event> event);
-        void ProcessEventsImpl(std::vector<Layer*>::reverse_iterator begin, std::vector<Layer*>::reverse_iterator end);
+        cw::WaitOnCounterTag ProcessEventsImpl(std::vector<Layer*>::reverse_iterator begin,
+                                               std::vector<Layer*>::reverse_iterator end);
 
         /**
-         * The notify method is called internally and it notifies the suscribers about the new event that has arrived.
+         * Notifies the events of a chunk of the current batch that aren't handled yet, in order, to the Application or
+         * to a layer.
          *
-         * @param begin The begining iterator of the layer you want to push events to
-         * @param end The end iterator of the layers
+         * @param stage 0 for the Application, the layer's position from the top of the stack plus one otherwise
+         * @param chunk Which part of the batch
+         * @param chunks How many parts the batch is split in
+         */
+        void NotifyChunk(u32 stage, u32 chunk, u32 chunks);
+
+        /**
+         * Builds the job graph notifying a batch: a node per chunk and stage, each depending on the same chunk in the
+         * previous stage and the previous chunk in the same stage.
+         */
+        void BuildGraph(u32 stages, u32 chunks);
+
+        /**
+         * Starts a new batch: new events go to the other queue from now on.
+         *
+         * @returns The queue with the events submitted since the previous call
          */
-        void
-        Notify(Event& event, std::vector<Layer*>::reverse_iterator begin, std::vector<Layer*>::reverse_iterator end);
+        EventQueue& SwapQueues();
 
         /// The singleton of the event handler class
         static std::unique_ptr<EventHandler> s_Instance;
 
-        // We need to store via pointers to keep the vtable intact
-        std::vector<std::unique_ptr<Event>> m_EventQueue;
+        // Double buffered, events are submitted to one queue while the other one's are being notified
+        std::array<EventQueue, 2> m_Queues;
+        u32 m_SubmitQueue = 0;
+
+        // The batch being notified
+        EventQueue* m_Batch = nullptr;
+        std::vector<Layer*>::reverse_iterator m_Begin;
+
+        u32 m_FanOut = 4;
+        /// Rebuilt when the amount of layers or the fan-out changes
+        std::unique_ptr<cw::JobGraph> m_Graph;
+        u32 m_GraphStages = 0;
+        u32 m_GraphChunks = 0;
+        /// Awaited instead of the graph when there are no events, it's always done
+        std::unique_ptr<cw::JobCounter> m_NoEvents;
 
         std::mutex m_Mutex;
     };
@@ -106,4 +162,4 @@ namespace Axle {
 /**
  * Macro that simplifies the addition of new events to the event handler
  */
-#define AX_SUBMIT_EVENT(e) ::Axle::EventHandler::SubmitEvent(std::make_unique<std::decay_t<decltype(e)>>(e))
+#define AX_SUBMIT_EVENT(e) ::Axle::EventHandler::SubmitEvent(e)
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "axpch.hpp"
+
+#include "Core/Types.hpp"
+#include "Event.hpp"
+
+namespace Axle {
+    /**
+     * Holds events by value, in the order they were pushed, without allocating each of them.
+     *
+     * Events are constructed in place one after another in fixed size chunks. Clear destroys them but keeps the chunks
+     * and the index, so once the queue has grown to the busiest batch pushing an event is a copy and an offset bump.
+     *
+     * Events are destroyed through a function stored next to them instead of the virtual destructor, and the ones that
+     * are trivially destructible, all of the engine's, aren't touched at all.
+     *
+     * This class is NOT thread safe, the EventHandler guards it with its mutex.
+     * */
+    class EventQueue {
+    public:
+        /// Bytes per chunk, an event can't be bigger
+        static constexpr u64 ChunkSize = 16 * 1024;
+
+        EventQueue() = default;
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        ~EventQueue() {
+            Clear();
+        }
+
+        /**
+         * Copies or moves an event to the back of the queue
+         * */
+        template <typename T>
+            requires std::derived_from<std::decay_t<T>, Event>
+        void Push(T&& event) {
+            using E = std::decay_t<T>;
+            static_assert(sizeof(E) <= ChunkSize, "The event doesn't fit in a chunk of the event queue");
+            static_assert(alignof(E) <= alignof(std::max_align_t), "Over-aligned events aren't supported");
+
+            E* stored = ::new (Allocate(sizeof(E), alignof(E))) E(std::forward<T>(event));
+
+            DestroyFn destroy = nullptr;
+            if constexpr (!std::is_trivially_destructible_v<E>)
+                destroy = [](Event* ptr) { static_cast<E*>(ptr)->E::~E(); };
+
+            // Known here for every event defining its type, so filtering by it later doesn't call GetEventType
+            EventType type;
+            if constexpr (requires { E::GetStaticType(); })
+                type = E::GetStaticType();
+            else
+                type = stored->GetEventType();
+
+            m_Events.push_back({stored, destroy, type});
+        }
+
+        /**
+         * Calls func(Event&) for every event, in the order they were pushed
+         * */
+        template <typename F>
+        void ForEach(F&& func) {
+            for (const Entry& entry : m_Events)
+                func(*entry.event);
+        }
+
+        /**
+         * Destroys every event, keeping the memory for the next ones
+         * */
+        void Clear() {
+            for (const Entry& entry : m_Events) {
+                if (entry.destroy)
+                    entry.destroy(entry.event);
+            }
+
+            m_Events.clear();
+            m_Chunk = 0;
+            m_Offset = 0;
+        }
+
+        /**
+         * @returns The event pushed in the given position
+         * */
+        inline Event& operator[](u64 index) {
+            return *m_Events[index].event;
+        }
+
+        /**
+         * @returns The type of the event pushed in the given position
+         * */
+        inline EventType GetType(u64 index) const {
+            return m_Events[index].type;
+        }
+
+        inline u64 Size() const {
+            return m_Events.size();
+        }
+
+        inline bool IsEmpty() const {
+            return m_Events.empty();
+        }
+
+    private:
+        using DestroyFn = void (*)(Event*);
+
+        struct Entry {
+            /// Points to the Event base of the stored event
+            Event* event;
+            /// nullptr for trivially destructible events
+            DestroyFn destroy;
+            EventType type;
+        };
+
+        void* Allocate(u64 size, u64 alignment) {
+            u64 offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+
+            // Move on to the next chunk, the ones left by previous batches are reused
+            if (m_Chunks.empty() || offset + size > ChunkSize) {
+                if (!m_Chunks.empty())
+                    ++m_Chunk;
+                if (m_Chunk == m_Chunks.size())
+                    m_Chunks.push_back(std::make_unique<std::byte[]>(ChunkSize));
+                offset = 0;
+            }
+
+            m_Offset = offset + size;
+            return m_Chunks[m_Chunk].get() + offset;
+        }
+
+        std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+        /// Chunk the next event goes to and where in it
+        u64 m_Chunk = 0;
+        u64 m_Offset = 0;
+        std::vector<Entry> m_Events;
+    };
+} // namespace Axle
@@ -79,7 +79,28 @@ namespace Axle {
             return m_DebugName;
         }
 
+        /**
+         * @returns The event types the layer receives, the EventHandler skips it for the rest
+         * */
+        inline EventMask GetEventMask() const {
+            return m_EventMask.load(std::memory_order_relaxed);
+        }
+
     protected:
+        /**
+         * Restricts the events passed to OnEvent to the given types, every event by default. Meant to be called in
+         * OnAttach, see TypedEventDispatcher to build the mask from the types the layer handles.
+         *
+         * @param mask The event types, see EventTypeMask and EventCategoryMask
+         * */
+        inline void SubscribeEvents(EventMask mask) {
+            m_EventMask.store(mask, std::memory_order_relaxed);
+        }
+
         std::string m_DebugName;
+
+    private:
+        // Attaching runs on the update thread while events are notified from the render loop
+        std::atomic<EventMask> m_EventMask{AllEvents};
     };
 } // namespace Axle
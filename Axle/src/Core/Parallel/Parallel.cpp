@@ -0,0 +1,137 @@
+#include "axpch.hpp"
+
+#include "Parallel.hpp"
+
+#include <CoroWeaver.hpp>
+
+namespace Axle {
+    namespace {
+        struct RangeState {
+            Detail::RangeFunction fn;
+            void* context;
+            u64 end;
+            u64 grain;
+            /// A claim takes the remaining items divided by this
+            u64 divisor;
+            std::atomic<u64> next;
+            /// Items not processed yet
+            cw::JobCounter remaining;
+
+            RangeState(Detail::RangeFunction fn, void* context, u64 begin, u64 end, u64 grain, u64 workers)
+                : fn(fn),
+                  context(context),
+                  end(end),
+                  grain(grain),
+                  divisor(workers * 2),
+                  next(begin),
+                  remaining(end - begin) {}
+        };
+
+        /// Claims the next chunk, returns false once the whole range has been handed out
+        bool Claim(RangeState& state, u64& begin, u64& end) {
+            u64 current = state.next.load(std::memory_order_relaxed);
+            u64 size;
+
+            do {
+                if (current >= state.end)
+                    return false;
+
+                const u64 left = state.end - current;
+                size = std::min(left, std::max(state.grain, left / state.divisor));
+            } while (!state.next.compare_exchange_weak(current, current + size, std::memory_order_relaxed));
+
+            begin = current;
+            end = current + size;
+            return true;
+        }
+
+        /// Runs chunks until none is left. The counter is updated once at the end, a helper that starts too late
+        /// never touches fn or the counter
+        void RunChunks(RangeState& state) {
+            u64 done = 0;
+
+            for (u64 begin, end; Claim(state, begin, end);) {
+                state.fn(state.context, begin, end);
+                done += end - begin;
+            }
+
+            if (done != 0)
+                state.remaining.Decrement(done);
+        }
+
+        /// How many helper jobs are worth scheduling for count items
+        u64 HelperCount(u64 count, u64 grain) {
+            if (!cw::JobSystem::IsInitialized())
+                return 0;
+
+            return std::min<u64>(Detail::ParallelChunkCount(count, grain) - 1, cw::JobSystem::GetNumThreads());
+        }
+
+        /// Shared because helper jobs may start after the loop has already finished
+        std::shared_ptr<RangeState> StartRange(
+            u64 begin, u64 end, u64 grain, Detail::RangeFunction fn, void* context, u64 helpers) {
+            auto state = std::make_shared<RangeState>(fn, context, begin, end, grain, helpers + 1);
+
+            // One bulk push and a single wake-up pass instead of a Schedule per helper
+            CW_SCHEDULE_BULK(
+                [state](u32) { RunChunks(*state); }, static_cast<u32>(helpers), cw::JobPriority::High, "Parallel for");
+
+            return state;
+        }
+    } // namespace
+
+    namespace Detail {
+        u64 ParallelChunkCount(u64 count, u64 grain) {
+            if (count == 0)
+                return 0;
+
+            grain = std::max<u64>(grain, 1);
+
+            // A few chunks per thread so an unlucky one doesn't hold everyone else back
+            const u64 threads = cw::JobSystem::IsInitialized() ? cw::JobSystem::GetNumThreads() + 1 : 1;
+            const u64 maxChunks = threads == 1 ? 1 : threads * 4;
+
+            return std::min((count + grain - 1) / grain, maxChunks);
+        }
+
+        void ParallelForRange(u64 begin, u64 end, u64 grain, RangeFunction fn, void* context) {
+            if (begin >= end)
+                return;
+
+            grain = std::max<u64>(grain, 1);
+            const u64 helpers = HelperCount(end - begin, grain);
+
+            if (helpers == 0) {
+                fn(context, begin, end);
+                return;
+            }
+
+            std::shared_ptr<RangeState> state = StartRange(begin, end, grain, fn, context, helpers);
+
+            RunChunks(*state);
+
+            // Wait for the chunks other threads are still running
+            state->remaining.Wait();
+        }
+
+        cw::JobCoroutine<void> ParallelForRangeAsync(u64 begin, u64 end, u64 grain, RangeFunction fn, void* context) {
+            if (begin >= end)
+                co_return;
+
+            grain = std::max<u64>(grain, 1);
+            const u64 helpers = HelperCount(end - begin, grain);
+
+            if (helpers == 0) {
+                fn(context, begin, end);
+                co_return;
+            }
+
+            std::shared_ptr<RangeState> state = StartRange(begin, end, grain, fn, context, helpers);
+
+            RunChunks(*state);
+
+            // The worker is free to run other jobs, the last chunk to finish reschedules us
+            co_await cw::WaitOnCounter(state->remaining);
+        }
+    } // namespace Detail
+} // namespace Axle
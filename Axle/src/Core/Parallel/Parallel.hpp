@@ -0,0 +1,207 @@
+#pragma once
+
+#include "axpch.hpp"
+
+#include "Core/Core.hpp"
+#include "Core/Types.hpp"
+
+namespace cw {
+    template <typename T>
+    class JobCoroutine;
+} // namespace cw
+
+// Data parallel algorithms running on the job system. The calling thread always takes part in the work, and it only
+// ever waits for chunks other threads are already running, so they can be called from inside jobs too. Without the
+// job system (or with too little work to split) everything runs inline on the calling thread.
+//
+// The coroutine versions live in ParallelAsync.hpp because they need CoroWeaver.
+
+namespace Axle {
+    namespace Detail {
+        /// Type erased body of a parallel loop, runs [begin, end)
+        using RangeFunction = void (*)(void* context, u64 begin, u64 end);
+
+        /**
+         * Runs fn over [begin, end) in chunks of at least grain items, spread across the job system workers.
+         * Chunks are adaptive: every claim takes a share of what's left, so they start big and shrink towards grain
+         * as the loop runs out of work, which keeps the number of atomics low while still balancing the load.
+         * */
+        AXLE_API void ParallelForRange(u64 begin, u64 end, u64 grain, RangeFunction fn, void* context);
+
+        /**
+         * Same as ParallelForRange but the calling coroutine is suspended instead of blocked while the helpers finish
+         * their chunks. context must outlive the returned coroutine.
+         * */
+        AXLE_API cw::JobCoroutine<void> ParallelForRangeAsync(
+            u64 begin, u64 end, u64 grain, RangeFunction fn, void* context);
+
+        /// How many chunks of at least grain items ParallelReduce and ParallelSort split count items into
+        AXLE_API u64 ParallelChunkCount(u64 count, u64 grain);
+
+        template <typename F>
+        void InvokeRange(void* context, u64 begin, u64 end) {
+            F& fn = *static_cast<F*>(context);
+
+            if constexpr (std::is_invocable_v<F&, u64, u64>) {
+                fn(begin, end);
+            } else {
+                for (u64 i = begin; i < end; ++i)
+                    fn(i);
+            }
+        }
+
+        template <typename F>
+        void* RangeContext(F& fn) {
+            return const_cast<std::remove_const_t<F>*>(std::addressof(fn));
+        }
+
+        /// Folds [first, first + count) one chunk per ParallelFor index, partials[c] gets chunk c
+        template <typename T, typename F>
+        struct ReduceChunks {
+            const T* identity;
+            F* fn;
+            T* partials;
+            u64 begin;
+            u64 end;
+            u64 chunkSize;
+
+            void operator()(u64 chunk) const {
+                const u64 first = begin + chunk * chunkSize;
+                const u64 last = std::min(first + chunkSize, end);
+
+                T value = *identity;
+                for (u64 i = first; i < last; ++i)
+                    value = (*fn)(std::move(value), i);
+                partials[chunk] = std::move(value);
+            }
+        };
+
+        /// Merges pairs of sorted runs of width items from src into dst
+        template <typename It, typename Out, typename Compare>
+        struct MergeRuns {
+            It src;
+            Out dst;
+            u64 count;
+            u64 width;
+            Compare* comp;
+
+            void operator()(u64 pair) const {
+                const u64 first = pair * width * 2;
+                const u64 middle = std::min(first + width, count);
+                const u64 last = std::min(first + width * 2, count);
+
+                std::merge(std::make_move_iterator(src + first),
+                           std::make_move_iterator(src + middle),
+                           std::make_move_iterator(src + middle),
+                           std::make_move_iterator(src + last),
+                           dst + first,
+                           *comp);
+            }
+        };
+    } // namespace Detail
+
+    /**
+     * Runs fn for every index in [begin, end), in parallel. fn is called either as fn(index), or as fn(chunkBegin,
+     * chunkEnd) if it accepts that, which lets tight loops keep their state in registers.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Minimum amount of indexes handed to a thread at once, should be enough work to be worth a job
+     * @param fn The loop body. Called concurrently from several threads.
+     *
+     * Thread Safe
+     * */
+    template <typename F>
+    void ParallelFor(u64 begin, u64 end, u64 grain, F&& fn) {
+        using Fn = std::remove_reference_t<F>;
+        Detail::ParallelForRange(
+            begin, end, grain, &Detail::InvokeRange<std::remove_const_t<Fn>>, Detail::RangeContext(fn));
+    }
+
+    /**
+     * Folds every index of [begin, end) in parallel. Each chunk starts from identity and folds its indexes in order
+     * with fn, then the partial results are combined in chunk order on the calling thread, so the result doesn't
+     * depend on which thread ran which chunk. Chunk sizes do depend on grain and the number of workers.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Minimum amount of indexes folded by a single chunk
+     * @param identity Starting value of every chunk, must not change the result when combined
+     * @param fn Folds an index into the running value, called as fn(T value, u64 index) -> T
+     * @param combine Combines two partial results, called as combine(T left, T right) -> T
+     * @returns The combined value, identity if the range is empty
+     *
+     * Thread Safe
+     * */
+    template <typename T, typename F, typename C>
+    T ParallelReduce(u64 begin, u64 end, u64 grain, T identity, F&& fn, C&& combine) {
+        if (begin >= end)
+            return identity;
+
+        const u64 count = end - begin;
+        const u64 chunks = Detail::ParallelChunkCount(count, grain);
+        const u64 chunkSize = (count + chunks - 1) / chunks;
+
+        std::vector<T> partials(chunks, identity);
+        Detail::ReduceChunks<T, std::remove_reference_t<F>> reduce{
+            &identity, std::addressof(fn), partials.data(), begin, end, chunkSize};
+        ParallelFor(0, chunks, 1, reduce);
+
+        T result = std::move(partials[0]);
+        for (u64 chunk = 1; chunk < chunks; ++chunk)
+            result = combine(std::move(result), std::move(partials[chunk]));
+
+        return result;
+    }
+
+    /**
+     * Sorts [first, last) in parallel. Blocks are sorted with std::sort in parallel, then merged in pairs in
+     * parallel until one run is left, so it needs a temporary buffer as big as the range. Not stable.
+     *
+     * @param first Random access iterator to the first element
+     * @param last Random access iterator one past the last element
+     * @param comp Strict weak ordering, std::less by default
+     *
+     * Thread Safe
+     * */
+    template <std::random_access_iterator It, typename Compare = std::less<>>
+    void ParallelSort(It first, It last, Compare comp = {}) {
+        using Value = std::iter_value_t<It>;
+
+        // Below this there is not enough work to pay for the merges
+        constexpr u64 MinBlockSize = 2048;
+
+        const u64 count = static_cast<u64>(last - first);
+        const u64 blocks = Detail::ParallelChunkCount(count, MinBlockSize);
+
+        if (blocks <= 1) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        const u64 blockSize = (count + blocks - 1) / blocks;
+
+        ParallelFor(0, blocks, 1, [&](u64 block) {
+            const u64 begin = block * blockSize;
+            std::sort(first + begin, first + std::min(begin + blockSize, count), comp);
+        });
+
+        // Every round halves the number of runs, going back and forth between the range and the buffer
+        std::vector<Value> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+        bool inBuffer = true;
+
+        for (u64 width = blockSize; width < count; width *= 2) {
+            const u64 pairs = (count + width * 2 - 1) / (width * 2);
+
+            if (inBuffer)
+                ParallelFor(0, pairs, 1, Detail::MergeRuns<Value*, It, Compare>{buffer.data(), first, count, width, &comp});
+            else
+                ParallelFor(0, pairs, 1, Detail::MergeRuns<It, Value*, Compare>{first, buffer.data(), count, width, &comp});
+
+            inBuffer = !inBuffer;
+        }
+
+        if (inBuffer)
+            std::move(buffer.begin(), buffer.end(), first);
+    }
+} // namespace Axle
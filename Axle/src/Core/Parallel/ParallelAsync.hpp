@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Parallel.hpp"
+
+#include <CoroWeaver.hpp>
+
+// Coroutine versions of the algorithms in Parallel.hpp, awaited with co_await cw::WhenAll(...). While the helpers
+// finish their chunks the awaiting coroutine is suspended and its worker keeps running other jobs. Kept apart because
+// only the code built with the job system include paths can see CoroWeaver.
+
+namespace Axle {
+    /**
+     * Coroutine version of ParallelFor. fn is moved into the coroutine, so it can be a temporary.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Minimum amount of indexes handed to a thread at once
+     * @param fn The loop body, called as fn(index) or fn(chunkBegin, chunkEnd). Called concurrently.
+     *
+     * Thread Safe
+     * */
+    template <typename F>
+    cw::JobCoroutine<void> ParallelForAsync(u64 begin, u64 end, u64 grain, F fn) {
+        co_await cw::WhenAll(
+            Detail::ParallelForRangeAsync(begin, end, grain, &Detail::InvokeRange<F>, Detail::RangeContext(fn)));
+    }
+
+    /**
+     * Coroutine version of ParallelReduce, see it for how the partial results are combined.
+     *
+     * @returns A coroutine whose value is the combined result
+     *
+     * Thread Safe
+     * */
+    template <typename T, typename F, typename C>
+    cw::JobCoroutine<T> ParallelReduceAsync(u64 begin, u64 end, u64 grain, T identity, F fn, C combine) {
+        if (begin >= end)
+            co_return identity;
+
+        const u64 count = end - begin;
+        const u64 chunks = Detail::ParallelChunkCount(count, grain);
+        const u64 chunkSize = (count + chunks - 1) / chunks;
+
+        std::vector<T> partials(chunks, identity);
+        Detail::ReduceChunks<T, F> reduce{&identity, &fn, partials.data(), begin, end, chunkSize};
+        co_await cw::WhenAll(Detail::ParallelForRangeAsync(
+            0, chunks, 1, &Detail::InvokeRange<Detail::ReduceChunks<T, F>>, Detail::RangeContext(reduce)));
+
+        T result = std::move(partials[0]);
+        for (u64 chunk = 1; chunk < chunks; ++chunk)
+            result = combine(std::move(result), std::move(partials[chunk]));
+
+        co_return result;
+    }
+
+    /**
+     * Coroutine version of ParallelSort. The range must stay alive and untouched until the coroutine is done.
+     *
+     * Thread Safe
+     * */
+    template <std::random_access_iterator It, typename Compare = std::less<>>
+    cw::JobCoroutine<void> ParallelSortAsync(It first, It last, Compare comp = {}) {
+        using Value = std::iter_value_t<It>;
+
+        constexpr u64 MinBlockSize = 2048;
+
+        const u64 count = static_cast<u64>(last - first);
+        const u64 blocks = Detail::ParallelChunkCount(count, MinBlockSize);
+
+        if (blocks <= 1) {
+            std::sort(first, last, comp);
+            co_return;
+        }
+
+        const u64 blockSize = (count + blocks - 1) / blocks;
+
+        auto sortBlock = [&](u64 block) {
+            const u64 begin = block * blockSize;
+            std::sort(first + begin, first + std::min(begin + blockSize, count), comp);
+        };
+        co_await cw::WhenAll(Detail::ParallelForRangeAsync(
+            0, blocks, 1, &Detail::InvokeRange<decltype(sortBlock)>, Detail::RangeContext(sortBlock)));
+
+        std::vector<Value> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+        bool inBuffer = true;
+
+        for (u64 width = blockSize; width < count; width *= 2) {
+            const u64 pairs = (count + width * 2 - 1) / (width * 2);
+
+            if (inBuffer) {
+                Detail::MergeRuns<Value*, It, Compare> merge{buffer.data(), first, count, width, &comp};
+                co_await cw::WhenAll(Detail::ParallelForRangeAsync(
+                    0, pairs, 1, &Detail::InvokeRange<decltype(merge)>, Detail::RangeContext(merge)));
+            } else {
+                Detail::MergeRuns<It, Value*, Compare> merge{first, buffer.data(), count, width, &comp};
+                co_await cw::WhenAll(Detail::ParallelForRangeAsync(
+                    0, pairs, 1, &Detail::InvokeRange<decltype(merge)>, Detail::RangeContext(merge)));
+            }
+
+            inBuffer = !inBuffer;
+        }
+
+        if (inBuffer)
+            std::move(buffer.begin(), buffer.end(), first);
+    }
+} // namespace Axle
@@ -0,0 +1,355 @@
+#pragma once
+
+// On-disk layout of an asset pack (.axpk). This header is shared with AAP, which writes the packs, so it must only
+// depend on the standard library.
+//
+// The TOC is read in place from the mapping: it's an open addressing hash table keyed by the hash of the path of the
+// asset relative to the packed directory, so a lookup never parses or copies anything.
+//
+//   [Header][Entry * bucketCount][names][padding][data of every asset, each one starting on an aligned offset]
+//
+// Compressed assets are split in chunks of header.chunkSize bytes compressed independently with Lz4, so they can be
+// decompressed in parallel. Their data starts with the end offset of every chunk, relative to the end of that table:
+//
+//   [u64 * chunkCount][chunk 0][chunk 1]...
+//
+// A chunk whose compressed size would not be smaller than its original size is stored as is.
+
+#include "Lz4.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Axle::AssetPack {
+    /// "AXPK" read as a little endian integer
+    constexpr std::uint32_t MAGIC = 0x4B505841;
+    constexpr std::uint32_t VERSION = 3;
+    /// Assets start on a page boundary so no two of them share a page and each one can be advised on its own
+    constexpr std::uint32_t DEFAULT_ALIGNMENT = 4096;
+    /// Big enough for a good ratio, small enough to split textures and meshes across several workers
+    constexpr std::uint32_t DEFAULT_CHUNK_SIZE = 128 * 1024;
+    /// A bucket with this hash is empty
+    constexpr std::uint64_t EMPTY_HASH = 0;
+
+    /// Entry flags
+    constexpr std::uint32_t ENTRY_COMPRESSED = 1u << 0;
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        /// Always a power of two, at least twice entryCount
+        std::uint32_t bucketCount;
+        /// Offset of the Entry table from the beginning of the pack
+        std::uint64_t tocOffset;
+        /// Offset of the blob holding the names of every entry, not null terminated
+        std::uint64_t namesOffset;
+        std::uint64_t namesSize;
+        /// Total size of the pack, used to detect truncated files
+        std::uint64_t packSize;
+        std::uint32_t alignment;
+        /// Uncompressed size of every chunk of a compressed entry but the last one
+        std::uint32_t chunkSize;
+        std::uint32_t reserved[2];
+    };
+
+    struct Entry {
+        /// Hash of the name, EMPTY_HASH for an empty bucket
+        std::uint64_t hash;
+        /// Offset of the data from the beginning of the pack
+        std::uint64_t offset;
+        /// Size of the asset once loaded
+        std::uint64_t size;
+        /// Size of the data inside the pack, the same as size unless the entry is compressed
+        std::uint64_t storedSize;
+        /// XxHash::Hash64 of the asset once loaded, lets identical assets share a single resource without hashing
+        /// them at load time. 0 if it wasn't computed.
+        std::uint64_t contentHash;
+        /// Range of the name inside the names blob. Names are compared on lookup so hash collisions are harmless.
+        std::uint32_t nameOffset;
+        std::uint32_t nameSize;
+        std::uint32_t flags;
+        std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 64, "The asset pack header layout changed!");
+    static_assert(sizeof(Entry) == 56, "The asset pack entry layout changed!");
+
+    /**
+     * Hashes the name of an asset (FNV-1a, 64 bits). Names are generic, lexically normal paths relative to the packed
+     * directory, e.g. "textures/backpack/diffuse.jpg".
+     *
+     * @param name The name of the asset
+     *
+     * @returns The hash, never EMPTY_HASH
+     * */
+    constexpr std::uint64_t Hash(std::string_view name) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+
+        for (char c : name) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash == EMPTY_HASH ? 1 : hash;
+    }
+
+    /**
+     * Checks that the header of a pack is consistent with the size of the data holding it.
+     *
+     * @param data Pointer to the beginning of the pack
+     * @param size Size of the pack in bytes
+     *
+     * @returns The header if the pack is valid, nullptr otherwise
+     * */
+    inline const Header* ValidateHeader(const char* data, std::uint64_t size) {
+        if (data == nullptr || size < sizeof(Header))
+            return nullptr;
+
+        const Header* header = reinterpret_cast<const Header*>(data);
+
+        if (header->magic != MAGIC || header->version != VERSION || header->packSize != size || header->chunkSize == 0)
+            return nullptr;
+
+        const std::uint64_t buckets = header->bucketCount;
+        if (buckets == 0 || (buckets & (buckets - 1)) != 0 || header->entryCount > buckets)
+            return nullptr;
+
+        if (header->tocOffset > size || buckets * sizeof(Entry) > size - header->tocOffset)
+            return nullptr;
+
+        if (header->namesOffset > size || header->namesSize > size - header->namesOffset)
+            return nullptr;
+
+        return header;
+    }
+
+    /**
+     * Looks an asset up in a pack previously checked with ValidateHeader.
+     *
+     * @param data Pointer to the beginning of the pack
+     * @param name The name of the asset
+     *
+     * @returns The entry of the asset, nullptr if it's not in the pack or its range is out of bounds
+     * */
+    inline const Entry* Find(const char* data, std::string_view name) {
+        const Header* header = reinterpret_cast<const Header*>(data);
+        const Entry* entries = reinterpret_cast<const Entry*>(data + header->tocOffset);
+        const char* names = data + header->namesOffset;
+
+        const std::uint64_t hash = Hash(name);
+        const std::uint32_t mask = header->bucketCount - 1;
+
+        // Linear probing, the table is never full so an empty bucket always ends the search
+        for (std::uint32_t i = 0, bucket = hash & mask; i < header->bucketCount; ++i, bucket = (bucket + 1) & mask) {
+            const Entry& entry = entries[bucket];
+
+            if (entry.hash == EMPTY_HASH)
+                return nullptr;
+
+            if (entry.hash != hash || entry.nameSize != name.size())
+                continue;
+
+            if (static_cast<std::uint64_t>(entry.nameOffset) + entry.nameSize > header->namesSize ||
+                std::memcmp(names + entry.nameOffset, name.data(), name.size()) != 0)
+                continue;
+
+            if (entry.offset > header->packSize || entry.storedSize > header->packSize - entry.offset)
+                return nullptr;
+
+            return &entry;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Number of chunks a compressed asset is split in.
+     *
+     * @param size Uncompressed size of the asset
+     * @param chunkSize Uncompressed size of every chunk
+     *
+     * @returns The amount of chunks
+     * */
+    constexpr std::uint64_t ChunkCount(std::uint64_t size, std::uint32_t chunkSize) {
+        return (size + chunkSize - 1) / chunkSize;
+    }
+
+    /**
+     * Compresses an asset in independent chunks, producing the data of a compressed entry.
+     *
+     * @param data The asset
+     * @param size Size of the asset in bytes
+     * @param chunkSize Uncompressed size of every chunk
+     *
+     * @returns The data to store in the pack
+     * */
+    inline std::string CompressChunked(const char* data, std::uint64_t size, std::uint32_t chunkSize) {
+        const std::uint64_t chunkCount = ChunkCount(size, chunkSize);
+        const std::uint64_t tableSize = chunkCount * sizeof(std::uint64_t);
+
+        std::string stored(tableSize, '\0');
+        std::string scratch(Lz4::CompressBound(chunkSize), '\0');
+
+        for (std::uint64_t chunk = 0; chunk < chunkCount; ++chunk) {
+            const char* src = data + chunk * chunkSize;
+            const std::uint64_t srcSize = std::min<std::uint64_t>(chunkSize, size - chunk * chunkSize);
+
+            const std::size_t compressed = Lz4::Compress(src, srcSize, scratch.data(), scratch.size());
+
+            if (compressed != 0 && compressed < srcSize)
+                stored.append(scratch.data(), compressed);
+            else
+                stored.append(src, srcSize);
+
+            const std::uint64_t end = stored.size() - tableSize;
+            std::memcpy(stored.data() + chunk * sizeof(std::uint64_t), &end, sizeof(end));
+        }
+
+        return stored;
+    }
+
+    /**
+     * Decompresses one chunk of a compressed entry. Chunks don't depend on each other, so they can be decompressed
+     * from different threads at the same time.
+     *
+     * @param stored The data of the entry inside the pack
+     * @param storedSize Size of the data of the entry inside the pack
+     * @param size Uncompressed size of the asset
+     * @param chunkSize Uncompressed size of every chunk
+     * @param chunk Index of the chunk to decompress
+     * @param dst Buffer of at least size bytes where the whole asset is decompressed
+     *
+     * @returns true if the chunk was valid, false otherwise
+     * */
+    inline bool DecompressChunk(const char* stored,
+                                std::uint64_t storedSize,
+                                std::uint64_t size,
+                                std::uint32_t chunkSize,
+                                std::uint64_t chunk,
+                                char* dst) {
+        const std::uint64_t chunkCount = ChunkCount(size, chunkSize);
+        const std::uint64_t tableSize = chunkCount * sizeof(std::uint64_t);
+
+        if (chunk >= chunkCount || tableSize > storedSize)
+            return false;
+
+        std::uint64_t begin = 0;
+        std::uint64_t end = 0;
+        if (chunk > 0)
+            std::memcpy(&begin, stored + (chunk - 1) * sizeof(std::uint64_t), sizeof(begin));
+        std::memcpy(&end, stored + chunk * sizeof(std::uint64_t), sizeof(end));
+
+        if (begin > end || end > storedSize - tableSize)
+            return false;
+
+        const char* src = stored + tableSize + begin;
+        const std::uint64_t srcSize = end - begin;
+        const std::uint64_t dstSize = std::min<std::uint64_t>(chunkSize, size - chunk * chunkSize);
+        char* out = dst + chunk * chunkSize;
+
+        // Chunks that didn't shrink are stored as is
+        if (srcSize == dstSize) {
+            std::memcpy(out, src, srcSize);
+            return true;
+        }
+
+        return Lz4::Decompress(src, srcSize, out, dstSize);
+    }
+
+    /// A file to be placed in a pack by BuildToc
+    struct TocFile {
+        std::string name;
+        /// Size of the asset once loaded
+        std::uint64_t size;
+        /// Size of its data inside the pack, the size of CompressChunked's output for compressed files
+        std::uint64_t storedSize;
+        std::uint32_t flags;
+        /// XxHash::Hash64 of the file, 0 to leave it for the engine to compute
+        std::uint64_t contentHash = 0;
+    };
+
+    /// Everything that precedes the data of a pack, built by BuildToc
+    struct Toc {
+        Header header;
+        /// The hash table, written right after the header
+        std::vector<Entry> entries;
+        /// The names blob, written right after the hash table
+        std::string names;
+        /// Offset of the data of every file, in the order they were given
+        std::vector<std::uint64_t> offsets;
+    };
+
+    /**
+     * Lays out a pack: fills the header and the hash table and places the data of every file on an aligned offset.
+     * The pack is then written as the header, the entries, the names and the data of each file at its offset, with
+     * zeros in between.
+     *
+     * @param files The files to pack
+     * @param alignment Alignment of the data of every file, a power of two
+     * @param chunkSize Uncompressed size of the chunks the compressed files were split in
+     *
+     * @returns The table of contents of the pack
+     * */
+    inline Toc BuildToc(const std::vector<TocFile>& files,
+                        std::uint32_t alignment = DEFAULT_ALIGNMENT,
+                        std::uint32_t chunkSize = DEFAULT_CHUNK_SIZE) {
+        Toc toc = {};
+
+        // At most half full so probe sequences stay short
+        std::uint32_t bucketCount = 1;
+        while (bucketCount < files.size() * 2)
+            bucketCount <<= 1;
+
+        for (const TocFile& file : files)
+            toc.names += file.name;
+
+        Header& header = toc.header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.entryCount = static_cast<std::uint32_t>(files.size());
+        header.bucketCount = bucketCount;
+        header.tocOffset = sizeof(Header);
+        header.namesOffset = header.tocOffset + static_cast<std::uint64_t>(bucketCount) * sizeof(Entry);
+        header.namesSize = toc.names.size();
+        header.alignment = alignment;
+        header.chunkSize = chunkSize;
+
+        toc.entries.resize(bucketCount);
+        toc.offsets.reserve(files.size());
+
+        std::uint64_t offset = header.namesOffset + header.namesSize;
+        std::uint32_t nameOffset = 0;
+
+        for (const TocFile& file : files) {
+            offset = (offset + alignment - 1) & ~static_cast<std::uint64_t>(alignment - 1);
+            toc.offsets.push_back(offset);
+
+            const std::uint64_t hash = Hash(file.name);
+            std::uint32_t bucket = hash & (bucketCount - 1);
+
+            while (toc.entries[bucket].hash != EMPTY_HASH)
+                bucket = (bucket + 1) & (bucketCount - 1);
+
+            Entry& entry = toc.entries[bucket];
+            entry.hash = hash;
+            entry.offset = offset;
+            entry.size = file.size;
+            entry.storedSize = file.storedSize;
+            entry.contentHash = file.contentHash;
+            entry.nameOffset = nameOffset;
+            entry.nameSize = static_cast<std::uint32_t>(file.name.size());
+            entry.flags = file.flags;
+
+            offset += file.storedSize;
+            nameOffset += static_cast<std::uint32_t>(file.name.size());
+        }
+
+        header.packSize = offset;
+        return toc;
+    }
+} // namespace Axle::AssetPack
@@ -0,0 +1,74 @@
+#include "axpch.hpp"
+
+#include "BufferPool.hpp"
+
+namespace Axle {
+    void BufferPool::Buffer::Release() {
+        if (m_Pool != nullptr && m_Data != nullptr)
+            m_Pool->Release(std::move(m_Data), m_Capacity);
+
+        m_Pool = nullptr;
+        m_Data.reset();
+        m_Size = 0;
+        m_Capacity = 0;
+    }
+
+    BufferPool::Buffer BufferPool::Acquire(u64 size) {
+        const u64 capacity = CapacityFor(size);
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            ++m_Stats.acquired;
+
+            auto it = m_Free.find(capacity);
+            if (it != m_Free.end() && !it->second.empty()) {
+                std::unique_ptr<char[]> data = std::move(it->second.back());
+                it->second.pop_back();
+
+                ++m_Stats.reused;
+                m_Stats.retainedBytes -= capacity;
+                return Buffer(this, std::move(data), size, capacity);
+            }
+        }
+
+        // Allocating is done without holding the lock
+        return Buffer(this, std::unique_ptr<char[]>(new char[capacity]), size, capacity);
+    }
+
+    void BufferPool::Release(std::unique_ptr<char[]> data, u64 capacity) {
+        std::scoped_lock lock(m_Mutex);
+
+        // Over the limit the buffer is simply freed
+        if (m_Stats.retainedBytes + capacity > m_MaxRetainedBytes)
+            return;
+
+        m_Free[capacity].push_back(std::move(data));
+        m_Stats.retainedBytes += capacity;
+    }
+
+    void BufferPool::Trim() {
+        std::unordered_map<u64, std::vector<std::unique_ptr<char[]>>> free;
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            free.swap(m_Free);
+            m_Stats.retainedBytes = 0;
+        }
+    }
+
+    BufferPool::Stats BufferPool::GetStats() const {
+        std::scoped_lock lock(m_Mutex);
+        return m_Stats;
+    }
+
+    u64 BufferPool::CapacityFor(u64 size) {
+        constexpr u64 minCapacity = 4096;
+
+        if (size <= minCapacity)
+            return minCapacity;
+
+        // Four size classes per power of two
+        const u64 step = std::bit_ceil(size) / 4;
+        return (size + step - 1) / step * step;
+    }
+} // namespace Axle
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "axpch.hpp"
+
+#include "Core/Core.hpp"
+#include "Core/Types.hpp"
+
+namespace Axle {
+    /**
+     * Thread safe pool of heap buffers. Released buffers are kept and handed out again to requests of a similar size,
+     * so loading and closing assets over and over doesn't keep hitting the allocator (and the kernel, for big buffers).
+     *
+     * Capacities are rounded up to a quarter of the next power of two so a buffer is at most 25% bigger than requested.
+     * */
+    class AXLE_TEST_API BufferPool {
+    public:
+        /**
+         * A buffer acquired from the pool. It goes back to the pool when destroyed, so it must not outlive it.
+         * */
+        class Buffer {
+        public:
+            Buffer() = default;
+            ~Buffer() {
+                Release();
+            }
+
+            // Non-copyable, moveable
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+            Buffer(Buffer&& other) noexcept
+                : m_Pool(std::exchange(other.m_Pool, nullptr)),
+                  m_Data(std::move(other.m_Data)),
+                  m_Size(std::exchange(other.m_Size, 0)),
+                  m_Capacity(std::exchange(other.m_Capacity, 0)) {}
+            Buffer& operator=(Buffer&& other) noexcept {
+                if (this != &other) {
+                    Release();
+                    m_Pool = std::exchange(other.m_Pool, nullptr);
+                    m_Data = std::move(other.m_Data);
+                    m_Size = std::exchange(other.m_Size, 0);
+                    m_Capacity = std::exchange(other.m_Capacity, 0);
+                }
+                return *this;
+            }
+
+            char* Data() const {
+                return m_Data.get();
+            }
+
+            /// The size that was requested
+            u64 Size() const {
+                return m_Size;
+            }
+
+            /// The size that was allocated, at least Size()
+            u64 Capacity() const {
+                return m_Capacity;
+            }
+
+            bool IsValid() const {
+                return m_Data != nullptr;
+            }
+
+        private:
+            friend class BufferPool;
+
+            Buffer(BufferPool* pool, std::unique_ptr<char[]> data, u64 size, u64 capacity)
+                : m_Pool(pool),
+                  m_Data(std::move(data)),
+                  m_Size(size),
+                  m_Capacity(capacity) {}
+
+            void Release();
+
+            BufferPool* m_Pool = nullptr;
+            std::unique_ptr<char[]> m_Data;
+            u64 m_Size = 0;
+            u64 m_Capacity = 0;
+        };
+
+        struct Stats {
+            /// Amount of buffers handed out
+            u64 acquired = 0;
+            /// Amount of those that were reused instead of allocated
+            u64 reused = 0;
+            /// Bytes currently kept by the pool, waiting to be reused
+            u64 retainedBytes = 0;
+        };
+
+        static constexpr u64 DefaultMaxRetainedBytes = u64(256) << 20;
+
+        /**
+         * @param maxRetainedBytes Released buffers are freed instead of kept once the pool retains this many bytes
+         * */
+        explicit BufferPool(u64 maxRetainedBytes = DefaultMaxRetainedBytes)
+            : m_MaxRetainedBytes(maxRetainedBytes) {}
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        /**
+         * Gets a buffer of at least the given size. Its contents are not initialized.
+         * This method is thread safe.
+         *
+         * @param size The size in bytes
+         *
+         * @returns The buffer
+         * */
+        Buffer Acquire(u64 size);
+
+        /**
+         * Frees every buffer the pool is keeping.
+         * This method is thread safe.
+         * */
+        void Trim();
+
+        /**
+         * This method is thread safe.
+         *
+         * @returns The usage statistics of the pool
+         * */
+        Stats GetStats() const;
+
+    private:
+        /**
+         * Gives a buffer back to the pool.
+         * This method is thread safe.
+         * */
+        void Release(std::unique_ptr<char[]> data, u64 capacity);
+
+        /**
+         * Rounds a size up to the capacity of its size class.
+         *
+         * @param size The requested size in bytes
+         *
+         * @returns The capacity of the buffers that serve that size
+         * */
+        static u64 CapacityFor(u64 size);
+
+        /// Free buffers by capacity
+        std::unordered_map<u64, std::vector<std::unique_ptr<char[]>>> m_Free;
+        Stats m_Stats;
+        u64 m_MaxRetainedBytes;
+        mutable std::mutex m_Mutex;
+    };
+} // namespace Axle
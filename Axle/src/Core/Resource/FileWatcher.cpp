@@ -0,0 +1,265 @@
+#include "axpch.hpp"
+
+#include "FileWatcher.hpp"
+#include "ResourceManager.hpp"
+#include "Core/Error/Result.hpp"
+#include "../Logger/Log.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#ifdef AX_PLATFORM_LINUX
+#    include <poll.h>
+#    include <sys/eventfd.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace Axle {
+    std::unique_ptr<FileWatcher> FileWatcher::s_Instance = nullptr;
+
+    FileWatcher::FileWatcher(std::chrono::milliseconds debounce)
+        : m_Debounce(debounce) {
+#ifdef AX_PLATFORM_LINUX
+        m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (m_Fd < 0 || m_WakeFd < 0) {
+            AX_CORE_ERROR(LogChannel::Resources, "Couldn't create the inotify instance, hot reload is disabled");
+            return;
+        }
+
+        m_Thread = std::thread([this]() { Run(); });
+#else
+        AX_CORE_WARN(LogChannel::Resources, "Hot reload is only supported on Linux");
+#endif
+    }
+
+    FileWatcher::~FileWatcher() {
+#ifdef AX_PLATFORM_LINUX
+        if (m_Thread.joinable()) {
+            const u64 one = 1;
+            [[maybe_unused]] ssize_t written = write(m_WakeFd, &one, sizeof(one));
+            m_Thread.join();
+        }
+
+        if (m_Fd >= 0)
+            close(m_Fd);
+        if (m_WakeFd >= 0)
+            close(m_WakeFd);
+#endif
+    }
+
+    void FileWatcher::Init(std::chrono::milliseconds debounce) {
+        if (s_Instance != nullptr) {
+            AX_CORE_WARN(LogChannel::Resources,
+                         "Init method of the File Watcher has been called a second time. IGNORING");
+            return;
+        }
+
+        s_Instance = std::make_unique<FileWatcher>(debounce);
+
+        AX_CORE_INFO(LogChannel::Resources, "File Watcher initialized...");
+    }
+
+    void FileWatcher::ShutDown() {
+        s_Instance.reset();
+        AX_CORE_INFO(LogChannel::Resources, "File Watcher deleted...");
+    }
+
+    FileWatcher::Subscription FileWatcher::Subscribe(FileHandle handle, std::function<void()> callback) {
+        if (s_Instance == nullptr)
+            return Subscription();
+
+        Result<std::filesystem::path> path = ResourceManager::GetPath(handle);
+
+        if (path.IsErr())
+            return Subscription();
+
+        s_Instance->WatchDirectory(path.Unwrap());
+
+        std::scoped_lock lock(s_Instance->m_CallbacksMutex);
+
+        const u64 id = s_Instance->m_NextID++;
+        s_Instance->m_Callbacks.emplace(id, Callback{handle, std::move(callback)});
+
+        return Subscription(id);
+    }
+
+    void FileWatcher::Update() {
+        if (s_Instance != nullptr)
+            s_Instance->UpdateImpl();
+    }
+
+    void FileWatcher::Subscription::Reset() {
+        if (m_ID == 0)
+            return;
+
+        if (s_Instance != nullptr) {
+            std::scoped_lock lock(s_Instance->m_CallbacksMutex);
+            s_Instance->m_Callbacks.erase(m_ID);
+        }
+
+        m_ID = 0;
+    }
+
+    void FileWatcher::UpdateImpl() {
+        if (!m_HasReloaded.load(std::memory_order_acquire))
+            return;
+
+        ZoneScopedN("Dispatch reloaded files");
+
+        std::vector<FileHandle> reloaded;
+
+        {
+            std::scoped_lock lock(m_ReloadedMutex);
+            reloaded.swap(m_Reloaded);
+            m_HasReloaded.store(false, std::memory_order_relaxed);
+        }
+
+        std::sort(reloaded.begin(), reloaded.end());
+        reloaded.erase(std::unique(reloaded.begin(), reloaded.end()), reloaded.end());
+
+        std::vector<u64> ids;
+
+        {
+            std::scoped_lock lock(m_CallbacksMutex);
+
+            for (const auto& [id, callback] : m_Callbacks) {
+                if (std::binary_search(reloaded.begin(), reloaded.end(), callback.handle))
+                    ids.push_back(id);
+            }
+        }
+
+        // Rebuilding may subscribe or unsubscribe, even the callbacks still to run, so they run unlocked and the ones
+        // removed in the meantime are skipped
+        for (u64 id : ids) {
+            std::function<void()> callback;
+
+            {
+                std::scoped_lock lock(m_CallbacksMutex);
+
+                auto it = m_Callbacks.find(id);
+                if (it == m_Callbacks.end())
+                    continue;
+
+                callback = it->second.callback;
+            }
+
+            callback();
+        }
+
+        AX_CORE_TRACE(
+            LogChannel::Resources, "Dispatched {0} reloaded files to {1} callbacks", reloaded.size(), ids.size());
+    }
+
+    void FileWatcher::WatchDirectory(const std::filesystem::path& file) {
+#ifdef AX_PLATFORM_LINUX
+        // Canonical so the paths built from the events normalize to the same key the ResourceManager uses
+        std::error_code ec;
+        const std::filesystem::path directory = std::filesystem::weakly_canonical(file, ec).parent_path();
+
+        if (ec || m_Fd < 0)
+            return;
+
+        std::scoped_lock lock(m_WatchMutex);
+
+        if (!m_WatchedDirectories.insert(directory.string()).second)
+            return;
+
+        // Editors either write the file in place or write a temporary one and rename it over the original
+        const i32 wd = inotify_add_watch(m_Fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+        if (wd < 0) {
+            // e.g. packed files, their directory only exists inside the pack
+            AX_CORE_TRACE(LogChannel::Resources, "Couldn't watch directory: {0}", directory.string());
+            return;
+        }
+
+        m_Directories.emplace(wd, directory);
+        AX_CORE_TRACE(LogChannel::Resources, "Watching directory: {0}", directory.string());
+#endif
+    }
+
+    void FileWatcher::Run() {
+#ifdef AX_PLATFORM_LINUX
+        std::unordered_set<std::string> changed;
+        pollfd fds[2] = {{m_Fd, POLLIN, 0}, {m_WakeFd, POLLIN, 0}};
+
+        while (true) {
+            // Sleeps until something changes, then only until the changes settle down
+            const int timeout = changed.empty() ? -1 : static_cast<int>(m_Debounce.count());
+            const int ready = poll(fds, 2, timeout);
+
+            if (ready < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                AX_CORE_ERROR(LogChannel::Resources, "The file watcher stopped polling, hot reload is disabled");
+                return;
+            }
+
+            if (fds[1].revents & POLLIN)
+                return;
+
+            if (ready == 0)
+                ReloadBatch(changed);
+            else if (fds[0].revents & POLLIN)
+                ReadEvents(changed);
+        }
+#endif
+    }
+
+    void FileWatcher::ReadEvents(std::unordered_set<std::string>& changed) {
+#ifdef AX_PLATFORM_LINUX
+        alignas(inotify_event) char buffer[4096];
+
+        while (true) {
+            const ssize_t length = read(m_Fd, buffer, sizeof(buffer));
+
+            // Drained
+            if (length <= 0)
+                return;
+
+            std::scoped_lock lock(m_WatchMutex);
+
+            for (const char* ptr = buffer; ptr < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                auto it = m_Directories.find(event->wd);
+                if (event->len != 0 && it != m_Directories.end())
+                    changed.insert((it->second / event->name).string());
+            }
+        }
+#endif
+    }
+
+    void FileWatcher::ReloadBatch(std::unordered_set<std::string>& changed) {
+        ZoneScopedN("Reload changed files");
+
+        std::vector<FileHandle> reloaded;
+
+        for (const std::string& path : changed) {
+            Result<FileHandle> handle = ResourceManager::Find(path);
+
+            // Files that aren't loaded, e.g. the temporary files of an editor, are ignored. The ones that can't be
+            // mapped yet are still being written, the next change retries them.
+            if (handle.IsOk() && ResourceManager::Reload(handle.Unwrap()))
+                reloaded.push_back(handle.Unwrap());
+        }
+
+        changed.clear();
+
+        if (reloaded.empty())
+            return;
+
+        AX_CORE_INFO(LogChannel::Resources, "Hot reloaded {0} files", reloaded.size());
+
+        {
+            std::scoped_lock lock(m_ReloadedMutex);
+            m_Reloaded.insert(m_Reloaded.end(), reloaded.begin(), reloaded.end());
+        }
+
+        m_HasReloaded.store(true, std::memory_order_release);
+    }
+} // namespace Axle
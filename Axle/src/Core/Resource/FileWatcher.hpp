@@ -0,0 +1,175 @@
+#pragma once
+
+#include "axpch.hpp"
+
+#include "Core/Core.hpp"
+#include "Core/Types.hpp"
+
+namespace Axle {
+    /**
+     * Watches the directories of the loaded files and reloads them through the ResourceManager when they change on
+     * disk, so shaders, textures and models can be iterated on without restarting.
+     *
+     * A background thread sleeps on inotify. Changes are debounced: once a file changes the thread waits until no
+     * other change arrives for the debounce time, reloads the whole batch and hands it to the render thread, which
+     * runs the callbacks of the affected files in Update. Nothing is done per frame while no file changes.
+     *
+     * Only Linux is supported, elsewhere subscribing works but the callbacks never run.
+     * */
+    class AXLE_TEST_API FileWatcher {
+    public:
+        /**
+         * A callback registered with Subscribe. It's removed when this object is destroyed.
+         * */
+        class Subscription {
+        public:
+            Subscription() = default;
+            ~Subscription() {
+                Reset();
+            }
+
+            // Non-copyable, moveable
+            Subscription(const Subscription&) = delete;
+            Subscription& operator=(const Subscription&) = delete;
+            Subscription(Subscription&& other) noexcept
+                : m_ID(std::exchange(other.m_ID, 0)) {}
+            Subscription& operator=(Subscription&& other) noexcept {
+                if (this != &other) {
+                    Reset();
+                    m_ID = std::exchange(other.m_ID, 0);
+                }
+                return *this;
+            }
+
+            /**
+             * Removes the callback, it won't run anymore once this returns
+             * */
+            void Reset();
+
+            /**
+             * Tells if a callback is registered
+             *
+             * @returns false if it's empty, e.g. it was reset or the watcher wasn't initialized
+             * */
+            inline bool IsActive() const {
+                return m_ID != 0;
+            }
+
+        private:
+            friend class FileWatcher;
+
+            explicit Subscription(u64 id)
+                : m_ID(id) {}
+
+            /// 0 if empty
+            u64 m_ID = 0;
+        };
+
+        FileWatcher(std::chrono::milliseconds debounce);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /**
+         * Initializes the watcher and starts its thread.
+         * This function is NOT thread safe, it must be called once after the ResourceManager is initialized.
+         *
+         * @param debounce How long the watched files must stay untouched before a batch of changes is reloaded
+         * */
+        static void Init(std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+
+        /**
+         * Stops the thread and shuts down the watcher. Pending changes are dropped.
+         * This function is NOT thread safe, it must be called before shutting down the ResourceManager.
+         * */
+        static void ShutDown();
+
+        /**
+         * Tells if the watcher has been initialized
+         *
+         * @returns true if Init has been called and ShutDown hasn't
+         * */
+        inline static bool IsInitialized() {
+            return s_Instance != nullptr;
+        }
+
+        /**
+         * Registers a callback that runs on the thread calling Update every time the file is reloaded. The directory
+         * of the file starts being watched if it wasn't already.
+         *
+         * This method is thread safe. If the watcher isn't initialized an empty subscription is returned.
+         *
+         * @param handle The handle of a loaded loose file
+         * @param callback What to do once the file has been reloaded, typically rebuilding GPU objects
+         *
+         * @returns The subscription, the callback is removed when it's destroyed
+         * */
+        static Subscription Subscribe(FileHandle handle, std::function<void()> callback);
+
+        /**
+         * Runs the callbacks of the files reloaded since the last call. Meant to be called once per frame by the
+         * render thread, it's a single atomic load while nothing changed.
+         * */
+        static void Update();
+
+    private:
+        struct Callback {
+            FileHandle handle;
+            std::function<void()> callback;
+        };
+
+        /**
+         * Starts watching the directory of a file if it wasn't already
+         *
+         * @param file The path of the file
+         * */
+        void WatchDirectory(const std::filesystem::path& file);
+
+        /**
+         * Body of the watcher thread. Collects changes until the debounce time passes without new ones, then reloads
+         * them and hands them to Update.
+         * */
+        void Run();
+
+        /**
+         * Reads the pending inotify events and adds the changed files to the batch
+         *
+         * @param changed The files changed since the last reload
+         * */
+        void ReadEvents(std::unordered_set<std::string>& changed);
+
+        /**
+         * Reloads the changed files that are loaded and queues them for Update
+         *
+         * @param changed The files changed since the last reload
+         * */
+        void ReloadBatch(std::unordered_set<std::string>& changed);
+
+        void UpdateImpl();
+
+        static std::unique_ptr<FileWatcher> s_Instance;
+
+        std::chrono::milliseconds m_Debounce;
+
+        /// inotify descriptor, -1 if it couldn't be created
+        i32 m_Fd = -1;
+        /// Written to wake the thread up on shutdown
+        i32 m_WakeFd = -1;
+        std::thread m_Thread;
+
+        /// Guards the watched directories, read by the thread and written by Subscribe
+        std::mutex m_WatchMutex;
+        std::unordered_map<i32, std::filesystem::path> m_Directories;
+        std::unordered_set<std::string> m_WatchedDirectories;
+
+        /// Handles reloaded by the thread that Update hasn't dispatched yet
+        std::mutex m_ReloadedMutex;
+        std::vector<FileHandle> m_Reloaded;
+        std::atomic<bool> m_HasReloaded{false};
+
+        std::mutex m_CallbacksMutex;
+        std::unordered_map<u64, Callback> m_Callbacks;
+        u64 m_NextID = 1;
+    };
+} // namespace Axle
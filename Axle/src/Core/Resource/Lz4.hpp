@@ -0,0 +1,241 @@
+#pragma once
+
+// Dependency-free codec producing and reading the LZ4 block format, as described in doc/lz4_Block_format.md of
+// https://github.com/lz4/lz4. Used for compressed asset pack entries. Like AssetPack.hpp it's shared with AAP, so it
+// must only depend on the standard library.
+//
+// The compressor is a plain greedy single-probe matcher, it trades ratio for speed just like LZ4's fast mode. The
+// decompressor validates every length and offset, so a corrupted pack fails to load instead of reading or writing out
+// of bounds.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Axle::Lz4 {
+    namespace Detail {
+        constexpr std::size_t MIN_MATCH = 4;
+        /// The last literals of a block are never part of a match
+        constexpr std::size_t LAST_LITERALS = 5;
+        /// A match can't start in the last bytes of a block
+        constexpr std::size_t MATCH_FIND_LIMIT = 12;
+        constexpr std::size_t MAX_OFFSET = 65535;
+        constexpr std::uint32_t HASH_LOG = 12;
+
+        inline std::uint32_t Read32(const std::uint8_t* p) {
+            std::uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline std::uint32_t HashSequence(std::uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - HASH_LOG);
+        }
+
+        /// Writes the 255-terminated extension of a length that didn't fit in its token nibble
+        inline std::uint8_t* WriteLength(std::uint8_t* op, std::size_t length) {
+            while (length >= 255) {
+                *op++ = 255;
+                length -= 255;
+            }
+            *op++ = static_cast<std::uint8_t>(length);
+            return op;
+        }
+
+        /// Reads a length extension, returns false if the input ends before it does
+        inline bool ReadLength(const std::uint8_t*& ip, const std::uint8_t* iend, std::size_t& length) {
+            std::uint8_t byte;
+            do {
+                if (ip >= iend)
+                    return false;
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+    } // namespace Detail
+
+    /**
+     * Worst case size of the compressed output, for incompressible input.
+     *
+     * @param size Size of the input in bytes
+     *
+     * @returns The capacity the output buffer needs so Compress never fails
+     * */
+    constexpr std::size_t CompressBound(std::size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    /**
+     * Compresses a block.
+     *
+     * @param src The data to compress
+     * @param srcSize Size of the data in bytes
+     * @param dst The output buffer
+     * @param dstCapacity Size of the output buffer in bytes
+     *
+     * @returns The compressed size, or 0 if the output didn't fit in dstCapacity
+     * */
+    inline std::size_t Compress(const char* src, std::size_t srcSize, char* dst, std::size_t dstCapacity) {
+        using namespace Detail;
+
+        const std::uint8_t* const base = reinterpret_cast<const std::uint8_t*>(src);
+        const std::uint8_t* const iend = base + srcSize;
+        const std::uint8_t* ip = base;
+        const std::uint8_t* anchor = base;
+
+        std::uint8_t* op = reinterpret_cast<std::uint8_t*>(dst);
+        std::uint8_t* const oend = op + dstCapacity;
+
+        // Positions of the last sequence seen with each hash, checked on every hit so stale entries are harmless
+        std::array<std::uint32_t, 1u << HASH_LOG> table{};
+
+        if (srcSize > MATCH_FIND_LIMIT) {
+            const std::uint8_t* const matchFindLimit = iend - MATCH_FIND_LIMIT;
+            const std::uint8_t* const matchLimit = iend - LAST_LITERALS;
+            std::uint32_t misses = 0;
+
+            while (ip < matchFindLimit) {
+                const std::uint32_t sequence = Read32(ip);
+                const std::uint32_t hash = HashSequence(sequence);
+                const std::uint8_t* match = base + table[hash];
+                table[hash] = static_cast<std::uint32_t>(ip - base);
+
+                if (match >= ip || static_cast<std::size_t>(ip - match) > MAX_OFFSET || Read32(match) != sequence) {
+                    // Skip faster through data that doesn't compress
+                    ip += 1 + (misses++ >> 6);
+                    continue;
+                }
+                misses = 0;
+
+                // Extend the match backwards over the pending literals and then forwards
+                while (ip > anchor && match > base && ip[-1] == match[-1]) {
+                    --ip;
+                    --match;
+                }
+
+                std::size_t matchLength = MIN_MATCH;
+                while (ip + matchLength < matchLimit && ip[matchLength] == match[matchLength])
+                    ++matchLength;
+
+                const std::size_t literalLength = ip - anchor;
+                const std::size_t worstCase = 1 + literalLength + literalLength / 255 + 2 + matchLength / 255 + 2;
+
+                if (worstCase > static_cast<std::size_t>(oend - op))
+                    return 0;
+
+                // Token, literals, offset and match length
+                std::uint8_t* token = op++;
+                *token = static_cast<std::uint8_t>(std::min<std::size_t>(literalLength, 15) << 4);
+                if (literalLength >= 15)
+                    op = WriteLength(op, literalLength - 15);
+
+                std::memcpy(op, anchor, literalLength);
+                op += literalLength;
+
+                const std::size_t offset = ip - match;
+                *op++ = static_cast<std::uint8_t>(offset);
+                *op++ = static_cast<std::uint8_t>(offset >> 8);
+
+                const std::size_t extraLength = matchLength - MIN_MATCH;
+                *token |= static_cast<std::uint8_t>(std::min<std::size_t>(extraLength, 15));
+                if (extraLength >= 15)
+                    op = WriteLength(op, extraLength - 15);
+
+                ip += matchLength;
+                anchor = ip;
+
+                // Index a position inside the match so the next one is found sooner
+                if (ip < matchFindLimit)
+                    table[HashSequence(Read32(ip - 2))] = static_cast<std::uint32_t>(ip - 2 - base);
+            }
+        }
+
+        // Last literals
+        const std::size_t literalLength = iend - anchor;
+        if (1 + literalLength + literalLength / 255 + 1 > static_cast<std::size_t>(oend - op))
+            return 0;
+
+        *op++ = static_cast<std::uint8_t>(std::min<std::size_t>(literalLength, 15) << 4);
+        if (literalLength >= 15)
+            op = WriteLength(op, literalLength - 15);
+
+        std::memcpy(op, anchor, literalLength);
+        op += literalLength;
+
+        return op - reinterpret_cast<std::uint8_t*>(dst);
+    }
+
+    /**
+     * Decompresses a block whose decompressed size is known.
+     *
+     * @param src The compressed data
+     * @param srcSize Size of the compressed data in bytes
+     * @param dst The output buffer
+     * @param dstSize Exact size of the decompressed data in bytes
+     *
+     * @returns true if the block was valid and decompressed to exactly dstSize bytes, false otherwise
+     * */
+    inline bool Decompress(const char* src, std::size_t srcSize, char* dst, std::size_t dstSize) {
+        using namespace Detail;
+
+        const std::uint8_t* ip = reinterpret_cast<const std::uint8_t*>(src);
+        const std::uint8_t* const iend = ip + srcSize;
+
+        std::uint8_t* const obegin = reinterpret_cast<std::uint8_t*>(dst);
+        std::uint8_t* op = obegin;
+        std::uint8_t* const oend = op + dstSize;
+
+        while (ip < iend) {
+            const std::uint8_t token = *ip++;
+
+            std::size_t literalLength = token >> 4;
+            if (literalLength == 15 && !ReadLength(ip, iend, literalLength))
+                return false;
+
+            if (literalLength > static_cast<std::size_t>(iend - ip) ||
+                literalLength > static_cast<std::size_t>(oend - op))
+                return false;
+
+            std::memcpy(op, ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            // The last sequence has no match
+            if (ip == iend)
+                return op == oend;
+
+            if (iend - ip < 2)
+                return false;
+
+            const std::size_t offset = ip[0] | (static_cast<std::size_t>(ip[1]) << 8);
+            ip += 2;
+
+            if (offset == 0 || offset > static_cast<std::size_t>(op - obegin))
+                return false;
+
+            std::size_t matchLength = token & 15;
+            if (matchLength == 15 && !ReadLength(ip, iend, matchLength))
+                return false;
+            matchLength += MIN_MATCH;
+
+            if (matchLength > static_cast<std::size_t>(oend - op))
+                return false;
+
+            const std::uint8_t* match = op - offset;
+
+            if (offset >= matchLength) {
+                std::memcpy(op, match, matchLength);
+                op += matchLength;
+            } else {
+                // Overlapping copy, repeats the last `offset` bytes
+                for (std::size_t i = 0; i < matchLength; ++i)
+                    *op++ = match[i];
+            }
+        }
+
+        return false;
+    }
+} // namespace Axle::Lz4
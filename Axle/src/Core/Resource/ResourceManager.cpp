@@ -1,209 +1,1523 @@
 #include "axpch.hpp"
 
 #include "ResourceManager.hpp"
+#include "AssetPack.hpp"
+#include "BufferPool.hpp"
+#include "XxHash.hpp"
 #include "Core/Error/Error.hpp"
 #include "Core/Error/Result.hpp"
+#include "Core/Parallel/Parallel.hpp"
 #include "../Types.hpp"
 #include "../Logger/Log.hpp"
 
 #include <fstream>
 #include <mio/mmap.hpp>
+#include <CoroWeaver.hpp>
 #include "Core/Error/Panic.hpp"
 
+#ifdef AX_PLATFORM_LINUX
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/resource.h>
+#    include <unistd.h>
+// Missing from older headers, kernels older than 5.14 reject it and the pages are touched instead
+#    ifndef MADV_POPULATE_READ
+#        define MADV_POPULATE_READ 22
+#    endif
+#elif AX_PLATFORM_WINDOWS
+#    include <windows.h>
+#endif
+
 namespace Axle {
     std::unique_ptr<ResourceManager> ResourceManager::s_Instance = nullptr;
 
-    struct ResourceManager::Resource {
-        std::variant<mio::mmap_source, mio::mmap_sink> mmap;
-        std::filesystem::path path;
-        u32 magic;
-        std::unique_ptr<std::shared_mutex> m_Mutex;
-        MovableAtomic m_RefCount{1};
-    };
+    struct ResourceManager::DirtyRanges {
+        /// Past this many separate ranges they're merged into one, syncing a few clean pages is cheaper than keeping
+        /// an unbounded list
+        static constexpr u64 MaxRanges = 32;
+
+        /// Page aligned [begin, end) byte offsets, sorted and neither overlapping nor touching
+        std::vector<std::pair<u64, u64>> ranges;
+        /// Writers hold the resource mutex exclusively but syncs only hold it shared
+        std::mutex mutex;
+
+        void Add(u64 begin, u64 end) {
+            std::scoped_lock lock(mutex);
+
+            auto it = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(begin, u64(0)));
+
+            // Merge with the previous range if it reaches this one
+            if (it != ranges.begin() && std::prev(it)->second >= begin)
+                --it;
+
+            if (it == ranges.end() || it->first > end) {
+                ranges.insert(it, {begin, end});
+            } else {
+                // Swallow every range this one overlaps or touches
+                it->first = std::min(it->first, begin);
+                it->second = std::max(it->second, end);
+
+                auto last = std::next(it);
+                while (last != ranges.end() && last->first <= it->second) {
+                    it->second = std::max(it->second, last->second);
+                    ++last;
+                }
+                ranges.erase(std::next(it), last);
+            }
+
+            if (ranges.size() > MaxRanges)
+                ranges = {{ranges.front().first, ranges.back().second}};
+        }
+    };
+
+    struct ResourceManager::PackedEntry {
+        std::shared_ptr<const mio::mmap_source> pack;
+        /// The data of the entry inside the pack
+        const char* stored = nullptr;
+        u64 storedSize = 0;
+        /// Size of the asset once loaded
+        u64 size = 0;
+        u32 chunkSize = 0;
+        bool compressed = false;
+        /// Hash of the asset once loaded, 0 if the pack didn't store it
+        u64 contentHash = 0;
+    };
+
+    struct ResourceManager::PackedRange {
+        /// The entry the asset comes from. Its reference keeps the pack mapped while any of its assets is loaded, even
+        /// if it gets unmounted, so decompressed assets can be decompressed again after being evicted.
+        PackedEntry entry;
+        /// nullptr while a decompressed asset is evicted
+        const char* data = nullptr;
+        u64 size = 0;
+        /// Owns the data of decompressed assets, it goes back to the pool when the asset is closed or evicted
+        BufferPool::Buffer buffer;
+    };
+
+    struct ResourceManager::HeapCopy {
+        /// Goes back to the pool when the file is closed or evicted
+        BufferPool::Buffer buffer;
+    };
+
+    struct ResourceManager::SharedMapping {
+        /// The mapping of the first file loaded with these contents, unmapped along with its last reference. Dropped
+        /// while the file is evicted.
+        std::shared_ptr<const void> owner;
+        const char* data = nullptr;
+        u64 size = 0;
+        /// The entry of this file if it's packed, no pack if it's loose
+        PackedEntry source;
+    };
+
+    struct ResourceManager::MountedPack {
+        std::filesystem::path path;
+        /// Normalized path of the pack itself
+        std::string key;
+        /// Normalized mount point followed by a '/', the prefix of every key served by this pack
+        std::string mountKey;
+        std::shared_ptr<const mio::mmap_source> mmap;
+    };
+
+    // Aligned to a cache line so threads working on different resources don't share their mutexes' lines
+    struct alignas(64) ResourceManager::Resource {
+        std::variant<mio::mmap_source, mio::mmap_sink, PackedRange, HeapCopy, SharedMapping> mmap;
+        /// Mappings replaced by a growing resize that guards may still point into. They're dropped by the next thread
+        /// that locks the resource exclusively, by then every guard taken before the resize has been released.
+        std::vector<decltype(mmap)> retired;
+        std::filesystem::path path;
+        /// Normalized path used as the key of m_PathIndex
+        std::string key;
+        /// Hash of the contents, 0 if the file isn't shared by content. Only written with the table lock held
+        /// exclusively, GetContentHash reads it without locking.
+        std::atomic<u64> contentHash{0};
+        /// Handle of the file living in this slot, INVALID_FILE_HANDLE while the slot is free. Its magic is the
+        /// generation of the slot, so stale handles never match once the slot is reused.
+        std::atomic<FileHandle> handle{INVALID_FILE_HANDLE};
+        /// Bumped every time the slot is freed. Only touched by the thread that took the slot out of the free list.
+        u32 generation = 0;
+        /// Index plus one of the next slot in the free list, 0 if this is the last one
+        std::atomic<u32> nextFree{0};
+        /// Published data pointer and size of mmap. Readers load the size first and then the pointer, a growing resize
+        /// stores them the other way around so a reader never pairs the new size with the old, shorter mapping. They
+        /// also keep Size and IsReadOnly from locking the resource.
+        std::atomic<const char*> data{nullptr};
+        std::atomic<u64> size{0};
+        std::atomic<bool> readOnly{true};
+        /// The options the file was loaded with, used again to map it after an eviction
+        LoadOptions options;
+        DirtyRanges dirty;
+        std::shared_mutex m_Mutex;
+        /// Guards mmap against a growing resize, which doesn't lock m_Mutex. Always taken after m_Mutex.
+        std::mutex m_RemapMutex;
+        std::atomic<u32> m_RefCount{0};
+        /// Steady clock tick of the last guard taken on the resource, drives the LRU eviction
+        std::atomic<i64> lastAccess{0};
+        /// Set while the mapping is dropped, only written with the resource mutex held exclusively
+        std::atomic<bool> evicted{false};
+        std::atomic<u32> evictions{0};
+        /// Bumped every time the file is reloaded after changing on disk
+        std::atomic<u32> version{0};
+    };
+
+    namespace {
+        // Templated on the packed range, the heap copy and the shared mapping so the private types don't have to be
+        // named here
+
+        template <typename PackedRange, typename HeapCopy, typename SharedMapping>
+        u64 MappedSize(
+            const std::variant<mio::mmap_source, mio::mmap_sink, PackedRange, HeapCopy, SharedMapping>& mmap) {
+            if (std::holds_alternative<mio::mmap_source>(mmap))
+                return std::get<mio::mmap_source>(mmap).size();
+            else if (std::holds_alternative<mio::mmap_sink>(mmap))
+                return std::get<mio::mmap_sink>(mmap).size();
+            else if (std::holds_alternative<PackedRange>(mmap))
+                return std::get<PackedRange>(mmap).size;
+            else if (std::holds_alternative<HeapCopy>(mmap))
+                return std::get<HeapCopy>(mmap).buffer.Size();
+            else
+                return std::get<SharedMapping>(mmap).size;
+        }
+
+        template <typename PackedRange, typename HeapCopy, typename SharedMapping>
+        const char* MappedData(
+            const std::variant<mio::mmap_source, mio::mmap_sink, PackedRange, HeapCopy, SharedMapping>& mmap) {
+            if (std::holds_alternative<mio::mmap_source>(mmap))
+                return std::get<mio::mmap_source>(mmap).data();
+            else if (std::holds_alternative<mio::mmap_sink>(mmap))
+                return std::get<mio::mmap_sink>(mmap).data();
+            else if (std::holds_alternative<PackedRange>(mmap))
+                return std::get<PackedRange>(mmap).data;
+            else if (std::holds_alternative<HeapCopy>(mmap))
+                return std::get<HeapCopy>(mmap).buffer.Data();
+            else
+                return std::get<SharedMapping>(mmap).data;
+        }
+
+        /// Packed assets only drop their reference to the pack, which is unmapped along with its last asset. Heap
+        /// copies give their buffer back to the pool. Shared mappings drop their reference and keep their source.
+        template <typename PackedRange, typename HeapCopy, typename SharedMapping>
+        void Unmap(std::variant<mio::mmap_source, mio::mmap_sink, PackedRange, HeapCopy, SharedMapping>& mmap) {
+            if (std::holds_alternative<mio::mmap_source>(mmap)) {
+                std::get<mio::mmap_source>(mmap).unmap();
+            } else if (std::holds_alternative<mio::mmap_sink>(mmap)) {
+                std::get<mio::mmap_sink>(mmap).unmap();
+            } else if (std::holds_alternative<PackedRange>(mmap)) {
+                mmap = PackedRange{};
+            } else if (std::holds_alternative<HeapCopy>(mmap)) {
+                std::get<HeapCopy>(mmap).buffer = BufferPool::Buffer();
+            } else {
+                SharedMapping& shared = std::get<SharedMapping>(mmap);
+                shared.owner.reset();
+                shared.data = nullptr;
+            }
+        }
+
+        u64 PageSize() {
+#ifdef AX_PLATFORM_LINUX
+            static const u64 pageSize = static_cast<u64>(sysconf(_SC_PAGESIZE));
+            return pageSize;
+#else
+            return 4096;
+#endif
+        }
+
+        /// Asks the kernel to start reading the range in the background. On Linux this is the same readahead that
+        /// readahead(2) triggers but it works directly on the mapping.
+        bool AdviseWillNeed(const char* data, u64 size) {
+#ifdef AX_PLATFORM_LINUX
+            // madvise needs a page aligned address
+            const uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(PageSize() - 1);
+            const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+            return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED) == 0;
+#elif AX_PLATFORM_WINDOWS
+            WIN32_MEMORY_RANGE_ENTRY range{const_cast<char*>(data), static_cast<SIZE_T>(size)};
+            return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#endif
+        }
+
+        /// Drops the pages of the range from the process, the next access reads them again (from the page cache if they
+        /// are still there). Pages shared with neighbouring packed assets are dropped too, it only costs them a fault.
+        bool AdviseDontNeed(const char* data, u64 size) {
+#ifdef AX_PLATFORM_LINUX
+            const uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(PageSize() - 1);
+            const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+            return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED) == 0;
+#elif AX_PLATFORM_WINDOWS
+            // Unlocking pages that aren't locked removes them from the working set
+            VirtualUnlock(const_cast<char*>(data), static_cast<SIZE_T>(size));
+            return true;
+#endif
+        }
+
+        /// Reads one byte of every page so all of them are faulted in
+        void TouchPages(const char* data, u64 size) {
+            const u64 pageSize = PageSize();
+            u8 accumulator = 0;
+
+            for (u64 offset = 0; offset < size; offset += pageSize)
+                accumulator ^= static_cast<u8>(data[offset]);
+
+            // Keeps the compiler from optimizing the reads away
+            volatile u8 sink = accumulator;
+            (void) sink;
+        }
+
+        /**
+         * Applies the hints of the load options to a mapping. Prefaulting uses MADV_POPULATE_READ, which does what
+         * MAP_POPULATE does but on an existing mapping, and falls back to touching every page on older kernels.
+         *
+         * @returns true if every hint was accepted, false otherwise. The data is usable either way
+         * */
+        bool ApplyLoadOptions(const char* data, u64 size, const ResourceManager::LoadOptions& options) {
+            bool applied = true;
+
+#ifdef AX_PLATFORM_LINUX
+            const uintptr_t begin = reinterpret_cast<uintptr_t>(data) & ~(PageSize() - 1);
+            const uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+            void* const address = reinterpret_cast<void*>(begin);
+
+            // The access pattern goes first so prefaulting already reads ahead accordingly
+            if (options.access == ResourceManager::LoadOptions::Access::Sequential)
+                applied &= madvise(address, end - begin, MADV_SEQUENTIAL) == 0;
+            else if (options.access == ResourceManager::LoadOptions::Access::Random)
+                applied &= madvise(address, end - begin, MADV_RANDOM) == 0;
+
+            if (options.hugePages)
+                applied &= madvise(address, end - begin, MADV_HUGEPAGE) == 0;
+
+            if (options.prefault && madvise(address, end - begin, MADV_POPULATE_READ) != 0)
+                TouchPages(data, size);
+#elif AX_PLATFORM_WINDOWS
+            // Windows has no equivalent for the access pattern or huge pages on file mappings
+            if (options.prefault) {
+                AdviseWillNeed(data, size);
+                TouchPages(data, size);
+            }
+#endif
+
+            return applied;
+        }
+
+        /**
+         * Writes a range of a writable mapping back to its file. Synchronous flushes wait until the data is on disk,
+         * asynchronous ones only start the writeback.
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        bool FlushRange(mio::mmap_sink& map, u64 offset, u64 size, bool async) {
+#ifdef AX_PLATFORM_LINUX
+            if (msync(map.data() + offset, size, async ? MS_ASYNC : MS_SYNC) != 0)
+                return false;
+
+            // MS_ASYNC does nothing on Linux since the kernel already tracks dirty pages, this starts their writeback
+            if (async)
+                sync_file_range(map.file_handle(), static_cast<off_t>(offset), size, SYNC_FILE_RANGE_WRITE);
+
+            return true;
+#elif AX_PLATFORM_WINDOWS
+            if (!FlushViewOfFile(map.data() + offset, static_cast<SIZE_T>(size)))
+                return false;
+
+            return async || FlushFileBuffers(map.file_handle());
+#endif
+        }
+
+        /// Counts the bytes of the range whose pages are in memory. Whole pages are asked for, the parts outside the
+        /// range aren't counted.
+        u64 CountResidentBytes(const char* data, u64 size) {
+            if (data == nullptr || size == 0)
+                return 0;
+
+#ifdef AX_PLATFORM_LINUX
+            const u64 pageSize = PageSize();
+            const uintptr_t first = reinterpret_cast<uintptr_t>(data);
+            const uintptr_t begin = first & ~(pageSize - 1);
+            const uintptr_t end = first + size;
+
+            std::vector<unsigned char> pages((end - begin + pageSize - 1) / pageSize);
+
+            if (mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) != 0)
+                return size;
+
+            u64 resident = 0;
+
+            for (u64 i = 0; i < pages.size(); ++i) {
+                if (pages[i] & 1)
+                    resident += std::min(begin + (i + 1) * pageSize, end) - std::max(begin + i * pageSize, first);
+            }
+
+            return resident;
+#elif AX_PLATFORM_WINDOWS
+            // QueryWorkingSetEx could tell but it only knows about the working set, not the standby list
+            return size;
+#endif
+        }
+
+        i64 Now() {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        /**
+         * Decompresses every chunk of a compressed asset, spread across the job system workers with ParallelFor. The
+         * calling thread takes part and only waits for chunks that are already being decompressed, so this can be
+         * called from inside a job too.
+         *
+         * @returns true if every chunk was valid, false otherwise
+         * */
+        bool DecompressChunks(const char* stored, u64 storedSize, u64 size, u32 chunkSize, char* dst) {
+            std::atomic<bool> failed{false};
+
+            ParallelFor(0, AssetPack::ChunkCount(size, chunkSize), 1, [&](u64 chunk) {
+                if (!AssetPack::DecompressChunk(stored, storedSize, size, chunkSize, chunk, dst))
+                    failed.store(true, std::memory_order_relaxed);
+            });
+
+            return !failed.load(std::memory_order_relaxed);
+        }
+    } // namespace
+
+    ResourceManager::ResourceManager() = default;
+
+    ResourceManager::~ResourceManager() {
+        for (std::atomic<Resource*>& chunk : m_Chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    void ResourceManager::Init() {
+        if (s_Instance != nullptr) {
+            AX_CORE_WARN(LogChannel::Resources,
+                         "Init method of the Resource Manager has been called a second time. IGNORING");
+            return;
+        }
+
+        s_Instance = std::make_unique<ResourceManager>();
+
+        AX_CORE_INFO(LogChannel::Resources, "Resource Manager initialized...");
+    }
+
+    void ResourceManager::ShutDown() {
+        {
+            std::unique_lock lock(s_Instance->m_Mutex);
+
+            // Close all remaining files
+            const u32 count = s_Instance->m_LargestAvailableIndex.load(std::memory_order_acquire);
+            for (u32 index = 0; index < count; ++index) {
+                Resource* resource = s_Instance->GetSlot(index);
+                if (resource == nullptr)
+                    continue;
+
+                FileHandle h = resource->handle.load(std::memory_order_acquire);
+                if (h != INVALID_FILE_HANDLE && s_Instance->CloseUnsafe(h))
+                    s_Instance->FinishClose(index);
+            }
+        }
+
+        s_Instance.reset();
+        AX_CORE_INFO(LogChannel::Resources, "Resource Manager deleted...");
+    }
+
+    Result<ResourceManager::ManagedFileHandle>
+    ResourceManager::LoadImpl(const std::filesystem::path& path, bool readOnly, const LoadOptions& options) {
+        // Normalizing touches the filesystem, so it's done before taking the lock
+        std::string key = NormalizePath(path);
+
+        // File was already opened so return a valid handle to it. A file in the index always has at least one
+        // reference, the last one is only released under the exclusive lock, so a shared lock is enough here.
+        {
+            std::shared_lock lock(m_Mutex);
+
+            Result<FileHandle> e = IsAlreadyOpenedUnsafe(key);
+            if (e.IsOk()) {
+                FileHandle h = e.Unwrap();
+                GetResource(h)->m_RefCount.fetch_add(1, std::memory_order_relaxed);
+                return ResourceManager::ManagedFileHandle(h);
+            }
+        }
+
+        decltype(Resource::mmap) mmap;
+        u64 contentHash = 0;
+        /// Stays empty for loose files
+        PackedEntry entry;
+
+        // Loose files override packed ones
+        if (DoesFileExist(path)) {
+            const u64 fileSize = std::filesystem::file_size(path);
+
+            if (fileSize == 0) {
+                return Result<ResourceManager::ManagedFileHandle>::Err(
+                    Error(ErrorCode::AssetLoadFailed, "Cannot map an empty file"));
+            }
+
+            MakeRoom(fileSize);
+
+            // Mapping is the expensive part, it's done without holding any lock
+            std::error_code error = MapLooseFile(path, readOnly, options, mmap);
+
+            if (error) {
+                AX_CORE_ERROR(
+                    LogChannel::Resources, "There has been an error trying to read a file: {0}", error.message());
+                return Result<ResourceManager::ManagedFileHandle>::Err(
+                    Error(ErrorCode::AssetLoadFailed, error.message()));
+            }
+        } else {
+            bool found;
+
+            {
+                std::shared_lock lock(m_Mutex);
+                found = FindPackedUnsafe(key, entry);
+            }
+
+            if (!found) {
+                AX_CORE_ERROR(LogChannel::Resources, "Trying to load a non-existing file: {0}", path.string());
+                return Result<ResourceManager::ManagedFileHandle>::Err(
+                    Error(ErrorCode::NotFound, "Trying to load a non-existing file."));
+            }
+
+            if (!readOnly) {
+                AX_CORE_ERROR(
+                    LogChannel::Resources, "Packed files can only be loaded as read-only: {0}", path.string());
+                return Result<ResourceManager::ManagedFileHandle>::Err(
+                    Error(ErrorCode::InvalidArgument, "Packed files can only be loaded as read-only"));
+            }
+
+            MakeRoom(entry.size);
+
+            // Decompressing is done without holding any lock, just like mapping
+            PackedRange range;
+            if (!MapPacked(entry, range)) {
+                AX_CORE_ERROR(LogChannel::Resources, "Packed file is corrupted: {0}", path.string());
+                return Result<ResourceManager::ManagedFileHandle>::Err(
+                    Error(ErrorCode::AssetLoadFailed, "Packed file is corrupted"));
+            }
+
+            // Decompressed assets already live in the heap, fully written
+            if (!entry.compressed && !ApplyLoadOptions(range.data, range.size, options))
+                AX_CORE_WARN(LogChannel::Resources, "Failed to apply the load options to: {0}", path.string());
+
+            mmap = std::move(range);
+            contentHash = entry.contentHash;
+        }
+
+        // Files whose contents are already loaded under another path share that mapping, this one is dropped. The
+        // file still gets its own slot, so reloading it or the other ones never affects the rest.
+        if (options.deduplicate && readOnly) {
+            if (contentHash == 0)
+                contentHash = XxHash::Hash64(MappedData(mmap), MappedSize(mmap));
+
+            // 0 means not shared
+            contentHash = std::max<u64>(contentHash, 1);
+
+            SharedMapping shared;
+            shared.source = entry;
+
+            if (ShareIdentical(contentHash, MappedData(mmap), MappedSize(mmap), shared)) {
+                AX_CORE_TRACE(
+                    LogChannel::Resources, "Loaded file with the contents of another one: {0}", path.string());
+                mmap = std::move(shared);
+            } else {
+                ShareMapping(mmap, entry);
+            }
+        } else {
+            contentHash = 0;
+        }
+
+        // The slot is invisible until its handle is published, so it's claimed without the table lock
+        Result<u32> eIndex = AcquireSlot();
+
+        if (eIndex.IsErr()) {
+            AX_CORE_ERROR(LogChannel::Resources, "Too many opened files, cannot load: {0}", path.string());
+            return Result<ResourceManager::ManagedFileHandle>::Err(eIndex.UnwrapErr());
+        }
+
+        const u32 index = eIndex.Unwrap();
+        Resource* resource = GetSlot(index);
+
+        std::unique_lock lock(m_Mutex);
+
+        // Another thread may have opened the same file while we were mapping it, in that case our map is dropped
+        Result<FileHandle> e = IsAlreadyOpenedUnsafe(key);
+        if (e.IsOk()) {
+            FileHandle h = e.Unwrap();
+            GetResource(h)->m_RefCount.fetch_add(1, std::memory_order_relaxed);
+            ReleaseSlot(index);
+            return ResourceManager::ManagedFileHandle(h);
+        }
+
+        // File opened succesfully
+        FileHandle h = MakeHandle(index, resource->generation);
+
+        {
+            // Threads holding a stale handle may still be locking the slot while they find out it's not valid
+            std::unique_lock resourceLock(resource->m_Mutex);
+
+            const u64 size = MappedSize(mmap);
+            resource->data.store(MappedData(mmap), std::memory_order_relaxed);
+            resource->size.store(size, std::memory_order_relaxed);
+            resource->readOnly.store(readOnly, std::memory_order_relaxed);
+            resource->options = options;
+            resource->lastAccess.store(Now(), std::memory_order_relaxed);
+            resource->evicted.store(false, std::memory_order_relaxed);
+            resource->evictions.store(0, std::memory_order_relaxed);
+            resource->version.store(0, std::memory_order_relaxed);
+            resource->contentHash.store(contentHash, std::memory_order_relaxed);
+            // Shared mappings are counted by ShareMapping
+            if (!std::holds_alternative<SharedMapping>(mmap))
+                m_ResidentBytes.fetch_add(size, std::memory_order_relaxed);
+            resource->mmap = std::move(mmap);
+            resource->path = path;
+            resource->key = key;
+            resource->m_RefCount.store(1, std::memory_order_relaxed);
+
+            // Publishes the slot, from now on the handle is valid
+            resource->handle.store(h, std::memory_order_release);
+        }
+
+        m_PathIndex.emplace(std::move(key), index);
+
+        if (contentHash != 0)
+            m_ContentIndex.emplace(contentHash, index);
+
+        AX_CORE_TRACE(LogChannel::Resources, "Loaded file: {0}", path.string());
+
+        return ResourceManager::ManagedFileHandle(h);
+    }
+
+    cw::JobCoroutine<Result<ResourceManager::ManagedFileHandle>>
+    ResourceManager::LoadAsync(std::filesystem::path path, bool readOnly, bool preTouch) {
+        Result<ManagedFileHandle> handle = Load(path, readOnly);
+
+        if (handle.IsOk())
+            GetInstance().PrefetchImpl(handle.Unwrap().Get(), true, preTouch);
+
+        co_return std::move(handle);
+    }
+
+    cw::JobCoroutine<std::vector<Result<ResourceManager::ManagedFileHandle>>>
+    ResourceManager::LoadBatchAsync(std::vector<std::filesystem::path> paths, bool readOnly, bool preTouch) {
+        std::vector<Result<ManagedFileHandle>> handles;
+        handles.reserve(paths.size());
+
+        // Hint every file as soon as it's mapped so the kernel reads all of them at the same time
+        for (const std::filesystem::path& path : paths) {
+            Result<ManagedFileHandle> handle = Load(path, readOnly);
+
+            if (handle.IsOk())
+                GetInstance().PrefetchImpl(handle.Unwrap().Get(), true, false);
+
+            handles.push_back(std::move(handle));
+        }
+
+        // By now most of the pages should already be on their way
+        if (preTouch) {
+            for (Result<ManagedFileHandle>& handle : handles) {
+                if (handle.IsOk())
+                    GetInstance().PrefetchImpl(handle.Unwrap().Get(), false, true);
+            }
+        }
+
+        co_return std::move(handles);
+    }
+
+    bool ResourceManager::PrefetchImpl(FileHandle handle, bool advise, bool touch) {
+        std::shared_lock<std::shared_mutex> lock;
+        Result<Resource*> locked = LockResidentResource(handle, lock);
+
+        if (locked.IsErr()) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a file with an invalid handle");
+            return false;
+        }
+
+        const Resource* resource = locked.Unwrap();
+
+        const u64 size = resource->size.load(std::memory_order_acquire);
+        const char* data = resource->data.load(std::memory_order_acquire);
+
+        if (advise && !AdviseWillNeed(data, size)) {
+            // Only a hint, the data is still perfectly usable
+            AX_CORE_WARN(LogChannel::Resources, "Failed to prefetch file: {0}", resource->path.string());
+        }
+
+        if (touch)
+            TouchPages(data, size);
+
+        AX_CORE_TRACE(LogChannel::Resources, "Prefetched file: {0}", resource->path.string());
+        return true;
+    }
+
+    Result<FileHandle> ResourceManager::IsAlreadyOpenedUnsafe(const std::string& key) const {
+        auto it = m_PathIndex.find(key);
+
+        if (it != m_PathIndex.end()) {
+            // File has already been opened, return a valid handle to it
+            return GetSlot(it->second)->handle.load(std::memory_order_relaxed);
+        }
+
+        return Result<FileHandle>::Err(Error(ErrorCode::Unknown, "File has not already been opened."));
+    }
+
+    bool ResourceManager::FindPackedUnsafe(const std::string& key, PackedEntry& entry) const {
+        for (auto it = m_Packs.rbegin(); it != m_Packs.rend(); ++it) {
+            if (!key.starts_with(it->mountKey))
+                continue;
+
+            const char* data = it->mmap->data();
+            const std::string_view name = std::string_view(key).substr(it->mountKey.size());
+            const AssetPack::Entry* found = AssetPack::Find(data, name);
+
+            if (found != nullptr) {
+                entry.pack = it->mmap;
+                entry.stored = data + found->offset;
+                entry.storedSize = found->storedSize;
+                entry.size = found->size;
+                entry.chunkSize = reinterpret_cast<const AssetPack::Header*>(data)->chunkSize;
+                entry.compressed = (found->flags & AssetPack::ENTRY_COMPRESSED) != 0;
+                entry.contentHash = found->contentHash;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool ResourceManager::MapPacked(const PackedEntry& entry, PackedRange& range) {
+        if (!entry.compressed) {
+            // Stored as is, the asset is served straight from the pack mapping
+            if (entry.storedSize != entry.size)
+                return false;
+
+            range.entry = entry;
+            range.data = entry.stored;
+            range.size = entry.size;
+            return true;
+        }
+
+        BufferPool::Buffer buffer = m_BufferPool.Acquire(entry.size);
+
+        if (!DecompressChunks(entry.stored, entry.storedSize, entry.size, entry.chunkSize, buffer.Data()))
+            return false;
+
+        range.entry = entry;
+        range.data = buffer.Data();
+        range.size = entry.size;
+        range.buffer = std::move(buffer);
+
+        AX_CORE_TRACE(
+            LogChannel::Resources, "Decompressed a packed file: {0} -> {1} bytes", entry.storedSize, entry.size);
+        return true;
+    }
+
+    bool ResourceManager::MountPackImpl(const std::filesystem::path& pack, const std::filesystem::path& mountPoint) {
+        if (!DoesFileExist(pack)) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to mount a non-existing pack: {0}", pack.string());
+            return false;
+        }
+
+        // The whole pack is a single mapping shared by every asset loaded from it
+        std::error_code error;
+        auto mmap = std::make_shared<const mio::mmap_source>(mio::make_mmap_source(pack.string(), error));
+
+        if (error) {
+            AX_CORE_ERROR(LogChannel::Resources, "There has been an error trying to map a pack: {0}", error.message());
+            return false;
+        }
+
+        const AssetPack::Header* header = AssetPack::ValidateHeader(mmap->data(), mmap->size());
+
+        if (header == nullptr) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to mount an invalid or corrupted pack: {0}", pack.string());
+            return false;
+        }
+
+        std::string key = NormalizePath(pack);
+        std::string mountKey = NormalizePath(mountPoint.empty() ? std::filesystem::path(".") : mountPoint);
+
+        if (!mountKey.ends_with('/'))
+            mountKey += '/';
+
+        const u32 entryCount = header->entryCount;
+
+        std::unique_lock lock(m_Mutex);
+
+        for (const MountedPack& mounted : m_Packs) {
+            if (mounted.key == key) {
+                AX_CORE_WARN(LogChannel::Resources, "Pack {0} is already mounted. IGNORING", pack.string());
+                return false;
+            }
+        }
+
+        m_Packs.push_back(MountedPack{pack, std::move(key), std::move(mountKey), std::move(mmap)});
+
+        AX_CORE_INFO(LogChannel::Resources,
+                     "Mounted pack {0} with {1} files at {2}",
+                     pack.string(),
+                     entryCount,
+                     mountPoint.string());
+        return true;
+    }
+
+    bool ResourceManager::UnmountPackImpl(const std::filesystem::path& pack) {
+        std::string key = NormalizePath(pack);
+
+        std::unique_lock lock(m_Mutex);
+
+        auto it = std::find_if(
+            m_Packs.begin(), m_Packs.end(), [&key](const MountedPack& mounted) { return mounted.key == key; });
+
+        if (it == m_Packs.end()) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to unmount a pack that is not mounted: {0}", pack.string());
+            return false;
+        }
+
+        m_Packs.erase(it);
+
+        AX_CORE_INFO(LogChannel::Resources, "Unmounted pack {0}", pack.string());
+        return true;
+    }
+
+    template <typename Mapping>
+    std::error_code ResourceManager::MapLooseFile(const std::filesystem::path& path,
+                                                  bool readOnly,
+                                                  const LoadOptions& options,
+                                                  Mapping& mmap) {
+        std::error_code error;
+        const u64 size = std::filesystem::file_size(path, error);
+
+        if (error)
+            return error;
+
+        if (readOnly && size != 0 && size <= options.heapCopyMaxSize) {
+            HeapCopy copy;
+            copy.buffer = m_BufferPool.Acquire(size);
+
+            std::ifstream file(path, std::ios::binary);
+            if (!file.read(copy.buffer.Data(), static_cast<std::streamsize>(size)))
+                return std::make_error_code(std::errc::io_error);
+
+            mmap = std::move(copy);
+            return error;
+        }
+
+        if (readOnly)
+            mmap = mio::make_mmap_source(path.string(), error);
+        else
+            mmap = mio::make_mmap_sink(path.string(), error);
+
+        if (!error && !ApplyLoadOptions(MappedData(mmap), MappedSize(mmap), options))
+            AX_CORE_WARN(LogChannel::Resources, "Failed to apply the load options to: {0}", path.string());
+
+        return error;
+    }
+
+    void ResourceManager::SetResidencyBudgetImpl(u64 bytes) {
+        m_ResidencyBudget.store(bytes, std::memory_order_relaxed);
+
+        if (bytes != 0)
+            EvictLeastRecentlyUsed(bytes, Now());
+
+        AX_CORE_INFO(LogChannel::Resources, "Residency budget set to {0} bytes", bytes);
+    }
+
+    u64 ResourceManager::EvictIdleImpl(std::chrono::nanoseconds idleFor) {
+        const i64 idleBefore = Now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(idleFor).count();
+        return EvictLeastRecentlyUsed(0, idleBefore);
+    }
+
+    ResourceManager::ResidencyStats ResourceManager::GetResidencyStatsImpl() const {
+        ResidencyStats stats;
+        stats.budget = m_ResidencyBudget.load(std::memory_order_relaxed);
+        stats.residentBytes = m_ResidentBytes.load(std::memory_order_relaxed);
+        stats.evictions = m_Evictions.load(std::memory_order_relaxed);
+        stats.evictedBytes = m_EvictedBytes.load(std::memory_order_relaxed);
+        stats.restores = m_Restores.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    Result<ResourceManager::ResidencyInfo> ResourceManager::GetResidencyImpl(FileHandle handle) const {
+        const Resource* resource = GetResource(handle);
+
+        if (resource != nullptr) {
+            ResidencyInfo info;
+            info.resident = !resource->evicted.load(std::memory_order_acquire);
+            info.lastAccess = std::chrono::steady_clock::time_point(
+                std::chrono::steady_clock::duration(resource->lastAccess.load(std::memory_order_relaxed)));
+            info.evictions = resource->evictions.load(std::memory_order_relaxed);
+
+            // The values are only meaningful if the slot wasn't reused while reading them
+            if (resource->handle.load(std::memory_order_acquire) == handle)
+                return info;
+        }
+
+        AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+        return Result<ResidencyInfo>::Err(
+            Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
+    }
+
+    Result<u64> ResourceManager::GetResidentBytesImpl(FileHandle handle) const {
+        // Keeps the mapping from being dropped or replaced while it's inspected
+        std::shared_lock<std::shared_mutex> lock;
+        const Resource* resource = LockResource(handle, lock);
+
+        if (resource == nullptr) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+            return Result<u64>::Err(
+                Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
+        }
+
+        return ResidentBytesUnsafe(*resource);
+    }
+
+    std::vector<ResourceManager::MappedFileInfo> ResourceManager::GetMappedFilesImpl() const {
+        std::vector<MappedFileInfo> files;
+        const u32 count = m_LargestAvailableIndex.load(std::memory_order_acquire);
+
+        for (u32 index = 0; index < count; ++index) {
+            Resource* resource = GetSlot(index);
+
+            // Claimed by a Load that didn't create its chunk yet
+            if (resource == nullptr)
+                continue;
+
+            std::shared_lock lock(resource->m_Mutex, std::try_to_lock);
+            const FileHandle handle = resource->handle.load(std::memory_order_acquire);
+
+            if (!lock.owns_lock() || handle == INVALID_FILE_HANDLE)
+                continue;
+
+            MappedFileInfo& info = files.emplace_back();
+            info.handle = handle;
+            info.path = resource->path;
+            info.mappedBytes =
+                resource->evicted.load(std::memory_order_relaxed) ? 0 : resource->size.load(std::memory_order_acquire);
+            info.residentBytes = ResidentBytesUnsafe(*resource);
+        }
+
+        return files;
+    }
+
+    ResourceManager::FaultStats ResourceManager::SampleFrameFaultsImpl() {
+        FaultStats frame;
+
+#ifdef AX_PLATFORM_LINUX
+        rusage usage;
+
+        if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+            const FaultStats now{static_cast<u64>(usage.ru_minflt), static_cast<u64>(usage.ru_majflt)};
+            // The first call of each thread only sets the starting point
+            thread_local FaultStats previous = now;
+
+            frame.minorFaults = now.minorFaults - previous.minorFaults;
+            frame.majorFaults = now.majorFaults - previous.majorFaults;
+            previous = now;
+        }
+#endif
+
+        m_FrameMinorFaults.store(frame.minorFaults, std::memory_order_relaxed);
+        m_FrameMajorFaults.store(frame.majorFaults, std::memory_order_relaxed);
+        return frame;
+    }
+
+    ResourceManager::FaultStats ResourceManager::GetFrameFaultsImpl() const {
+        return {m_FrameMinorFaults.load(std::memory_order_relaxed), m_FrameMajorFaults.load(std::memory_order_relaxed)};
+    }
+
+    bool ResourceManager::ReloadImpl(FileHandle handle) {
+        std::shared_ptr<const void> previous;
+        const bool reloaded = ReloadResource(handle, previous);
+
+        // A loose mapping follows its file, so the files sharing it would read the new contents
+        if (previous != nullptr)
+            DetachShared(previous);
+
+        return reloaded;
+    }
+
+    bool ResourceManager::ReloadResource(FileHandle handle, std::shared_ptr<const void>& previous) {
+        // The new contents may differ from the files sharing its mapping, which keep the old one. Done first since the
+        // table lock can't be taken with the resource locked.
+        {
+            std::unique_lock tableLock(m_Mutex);
+            Resource* resource = GetResource(handle);
+
+            if (resource != nullptr)
+                ForgetContentUnsafe(*resource, GetIndexFromHandle(handle));
+        }
+
+        // Waits until every guard of this resource has been released
+        std::unique_lock<std::shared_mutex> lock;
+        Resource* resource = LockResource(handle, lock);
+
+        if (resource == nullptr) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+            return false;
+        }
+
+        std::scoped_lock remapLock(resource->m_RemapMutex);
+
+        const bool shared = std::holds_alternative<SharedMapping>(resource->mmap);
+
+        if (std::holds_alternative<PackedRange>(resource->mmap) ||
+            (shared && std::get<SharedMapping>(resource->mmap).source.pack != nullptr)) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to reload a packed file: {0}", resource->path.string());
+            return false;
+        }
+
+        // The exclusive lock means no guard points into them anymore
+        resource->retired.clear();
+
+        if (!resource->evicted.load(std::memory_order_relaxed)) {
+            SyncUnsafe(*resource);
+            // A shared mapping only drops this file's reference, the others are detached from it once unlocked
+            if (shared && std::get<SharedMapping>(resource->mmap).owner.use_count() > 1)
+                previous = std::get<SharedMapping>(resource->mmap).owner;
+            Unmap(resource->mmap);
+            if (!shared)
+                m_ResidentBytes.fetch_sub(resource->size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        std::error_code error = MapLooseFile(
+            resource->path, resource->readOnly.load(std::memory_order_relaxed), resource->options, resource->mmap);
+
+        // Whatever happens the contents changed, so whoever derived data from them has to know
+        resource->version.fetch_add(1, std::memory_order_release);
+
+        if (error) {
+            // Left as if it was evicted, the next access maps it again
+            resource->evicted.store(true, std::memory_order_release);
+            AX_CORE_WARN(LogChannel::Resources,
+                         "Couldn't map the changed file {0} again: {1}",
+                         resource->path.string(),
+                         error.message());
+            return false;
+        }
+
+        const u64 size = MappedSize(resource->mmap);
+        resource->data.store(MappedData(resource->mmap), std::memory_order_release);
+        resource->size.store(size, std::memory_order_release);
+        resource->evicted.store(false, std::memory_order_release);
+        m_ResidentBytes.fetch_add(size, std::memory_order_relaxed);
+
+        AX_CORE_TRACE(LogChannel::Resources, "Reloaded file: {0}", resource->path.string());
+        return true;
+    }
+
+    Result<u32> ResourceManager::GetVersionImpl(FileHandle handle) const {
+        const Resource* resource = GetResource(handle);
+
+        if (resource != nullptr) {
+            const u32 version = resource->version.load(std::memory_order_acquire);
+
+            // The value is only meaningful if the slot wasn't reused while reading it
+            if (resource->handle.load(std::memory_order_acquire) == handle)
+                return version;
+        }
+
+        AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+        return Result<u32>::Err(
+            Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
+    }
+
+    Result<u64> ResourceManager::GetContentHashImpl(FileHandle handle) const {
+        const Resource* resource = GetResource(handle);
+
+        if (resource != nullptr) {
+            const u64 contentHash = resource->contentHash.load(std::memory_order_acquire);
+
+            // The value is only meaningful if the slot wasn't reused while reading it
+            if (resource->handle.load(std::memory_order_acquire) == handle)
+                return contentHash;
+        }
+
+        AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+        return Result<u64>::Err(
+            Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
+    }
+
+    bool ResourceManager::ShareIdentical(u64 contentHash, const char* data, u64 size, SharedMapping& shared) {
+        // Declared before the locks so the reference is released after them, releasing it may close the file
+        ManagedFileHandle candidate;
+
+        {
+            std::shared_lock lock(m_Mutex);
+
+            // Every file in the index is loaded, it's removed under the exclusive lock when closed
+            auto it = m_ContentIndex.find(contentHash);
+            if (it == m_ContentIndex.end())
+                return false;
+
+            Resource* resource = GetSlot(it->second);
+            resource->m_RefCount.fetch_add(1, std::memory_order_relaxed);
+            candidate = ManagedFileHandle(resource->handle.load(std::memory_order_relaxed));
+        }
+
+        // Comparing may fault the whole file in, so it's done without the table lock
+        std::shared_lock<std::shared_mutex> resourceLock;
+        Result<Resource*> locked = LockResidentResource(candidate.Get(), resourceLock);
+
+        if (locked.IsErr())
+            return false;
+
+        const Resource* resource = locked.Unwrap();
+
+        // Reloaded in the meantime, or mapped on its own again after being evicted
+        if (resource->contentHash.load(std::memory_order_relaxed) != contentHash ||
+            !std::holds_alternative<SharedMapping>(resource->mmap))
+            return false;
+
+        const SharedMapping& mapping = std::get<SharedMapping>(resource->mmap);
+
+        if (mapping.size != size || std::memcmp(mapping.data, data, size) != 0) {
+            AX_CORE_WARN(LogChannel::Resources, "Content hash collision with {0}", resource->path.string());
+            return false;
+        }
+
+        shared.owner = mapping.owner;
+        shared.data = mapping.data;
+        shared.size = mapping.size;
+        return true;
+    }
+
+    template <typename Mapping>
+    void ResourceManager::ShareMapping(Mapping& mmap, const PackedEntry& source) {
+        const u64 size = MappedSize(mmap);
+
+        m_ResidentBytes.fetch_add(size, std::memory_order_relaxed);
+
+        // The last file dropping it takes its bytes out, whichever it is
+        std::shared_ptr<const Mapping> owner(new Mapping(std::move(mmap)), [this, size](const Mapping* mapping) {
+            m_ResidentBytes.fetch_sub(size, std::memory_order_relaxed);
+            delete mapping;
+        });
+
+        SharedMapping shared;
+        shared.data = MappedData(*owner);
+        shared.size = size;
+        shared.source = source;
+        shared.owner = std::move(owner);
+        mmap = std::move(shared);
+    }
+
+    void ResourceManager::ForgetContentUnsafe(Resource& resource, u32 index) {
+        auto it = m_ContentIndex.find(resource.contentHash.load(std::memory_order_relaxed));
+        if (it != m_ContentIndex.end() && it->second == index)
+            m_ContentIndex.erase(it);
+
+        resource.contentHash.store(0, std::memory_order_release);
+    }
+
+    Result<FileHandle> ResourceManager::FindImpl(const std::filesystem::path& path) const {
+        // Normalizing touches the filesystem, so it's done before taking the lock
+        const std::string key = NormalizePath(path);
+
+        std::shared_lock lock(m_Mutex);
+        Result<FileHandle> handle = IsAlreadyOpenedUnsafe(key);
+
+        if (handle.IsErr())
+            return Result<FileHandle>::Err(Error(ErrorCode::NotFound, "The file is not loaded"));
+
+        return handle;
+    }
+
+    u64 ResourceManager::ResidentBytesUnsafe(const Resource& resource) {
+        if (resource.evicted.load(std::memory_order_relaxed))
+            return 0;
+
+        // Same order as the guards, a concurrent grow never pairs the new size with the old mapping
+        const u64 size = resource.size.load(std::memory_order_acquire);
+        return CountResidentBytes(resource.data.load(std::memory_order_acquire), size);
+    }
+
+    u64 ResourceManager::EvictUnsafe(Resource& resource) {
+        std::scoped_lock remapLock(resource.m_RemapMutex);
+        const u64 size = resource.size.load(std::memory_order_relaxed);
+
+        // The exclusive lock means no guard points into them anymore
+        resource.retired.clear();
+
+        // A shared mapping is only unmapped along with its last reference, which counts it out of the resident bytes
+        const bool shared = std::holds_alternative<SharedMapping>(resource.mmap);
+        const u64 freed = !shared || std::get<SharedMapping>(resource.mmap).owner.use_count() == 1 ? size : 0;
+
+        if (!std::holds_alternative<PackedRange>(resource.mmap)) {
+            SyncUnsafe(resource);
+            Unmap(resource.mmap);
+        } else {
+            PackedRange& range = std::get<PackedRange>(resource.mmap);
+
+            if (range.entry.compressed) {
+                range.buffer = BufferPool::Buffer();
+                range.data = nullptr;
+            } else if (!AdviseDontNeed(range.data, range.size)) {
+                // The pages stay resident but the asset is still perfectly usable
+                AX_CORE_WARN(LogChannel::Resources, "Failed to release the pages of: {0}", resource.path.string());
+            }
+        }
+
+        resource.evicted.store(true, std::memory_order_release);
+        resource.evictions.fetch_add(1, std::memory_order_relaxed);
 
-    ResourceManager::ResourceManager()
-        : m_Resources(std::make_unique<SparseSet<Resource>>()) {}
+        if (!shared)
+            m_ResidentBytes.fetch_sub(size, std::memory_order_relaxed);
+        m_Evictions.fetch_add(1, std::memory_order_relaxed);
+        m_EvictedBytes.fetch_add(freed, std::memory_order_relaxed);
 
-    ResourceManager::~ResourceManager() = default;
+        AX_CORE_TRACE(LogChannel::Resources, "Evicted file: {0}", resource.path.string());
+        return freed;
+    }
 
-    void ResourceManager::Init() {
-        if (s_Instance != nullptr) {
-            AX_CORE_WARN(LogChannel::Resources,
-                         "Init method of the Resource Manager has been called a second time. IGNORING");
-            return;
+    bool ResourceManager::RestoreUnsafe(Resource& resource) {
+        std::scoped_lock remapLock(resource.m_RemapMutex);
+        std::error_code error;
+
+        const bool shared = std::holds_alternative<SharedMapping>(resource.mmap);
+
+        if (shared) {
+            // The files it was shared with may have dropped it too, so it's mapped again on its own
+            error = MapSharedAgainUnsafe(resource);
+        } else if (!std::holds_alternative<PackedRange>(resource.mmap)) {
+            error = MapLooseFile(
+                resource.path, resource.readOnly.load(std::memory_order_relaxed), resource.options, resource.mmap);
+        } else {
+            PackedRange& range = std::get<PackedRange>(resource.mmap);
+
+            // Uncompressed assets are still mapped, their pages are simply faulted in again
+            if (range.entry.compressed) {
+                const PackedEntry entry = range.entry;
+
+                if (!MapPacked(entry, range))
+                    error = std::make_error_code(std::errc::illegal_byte_sequence);
+            }
         }
 
-        s_Instance = std::make_unique<ResourceManager>();
+        if (error) {
+            AX_CORE_ERROR(LogChannel::Resources,
+                          "Failed to map the evicted file {0} again: {1}",
+                          resource.path.string(),
+                          error.message());
+            return false;
+        }
 
-        AX_CORE_INFO(LogChannel::Resources, "Resource Manager initialized...");
+        // The file may have changed on disk while it was evicted
+        const u64 size = MappedSize(resource.mmap);
+        resource.data.store(MappedData(resource.mmap), std::memory_order_release);
+        resource.size.store(size, std::memory_order_release);
+        resource.evicted.store(false, std::memory_order_release);
+
+        if (!shared)
+            m_ResidentBytes.fetch_add(size, std::memory_order_relaxed);
+        m_Restores.fetch_add(1, std::memory_order_relaxed);
+
+        AX_CORE_TRACE(LogChannel::Resources, "Restored evicted file: {0}", resource.path.string());
+        return true;
     }
 
-    void ResourceManager::ShutDown() {
-        // Close all remaining files
-        const std::vector<size_t> AvailableFilesIdx = s_Instance->m_Resources->GetList();
-
-        for (u64 i = 0; i < AvailableFilesIdx.size(); ++i) {
-            auto got = s_Instance->m_Resources->Get(AvailableFilesIdx[i]);
-            if (got.IsOk()) {
-                Resource& resource = got.Unwrap().get();
-                FileHandle h = s_Instance->MakeHandle((u32) AvailableFilesIdx[i], resource.magic);
-
-                if (std::holds_alternative<mio::mmap_source>(resource.mmap))
-                    std::get<mio::mmap_source>(resource.mmap).unmap();
-                else {
-                    std::error_code error;
-                    mio::mmap_sink& mmap = std::get<mio::mmap_sink>(resource.mmap);
-                    mmap.sync(error);
-
-                    if (error) {
-                        AX_CORE_ERROR(LogChannel::Resources, "Error flushing a file to disk: {0}", error.message());
-                    }
-
-                    mmap.unmap();
-                }
+    std::error_code ResourceManager::MapSharedAgainUnsafe(Resource& resource) {
+        // Shared from then on with the files loaded after it
+        const PackedEntry source = std::get<SharedMapping>(resource.mmap).source;
+        std::error_code error;
 
-                AX_CORE_TRACE(LogChannel::Resources, "Closed file: {0}", resource.path.string());
-                s_Instance->m_Resources->Remove(AvailableFilesIdx[i]);
-            }
+        if (source.pack != nullptr) {
+            PackedRange range;
+            if (MapPacked(source, range))
+                resource.mmap = std::move(range);
+            else
+                error = std::make_error_code(std::errc::illegal_byte_sequence);
+        } else {
+            error = MapLooseFile(resource.path, true, resource.options, resource.mmap);
         }
 
-        s_Instance.reset();
-        AX_CORE_INFO(LogChannel::Resources, "Resource Manager deleted...");
+        if (!error)
+            ShareMapping(resource.mmap, source);
+
+        return error;
     }
 
-    Result<ResourceManager::ManagedFileHandle> ResourceManager::LoadImpl(const std::filesystem::path& path,
-                                                                         bool readOnly) {
-        if (!DoesFileExist(path)) {
-            AX_CORE_ERROR(LogChannel::Resources, "Trying to load a non-existing file: {0}", path.string());
-            return Result<ResourceManager::ManagedFileHandle>::Err(
-                Error(ErrorCode::NotFound, "Trying to load a non-existing file."));
+    void ResourceManager::DetachShared(const std::shared_ptr<const void>& owner) {
+        std::vector<FileHandle> handles;
+
+        // Slots are freed and reused without the table lock, every one is checked again once it's locked
+        const u32 count = m_LargestAvailableIndex.load(std::memory_order_acquire);
+
+        for (u32 index = 0; index < count; ++index) {
+            const Resource* resource = GetSlot(index);
+
+            // Claimed by a Load that didn't create its chunk yet
+            if (resource == nullptr)
+                continue;
+
+            const FileHandle h = resource->handle.load(std::memory_order_acquire);
+            if (h != INVALID_FILE_HANDLE)
+                handles.push_back(h);
         }
 
-        std::unique_lock lock(m_Mutex);
+        for (FileHandle h : handles) {
+            // Waits until every guard into the old contents has been released
+            std::unique_lock<std::shared_mutex> lock;
+            Resource* resource = LockResource(h, lock);
+
+            if (resource == nullptr || resource->evicted.load(std::memory_order_relaxed) ||
+                !std::holds_alternative<SharedMapping>(resource->mmap) ||
+                std::get<SharedMapping>(resource->mmap).owner != owner)
+                continue;
+
+            std::scoped_lock remapLock(resource->m_RemapMutex);
+            resource->retired.clear();
+
+            // Its own file still has the old contents, so its version stays the same
+            Unmap(resource->mmap);
+            const std::error_code error = MapSharedAgainUnsafe(*resource);
+
+            if (error) {
+                // Left as if it was evicted, the next access maps it again
+                resource->evicted.store(true, std::memory_order_release);
+                AX_CORE_WARN(LogChannel::Resources,
+                             "Couldn't map {0} on its own: {1}",
+                             resource->path.string(),
+                             error.message());
+                continue;
+            }
 
-        // File was already opened so return a valid handle to it
-        Result<FileHandle> e = IsAlreadyOpenedUnsafe(path);
-        if (e.IsOk()) {
-            FileHandle h = e.Unwrap();
-            m_Resources->Get(GetIndexFromHandle(h))
-                .Unwrap()
-                .get()
-                .m_RefCount.count.fetch_add(1, std::memory_order_relaxed);
-            return ResourceManager::ManagedFileHandle(h);
+            resource->data.store(MappedData(resource->mmap), std::memory_order_release);
+            resource->size.store(MappedSize(resource->mmap), std::memory_order_release);
+
+            AX_CORE_TRACE(LogChannel::Resources, "Stopped sharing a reloaded file: {0}", resource->path.string());
         }
+    }
 
-        if (std::filesystem::file_size(path) == 0) {
-            return Result<ResourceManager::ManagedFileHandle>::Err(
-                Error(ErrorCode::AssetLoadFailed, "Cannot map an empty file"));
+    bool ResourceManager::RestoreResource(FileHandle handle) {
+        const Resource* slot = GetResource(handle);
+
+        if (slot == nullptr)
+            return true;
+
+        MakeRoom(slot->size.load(std::memory_order_relaxed));
+
+        std::unique_lock<std::shared_mutex> lock;
+        Resource* resource = LockResource(handle, lock);
+
+        // Closed or already restored by another thread
+        if (resource == nullptr || !resource->evicted.load(std::memory_order_relaxed))
+            return true;
+
+        return RestoreUnsafe(*resource);
+    }
+
+    u64 ResourceManager::EvictLeastRecentlyUsed(u64 targetBytes, i64 idleBefore) {
+        struct Candidate {
+            i64 lastAccess;
+            FileHandle handle;
+        };
+
+        std::vector<Candidate> candidates;
+        u64 evicted = 0;
+
+        // Slots are freed and reused without the table lock, every candidate is checked again once it's locked
+        const u32 count = m_LargestAvailableIndex.load(std::memory_order_acquire);
+
+        for (u32 index = 0; index < count; ++index) {
+            const Resource* resource = GetSlot(index);
+
+            // Claimed by a Load that didn't create its chunk yet
+            if (resource == nullptr)
+                continue;
+
+            const FileHandle h = resource->handle.load(std::memory_order_acquire);
+            const i64 lastAccess = resource->lastAccess.load(std::memory_order_relaxed);
+
+            if (h != INVALID_FILE_HANDLE && !resource->evicted.load(std::memory_order_relaxed) &&
+                lastAccess <= idleBefore)
+                candidates.push_back({lastAccess, h});
         }
 
-        std::error_code error;
-        std::variant<mio::mmap_source, mio::mmap_sink> mmap;
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.lastAccess < b.lastAccess;
+        });
 
-        if (readOnly)
-            mmap = mio::make_mmap_source(path.string(), error);
-        else
-            mmap = mio::make_mmap_sink(path.string(), error);
+        for (const Candidate& candidate : candidates) {
+            if (m_ResidentBytes.load(std::memory_order_relaxed) <= targetBytes)
+                break;
 
+            Resource* resource = GetResource(candidate.handle);
+            if (resource == nullptr)
+                continue;
 
-        if (error) {
-            AX_CORE_ERROR(LogChannel::Resources, "There has been an error trying to read a file: {0}", error.message());
-            return Result<ResourceManager::ManagedFileHandle>::Err(Error(ErrorCode::AssetLoadFailed, error.message()));
+            // Resources with a guard held are in use, they're skipped instead of waited for
+            std::unique_lock resourceLock(resource->m_Mutex, std::try_to_lock);
+
+            if (!resourceLock.owns_lock() || resource->handle.load(std::memory_order_acquire) != candidate.handle ||
+                resource->evicted.load(std::memory_order_relaxed) ||
+                resource->lastAccess.load(std::memory_order_relaxed) > idleBefore)
+                continue;
+
+            evicted += EvictUnsafe(*resource);
         }
 
-        // File opened succesfully
-        u32 magic = m_MagicNumberCounter++;
-        u32 index;
-        if (m_AvailableIndexes.empty())
-            index = m_LargestAvailableIndex++;
-        else {
-            index = m_AvailableIndexes.top();
-            m_AvailableIndexes.pop();
-        }
-        FileHandle h = MakeHandle(index, magic);
-        m_Resources->Add(index,
-                         Resource{.mmap = std::move(mmap),
-                                  .path = path,
-                                  .magic = magic,
-                                  .m_Mutex = std::make_unique<std::shared_mutex>(),
-                                  .m_RefCount = {1}});
+        return evicted;
+    }
 
-        AX_CORE_TRACE(LogChannel::Resources, "Loaded file: {0}", path.string());
+    void ResourceManager::MakeRoom(u64 incoming) {
+        const u64 budget = m_ResidencyBudget.load(std::memory_order_relaxed);
 
-        return ResourceManager::ManagedFileHandle(h);
+        if (budget == 0 || m_ResidentBytes.load(std::memory_order_relaxed) + incoming <= budget)
+            return;
+
+        EvictLeastRecentlyUsed(budget > incoming ? budget - incoming : 0, Now());
     }
 
-    Result<FileHandle> ResourceManager::IsAlreadyOpenedUnsafe(const std::filesystem::path& path) const {
-        const std::vector<size_t> AvailableFilesIdx = m_Resources->GetList();
+    std::string ResourceManager::NormalizePath(const std::filesystem::path& path) {
+        std::error_code ec;
+        std::filesystem::path normalized = std::filesystem::weakly_canonical(path, ec);
 
-        for (u64 i = 0; i < AvailableFilesIdx.size(); ++i) {
-            auto got = m_Resources->Get(AvailableFilesIdx[i]);
-            if (got.IsOk() && got.Unwrap().get().path == path) {
-                // File has already been opened, return a valid handle to it
-                FileHandle h = MakeHandle((u32) AvailableFilesIdx[i], got.Unwrap().get().magic);
-                return h;
-            }
-        }
+        // Fall back to a purely lexical normalization if the filesystem could not resolve the path
+        if (ec)
+            normalized = std::filesystem::absolute(path, ec).lexically_normal();
+        if (ec)
+            normalized = path.lexically_normal();
 
-        return Result<FileHandle>::Err(Error(ErrorCode::Unknown, "File has not already been opened."));
+        return normalized.generic_string();
     }
 
     bool ResourceManager::CloseUnsafe(FileHandle handle) {
-        if (!IsHandleValidUnsafe(handle)) {
+        Resource* resource = GetResource(handle);
+
+        if (resource == nullptr) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to close a file with an invalid handle");
             return false;
         }
 
-        Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+        // From now on the handle is no longer valid. Every thread that may still hold it checks it again once the
+        // resource is locked, or with the remap mutex held.
+        resource->handle.store(INVALID_FILE_HANDLE, std::memory_order_release);
+        m_PathIndex.erase(resource->key);
+        ForgetContentUnsafe(*resource, GetIndexFromHandle(handle));
+
+        return true;
+    }
+
+    void ResourceManager::FinishClose(u32 index) {
+        Resource* resource = GetSlot(index);
+
+        // Waits until every guard of this resource has been released
+        std::unique_lock resourceLock(resource->m_Mutex);
+        std::unique_lock remapLock(resource->m_RemapMutex);
 
         // We sync changes to disk and then close the file
-        SyncUnsafe(handle);
+        SyncUnsafe(*resource);
 
-        if (std::holds_alternative<mio::mmap_source>(resource.mmap))
-            std::get<mio::mmap_source>(resource.mmap).unmap();
-        else
-            std::get<mio::mmap_sink>(resource.mmap).unmap();
+        Unmap(resource->mmap);
+        resource->retired.clear();
+        resource->dirty.ranges.clear();
 
-        AX_CORE_TRACE(LogChannel::Resources, "Closed file: {0}", resource.path.string());
-        m_Resources->Remove(GetIndexFromHandle(handle));
+        // Shared mappings take their bytes out when their last reference is dropped
+        const bool counted =
+            !resource->evicted.load(std::memory_order_relaxed) && !std::holds_alternative<SharedMapping>(resource->mmap);
+        if (counted)
+            m_ResidentBytes.fetch_sub(resource->size.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        resource->evicted.store(false, std::memory_order_relaxed);
 
-        // The index is now free
-        m_AvailableIndexes.push(GetIndexFromHandle(handle));
+        // The path is left in place, GetPath may still be reading it under the table lock. The next Load overwrites it.
+        AX_CORE_TRACE(LogChannel::Resources, "Closed file: {0}", resource->path.string());
 
-        return true;
+        // Handles of the next file living in this slot won't match the stale ones
+        ++resource->generation;
+
+        remapLock.unlock();
+        resourceLock.unlock();
+
+        // The index is now free
+        ReleaseSlot(index);
     }
 
     bool ResourceManager::SyncImpl(FileHandle handle) {
-        std::unique_lock lock(m_Mutex);
-        return SyncUnsafe(handle);
+        std::shared_lock<std::shared_mutex> lock;
+        Resource* resource = LockResource(handle, lock);
+
+        if (resource == nullptr) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a file with an invalid handle");
+            return false;
+        }
+
+        std::scoped_lock remapLock(resource->m_RemapMutex);
+        return SyncUnsafe(*resource);
     }
 
     bool ResourceManager::SyncImpl(const ResourceManager::ManagedFileHandle& handle) {
-        std::unique_lock lock(m_Mutex);
-        return SyncUnsafe(handle.Get());
+        return SyncImpl(handle.Get());
     }
 
-    bool ResourceManager::SyncUnsafe(FileHandle handle) {
-        if (!IsHandleValidUnsafe(handle)) {
-            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a file with an invalid handle");
+    bool ResourceManager::SyncAsyncImpl(const ResourceManager::ManagedFileHandle& handle) {
+        Result<bool> readOnly = IsReadOnly(handle.Get());
+
+        if (readOnly.IsErr() || readOnly.Unwrap())
             return false;
-        }
 
-        Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+        // The copy of the handle keeps the file open until the job is done
+        std::function<void()> job = [handle]() {
+            std::shared_lock<std::shared_mutex> lock;
+            Resource* resource = GetInstance().LockResource(handle.Get(), lock);
+
+            if (resource == nullptr)
+                return;
+
+            // An evicted file was synced when it was unmapped
+            std::scoped_lock remapLock(resource->m_RemapMutex);
+            if (!resource->evicted.load(std::memory_order_relaxed))
+                GetInstance().FlushDirtyUnsafe(*resource, true);
+        };
+
+        if (cw::JobSystem::IsInitialized())
+            CW_SCHEDULE(job, cw::JobPriority::Low, cw::InvalidThreadIndex, cw::InvalidTag, "Sync file");
+        else
+            job();
+
+        return true;
+    }
 
+    bool ResourceManager::SyncUnsafe(Resource& resource) {
         // If the holded map is read-only simply return
-        if (std::holds_alternative<mio::mmap_source>(resource.mmap))
+        if (!std::holds_alternative<mio::mmap_sink>(resource.mmap))
             return false;
 
-        std::error_code error;
-        std::get<mio::mmap_sink>(resource.mmap).sync(error);
+        // Changes were already synced when it was unmapped
+        if (resource.evicted.load(std::memory_order_relaxed))
+            return true;
 
-        if (error) {
-            AX_CORE_ERROR(LogChannel::Resources, "Error flushing a file to disk: {0}", error.message());
-            return false;
+        return FlushDirtyUnsafe(resource, false);
+    }
+
+    bool ResourceManager::FlushDirtyUnsafe(Resource& resource, bool async) {
+        mio::mmap_sink& map = std::get<mio::mmap_sink>(resource.mmap);
+        std::vector<std::pair<u64, u64>> ranges;
+
+        {
+            std::scoped_lock lock(resource.dirty.mutex);
+
+            // Asynchronous flushes leave the ranges in place so the next sync still waits for them
+            if (async)
+                ranges = resource.dirty.ranges;
+            else
+                ranges.swap(resource.dirty.ranges);
+        }
+
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            const u64 begin = std::min<u64>(ranges[i].first, map.size());
+            const u64 end = std::min<u64>(ranges[i].second, map.size());
+
+            if (begin < end && !FlushRange(map, begin, end - begin, async)) {
+                AX_CORE_ERROR(LogChannel::Resources, "Error flushing a file to disk: {0}", resource.path.string());
+
+                // Whatever wasn't flushed is still dirty
+                if (!async) {
+                    for (; i < ranges.size(); ++i)
+                        resource.dirty.Add(ranges[i].first, ranges[i].second);
+                }
+                return false;
+            }
         }
 
-        AX_CORE_TRACE(LogChannel::Resources, "Flushed changes to disk from file: {0}", resource.path.string());
+        AX_CORE_TRACE(LogChannel::Resources,
+                      "Flushed {0} dirty ranges to disk from file: {1}",
+                      ranges.size(),
+                      resource.path.string());
         return true;
     }
 
@@ -212,49 +1526,49 @@ namespace Axle {
     }
 
     Result<ResourceManager::WriteGuard> ResourceManager::DataImpl(FileHandle handle) {
-        std::unique_lock lock(m_Mutex);
+        std::unique_lock<std::shared_mutex> lock;
+        Result<Resource*> locked = LockResidentResource(handle, lock);
 
-        if (!IsHandleValidUnsafe(handle)) {
+        if (locked.IsErr()) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to access a file with an invalid handle");
-            return Result<ResourceManager::WriteGuard>::Err(
-                Error(ErrorCode::InvalidArgument, "Trying to access a file with an invalid handle"));
+            return Result<ResourceManager::WriteGuard>::Err(locked.UnwrapErr());
         }
 
-        Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+        Resource* resource = locked.Unwrap();
+        std::scoped_lock remapLock(resource->m_RemapMutex);
+
+        // The exclusive lock means no guard points into them anymore
+        resource->retired.clear();
 
-        if (std::holds_alternative<mio::mmap_source>(resource.mmap)) {
+        if (!std::holds_alternative<mio::mmap_sink>(resource->mmap)) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to get a mutable pointer to a read-only resource.");
             return Result<ResourceManager::WriteGuard>::Err(
                 Error(ErrorCode::InvalidArgument, "Trying to get a mutable pointer to a read-only resource"));
         }
 
-        mio::mmap_sink& map = std::get<mio::mmap_sink>(resource.mmap);
+        mio::mmap_sink& map = std::get<mio::mmap_sink>(resource->mmap);
 
-        return WriteGuard(map.data(), map.size(), *resource.m_Mutex);
+        return WriteGuard(map.data(), map.size(), &resource->dirty, std::move(lock));
     }
 
-    Result<ResourceManager::ReadGuard> ResourceManager::DataConstImpl(const ManagedFileHandle& handle) const {
+    Result<ResourceManager::ReadGuard> ResourceManager::DataConstImpl(const ManagedFileHandle& handle) {
         return DataConst(handle.Get());
     }
 
-    Result<ResourceManager::ReadGuard> ResourceManager::DataConstImpl(FileHandle handle) const {
-        std::shared_lock lock(m_Mutex);
+    Result<ResourceManager::ReadGuard> ResourceManager::DataConstImpl(FileHandle handle) {
+        std::shared_lock<std::shared_mutex> lock;
+        Result<Resource*> locked = LockResidentResource(handle, lock);
 
-        if (!IsHandleValidUnsafe(handle)) {
+        if (locked.IsErr()) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to access a file with an invalid handle");
-            return Result<ResourceManager::ReadGuard>::Err(
-                Error(ErrorCode::InvalidArgument, "Trying to access a file with an invalid handle"));
+            return Result<ResourceManager::ReadGuard>::Err(locked.UnwrapErr());
         }
 
-        const Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+        const Resource* resource = locked.Unwrap();
 
-        if (std::holds_alternative<mio::mmap_source>(resource.mmap)) {
-            const mio::mmap_source& map = std::get<mio::mmap_source>(resource.mmap);
-            return ReadGuard(map.data(), map.size(), *resource.m_Mutex);
-        } else {
-            const mio::mmap_sink& map = std::get<mio::mmap_sink>(resource.mmap);
-            return ReadGuard(map.data(), map.size(), *resource.m_Mutex);
-        }
+        // A growing resize may be swapping the mapping right now, see Resource::data
+        const u64 size = resource->size.load(std::memory_order_acquire);
+        return ReadGuard(resource->data.load(std::memory_order_acquire), size, std::move(lock));
     }
 
     Result<u64> ResourceManager::SizeImpl(const ResourceManager::ManagedFileHandle& handle) const {
@@ -262,20 +1576,18 @@ namespace Axle {
     }
 
     Result<u64> ResourceManager::SizeImpl(FileHandle handle) const {
-        std::shared_lock lock(m_Mutex);
+        const Resource* resource = GetResource(handle);
 
-        if (!IsHandleValidUnsafe(handle)) {
-            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
-            return Result<u64>::Err(
-                Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
-        }
+        if (resource != nullptr) {
+            u64 size = resource->size.load(std::memory_order_acquire);
 
-        const Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+            // The value is only meaningful if the slot wasn't reused while reading it
+            if (resource->handle.load(std::memory_order_acquire) == handle)
+                return size;
+        }
 
-        if (std::holds_alternative<mio::mmap_source>(resource.mmap))
-            return std::get<mio::mmap_source>(resource.mmap).size();
-        else
-            return std::get<mio::mmap_sink>(resource.mmap).size();
+        AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+        return Result<u64>::Err(Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
     }
 
     bool ResourceManager::CreateImpl(const std::filesystem::path& path, u64 size) {
@@ -312,17 +1624,19 @@ namespace Axle {
     }
 
     Result<bool> ResourceManager::IsReadOnlyImpl(FileHandle handle) const {
-        std::shared_lock lock(m_Mutex);
+        const Resource* resource = GetResource(handle);
 
-        if (!IsHandleValidUnsafe(handle)) {
-            AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
-            return Result<bool>::Err(
-                Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
-        }
+        if (resource != nullptr) {
+            bool readOnly = resource->readOnly.load(std::memory_order_acquire);
 
-        const Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+            // The value is only meaningful if the slot wasn't reused while reading it
+            if (resource->handle.load(std::memory_order_acquire) == handle)
+                return readOnly;
+        }
 
-        return std::holds_alternative<mio::mmap_source>(resource.mmap);
+        AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
+        return Result<bool>::Err(
+            Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
     }
 
     Result<std::filesystem::path> ResourceManager::GetPathImpl(const ResourceManager::ManagedFileHandle& handle) const {
@@ -330,18 +1644,64 @@ namespace Axle {
     }
 
     Result<std::filesystem::path> ResourceManager::GetPathImpl(FileHandle handle) const {
+        // The path is only written while loading or closing, both of which hold the table exclusively
         std::shared_lock lock(m_Mutex);
 
-        if (!IsHandleValidUnsafe(handle)) {
+        const Resource* resource = GetResource(handle);
+
+        if (resource == nullptr) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
             return Result<std::filesystem::path>::Err(
                 Error(ErrorCode::InvalidArgument, "Trying to access a resource with an invalid handle"));
         }
 
-        const Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
-        return resource.path;
+        return resource->path;
+    }
+
+    void ResourceManager::WriteGuard::MarkDirty(u64 offset, u64 length) {
+        if (m_Dirty == nullptr || offset >= m_Size || length == 0)
+            return;
+
+        const u64 pageSize = PageSize();
+        const u64 end = std::min(m_Size - offset, length) + offset;
+
+        m_Dirty->Add(offset & ~(pageSize - 1), (end + pageSize - 1) & ~(pageSize - 1));
+        m_Marked = true;
+    }
+
+    ResourceManager::WriteGuard::~WriteGuard() {
+        // Nothing was marked, so anything may have been written
+        if (m_Dirty != nullptr && !m_Marked)
+            MarkDirty(0, m_Size);
+    }
+
+#ifdef AXLE_TESTING
+    std::vector<std::pair<u64, u64>> ResourceManager::DirtyPagesImpl(FileHandle handle) {
+        Resource* resource = GetResource(handle);
+
+        if (resource == nullptr)
+            return {};
+
+        std::scoped_lock lock(resource->dirty.mutex);
+        return resource->dirty.ranges;
+    }
+
+    std::vector<u32> ResourceManager::AvailableIndexesImpl() const {
+        std::vector<u32> indexes;
+
+        for (u32 top = static_cast<u32>(m_FreeSlots.load(std::memory_order_acquire)); top != 0;
+             top = GetSlot(top - 1)->nextFree.load(std::memory_order_relaxed))
+            indexes.push_back(top - 1);
+
+        return indexes;
     }
 
+    u32 ResourceManager::SlotGenerationImpl(u32 index) const {
+        const Resource* resource = GetSlot(index);
+        return resource == nullptr ? 0 : resource->generation;
+    }
+#endif // AXLE_TESTING
+
     void ResourceManager::ManagedFileHandle::AddRef() {
         if (IsValid() && ResourceManager::s_Instance != nullptr)
             ResourceManager::GetInstance().AddRef(m_Handle);
@@ -353,63 +1713,63 @@ namespace Axle {
     }
 
     bool ResourceManager::AddRef(FileHandle handle) {
-        std::shared_lock lock(m_Mutex);
+        // The caller already owns a reference so the resource can't be closed under our feet
+        Resource* resource = GetResource(handle);
 
-        if (!IsHandleValidUnsafe(handle)) {
+        if (resource == nullptr) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
             return false;
         }
 
-        m_Resources->Get(GetIndexFromHandle(handle))
-            .Unwrap()
-            .get()
-            .m_RefCount.count.fetch_add(1, std::memory_order_relaxed);
+        resource->m_RefCount.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
     bool ResourceManager::ReleaseRef(FileHandle handle) {
         {
-            std::shared_lock lock(m_Mutex);
+            Resource* r = GetResource(handle);
 
-            if (!IsHandleValidUnsafe(handle)) {
+            if (r == nullptr) {
                 AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
                 return false;
             }
 
-            Resource& r = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
-
             // If we're not the last one, just decrement and return
-            u32 current = r.m_RefCount.count.load(std::memory_order_relaxed);
+            u32 current = r->m_RefCount.load(std::memory_order_relaxed);
             while (current > 1) {
-                if (r.m_RefCount.count.compare_exchange_weak(
+                if (r->m_RefCount.compare_exchange_weak(
                         current, current - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
                     return true; // Successfully decremented from >1 to >0 safely!
             }
             // Count is 1 — fall through without decrementing to close under unique lock
         }
 
-        // Re-acquire as unique lock to close
-        std::unique_lock releaseLock(m_Mutex);
-
-        // Re-check: someone may have rescued the file between the two locks
-        if (!IsHandleValidUnsafe(handle))
-            return true; // already closed by someone else
-
-        Resource& rechecked = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
+        {
+            // Re-acquire as unique lock to close
+            std::unique_lock releaseLock(m_Mutex);
+
+            // Re-check: someone may have rescued the file between the two locks
+            Resource* rechecked = GetResource(handle);
+            if (rechecked == nullptr)
+                return true; // already closed by someone else
+
+            // Perform the final decrement entirely under the safety of the unique lock
+            if (rechecked->m_RefCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                // Someone called Load() in the lock gap and rescued the file (count is > 0 again),
+                // or another thread beat us to the unique lock and closed it. Do nothing.
+                return true;
+            }
 
-        // Perform the final decrement entirely under the safety of the unique lock
-        if (rechecked.m_RefCount.count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             // The count successfully went from 1 to 0 under exclusive ownership
-            std::string path = rechecked.path.string();
             if (!CloseUnsafe(handle)) {
-                AX_CORE_ERROR(LogChannel::Resources, "There was an error closing the file: {0}", path);
+                AX_CORE_ERROR(
+                    LogChannel::Resources, "There was an error closing the file: {0}", rechecked->path.string());
                 return false;
             }
-        } else {
-            // Someone called Load() in the lock gap and rescued the file (count is > 0 again),
-            // or another thread beat us to the unique lock and closed it. Do nothing.
         }
 
+        // Nobody can find the file anymore, waiting for its guards and flushing it doesn't need the table
+        FinishClose(GetIndexFromHandle(handle));
         return true;
     }
 
@@ -418,53 +1778,75 @@ namespace Axle {
     }
 
     bool ResourceManager::ResizeImpl(FileHandle handle, u64 newSize) {
-        std::unique_lock lock(m_Mutex);
+        // Growing keeps every byte a guard can see valid, so it's done without waiting for them
+        if (Resource* slot = GetResource(handle); slot != nullptr) {
+            std::unique_lock remapLock(slot->m_RemapMutex);
+
+            // Checked with the lock held, closing or evicting the file takes it too
+            if (slot->handle.load(std::memory_order_acquire) == handle &&
+                !slot->evicted.load(std::memory_order_relaxed) && !std::holds_alternative<PackedRange>(slot->mmap) &&
+                !std::holds_alternative<SharedMapping>(slot->mmap) &&
+                newSize >= slot->size.load(std::memory_order_relaxed))
+                return GrowUnsafe(*slot, newSize);
+        }
 
-        if (!IsHandleValidUnsafe(handle)) {
+        // Shrinking would pull pages out from under the guards, so we lock the resource mutex to prevent
+        // reading/writing threads to access its contents while we resize it. The table itself is untouched: the path,
+        // index and handle stay the same.
+        std::unique_lock<std::shared_mutex> lockResources;
+        Result<Resource*> locked = LockResidentResource(handle, lockResources);
+
+        if (locked.IsErr()) {
             AX_CORE_ERROR(LogChannel::Resources, "Trying to access a resource with an invalid handle");
             return false;
         }
 
-        // We can't use the Close method because we want to appear as if the file was never closed
-        SyncUnsafe(handle);
+        Resource* resource = locked.Unwrap();
+        std::unique_lock remapLock(resource->m_RemapMutex);
+
+        // Packed files live inside the pack, they can't grow
+        if (std::holds_alternative<PackedRange>(resource->mmap)) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to resize a packed file: {0}", resource->path.string());
+            return false;
+        }
 
-        Resource& resource = m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get();
-        bool IsReadOnly = std::holds_alternative<mio::mmap_source>(resource.mmap);
+        // Other files read the same mapping
+        if (std::holds_alternative<SharedMapping>(resource->mmap)) {
+            AX_CORE_ERROR(LogChannel::Resources, "Trying to resize a shared file: {0}", resource->path.string());
+            return false;
+        }
 
-        // We lock the resource mutex to prevent reading/writing threads to access its contents while we resize it
-        std::unique_lock lockResources(*resource.m_Mutex);
+        // We can't use the Close method because we want to appear as if the file was never closed
+        SyncUnsafe(*resource);
 
-        // We unmap the file
-        if (IsReadOnly)
-            std::get<mio::mmap_source>(resource.mmap).unmap();
-        else
-            std::get<mio::mmap_sink>(resource.mmap).unmap();
+        bool IsReadOnly = resource->readOnly.load(std::memory_order_relaxed);
 
+        // We unmap the file, along with the mappings retired by earlier growths
+        Unmap(resource->mmap);
+        resource->retired.clear();
 
         // Resize the file
         std::error_code ec;
-        std::filesystem::resize_file(resource.path, newSize, ec);
+        std::filesystem::resize_file(resource->path, newSize, ec);
 
         if (ec) {
             AX_CORE_ERROR(LogChannel::Resources,
                           "Failed to resize file {0}: {1}. Attempting rollback.",
-                          resource.path.string(),
+                          resource->path.string(),
                           ec.message());
 
             // ROLLBACK: Re-map the file using the old size so it isn't left dead
-            std::error_code rollbackError;
-            if (IsReadOnly)
-                resource.mmap = mio::make_mmap_source(resource.path.string(), rollbackError);
-            else
-                resource.mmap = mio::make_mmap_sink(resource.path.string(), rollbackError);
+            std::error_code rollbackError =
+                MapLooseFile(resource->path, IsReadOnly, resource->options, resource->mmap);
 
             if (rollbackError) {
                 // Fatal error: We couldn't even map it back. The handle MUST be invalidated.
                 AX_CORE_CRITICAL(
-                    LogChannel::Resources, "Rollback failed for {0}. File is unmapped.", resource.path.string());
+                    LogChannel::Resources, "Rollback failed for {0}. File is unmapped.", resource->path.string());
 
                 // FIX: Add a boolean that tells if a resource is poisoned or not if we can't rollback
                 // We try to close the file here to prevent segfaults
+                remapLock.unlock();
                 lockResources.unlock();
                 AX_PANIC(LogChannel::Resources, "Failed to re-map file after failing to resize.");
             }
@@ -473,33 +1855,197 @@ namespace Axle {
         }
 
         // Re-map the updated file
-        std::error_code error;
-
-        if (IsReadOnly)
-            resource.mmap = mio::make_mmap_source(resource.path.string(), error);
-        else
-            resource.mmap = mio::make_mmap_sink(resource.path.string(), error);
+        std::error_code error = MapLooseFile(resource->path, IsReadOnly, resource->options, resource->mmap);
 
         if (error) {
             AX_CORE_ERROR(LogChannel::Resources,
                           "Failed to resize the file: {0} with error: {1}",
-                          resource.path.string(),
+                          resource->path.string(),
                           error.message());
 
             // FIX: Add a boolean that tells if a resource is poisoned or not if we can't rollback
             // The file was resized but remapping failed. It must be destroyed.
+            remapLock.unlock();
             lockResources.unlock();
             AX_PANIC(LogChannel::Resources, "Failed to re-map file after resize.");
             return false;
         }
 
-        AX_CORE_TRACE(LogChannel::Resources, "File: {0} was resized to: {1} bytes", resource.path.string(), newSize);
+        resource->data.store(MappedData(resource->mmap), std::memory_order_release);
+        const u64 oldSize = resource->size.exchange(MappedSize(resource->mmap), std::memory_order_acq_rel);
+        m_ResidentBytes.fetch_add(MappedSize(resource->mmap) - oldSize, std::memory_order_relaxed);
+
+        AX_CORE_TRACE(LogChannel::Resources, "File: {0} was resized to: {1} bytes", resource->path.string(), newSize);
+        return true;
+    }
+
+    bool ResourceManager::GrowUnsafe(Resource& resource, u64 newSize) {
+        const u64 oldSize = resource.size.load(std::memory_order_relaxed);
+
+        // Growing the file first leaves the current mapping valid, guards keep reading it while the new one is built
+        std::error_code ec;
+        std::filesystem::resize_file(resource.path, newSize, ec);
+
+        if (ec) {
+            AX_CORE_ERROR(
+                LogChannel::Resources, "Failed to resize file {0}: {1}", resource.path.string(), ec.message());
+            return false;
+        }
+
+        decltype(resource.mmap) mmap;
+        std::error_code error =
+            MapLooseFile(resource.path, resource.readOnly.load(std::memory_order_relaxed), resource.options, mmap);
+
+        if (error) {
+            // Nobody saw the new size yet, so the file can be put back as it was
+            std::filesystem::resize_file(resource.path, oldSize, ec);
+
+            AX_CORE_ERROR(LogChannel::Resources,
+                          "Failed to resize the file: {0} with error: {1}",
+                          resource.path.string(),
+                          error.message());
+            return false;
+        }
+
+        // MAP_SHARED mappings of the same file see the same pages, writes through a guard of the retired mapping still
+        // land in the file
+        resource.retired.push_back(std::move(resource.mmap));
+        resource.mmap = std::move(mmap);
+
+        const u64 size = MappedSize(resource.mmap);
+        resource.data.store(MappedData(resource.mmap), std::memory_order_release);
+        resource.size.store(size, std::memory_order_release);
+        m_ResidentBytes.fetch_add(size - oldSize, std::memory_order_relaxed);
+
+        AX_CORE_TRACE(LogChannel::Resources, "File: {0} was grown to: {1} bytes", resource.path.string(), newSize);
         return true;
     }
 
-    bool ResourceManager::IsHandleValidUnsafe(FileHandle handle) const {
-        return handle != INVALID_FILE_HANDLE && m_Resources->Has(GetIndexFromHandle(handle)) &&
-               m_Resources->Get(GetIndexFromHandle(handle)).Unwrap().get().magic == GetMagicFromHandle(handle);
+    template <typename Lock>
+    ResourceManager::Resource* ResourceManager::LockResource(FileHandle handle, Lock& lock) const {
+        Resource* resource = GetResource(handle);
+
+        if (resource == nullptr)
+            return nullptr;
+
+        lock = Lock(resource->m_Mutex);
+
+        // The file may have been closed while we were waiting for the lock
+        if (resource->handle.load(std::memory_order_acquire) != handle) {
+            lock.unlock();
+            return nullptr;
+        }
+
+        return resource;
+    }
+
+    template <typename Lock>
+    Result<ResourceManager::Resource*> ResourceManager::LockResidentResource(FileHandle handle, Lock& lock) {
+        while (true) {
+            Resource* resource = LockResource(handle, lock);
+
+            if (resource == nullptr) {
+                return Result<Resource*>::Err(
+                    Error(ErrorCode::InvalidArgument, "Trying to access a file with an invalid handle"));
+            }
+
+            resource->lastAccess.store(Now(), std::memory_order_relaxed);
+
+            if (!resource->evicted.load(std::memory_order_relaxed))
+                return resource;
+
+            // Mapping it again needs the exclusive lock and may evict other resources, so nothing can be held. Another
+            // thread could evict it again before it's locked, hence the loop.
+            lock.unlock();
+
+            if (!RestoreResource(handle)) {
+                return Result<Resource*>::Err(
+                    Error(ErrorCode::AssetLoadFailed, "Failed to map an evicted file again"));
+            }
+        }
+    }
+
+    ResourceManager::Resource* ResourceManager::GetResource(FileHandle handle) const {
+        if (handle == INVALID_FILE_HANDLE)
+            return nullptr;
+
+        Resource* resource = GetSlot(GetIndexFromHandle(handle));
+
+        if (resource == nullptr || resource->handle.load(std::memory_order_acquire) != handle)
+            return nullptr;
+
+        return resource;
+    }
+
+    ResourceManager::Resource* ResourceManager::GetSlot(u32 index) const {
+        const u32 chunk = index >> SlotChunkShift;
+
+        if (chunk >= MaxSlotChunks)
+            return nullptr;
+
+        Resource* slots = m_Chunks[chunk].load(std::memory_order_acquire);
+        return slots == nullptr ? nullptr : &slots[index & (SlotChunkSize - 1)];
+    }
+
+    Result<u32> ResourceManager::AcquireSlot() {
+        u64 head = m_FreeSlots.load(std::memory_order_acquire);
+
+        while (static_cast<u32>(head) != 0) {
+            const u32 index = static_cast<u32>(head) - 1;
+            const u32 next = GetSlot(index)->nextFree.load(std::memory_order_relaxed);
+
+            // The tag changes with every pop and push, so if the slot was taken and given back in between, making the
+            // read next stale, the exchange fails
+            const u64 popped = (((head >> 32) + 1) << 32) | next;
+            if (m_FreeSlots.compare_exchange_weak(head, popped, std::memory_order_acquire, std::memory_order_acquire))
+                return index;
+        }
+
+        // Nothing to reuse, a slot that was never used is handed out
+        u32 index = m_LargestAvailableIndex.load(std::memory_order_relaxed);
+        do {
+            if (index >= MaxSlotChunks * SlotChunkSize)
+                return Result<u32>::Err(Error(ErrorCode::OutOfMemory, "The resource table is full"));
+        } while (!m_LargestAvailableIndex.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+
+        GetOrCreateSlot(index);
+        return index;
+    }
+
+    void ResourceManager::ReleaseSlot(u32 index) {
+        Resource* resource = GetSlot(index);
+        u64 head = m_FreeSlots.load(std::memory_order_relaxed);
+        u64 pushed;
+
+        do {
+            resource->nextFree.store(static_cast<u32>(head), std::memory_order_relaxed);
+            pushed = (((head >> 32) + 1) << 32) | (index + 1);
+        } while (
+            !m_FreeSlots.compare_exchange_weak(head, pushed, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    ResourceManager::Resource* ResourceManager::GetOrCreateSlot(u32 index) {
+        const u32 chunk = index >> SlotChunkShift;
+
+        if (chunk >= MaxSlotChunks)
+            return nullptr;
+
+        Resource* slots = m_Chunks[chunk].load(std::memory_order_acquire);
+
+        if (slots == nullptr) {
+            // Threads claiming slots of the same new chunk race to create it, the losers drop theirs
+            Resource* created = new Resource[SlotChunkSize];
+
+            if (m_Chunks[chunk].compare_exchange_strong(
+                    slots, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                slots = created;
+                AX_CORE_TRACE(LogChannel::Resources, "Resource table grew to {0} slots", (chunk + 1) * SlotChunkSize);
+            } else {
+                delete[] created;
+            }
+        }
+
+        return &slots[index & (SlotChunkSize - 1)];
     }
 
 } // namespace Axle
@@ -5,10 +5,18 @@
 #include "Core/Error/Result.hpp"
 #include "Core/Core.hpp"
 #include "Core/Types.hpp"
-#include "Other/CustomTypes/SparseSet.hpp"
+#include "BufferPool.hpp"
+
+namespace cw {
+    template <typename T>
+    class JobCoroutine;
+} // namespace cw
 
 namespace Axle {
     class AXLE_TEST_API ResourceManager {
+        /// Byte ranges written through WriteGuards that haven't been synced yet
+        struct DirtyRanges;
+
     public:
         // Helper classes
         // --------------
@@ -50,10 +58,10 @@ namespace Axle {
         private:
             friend class ResourceManager;
 
-            ReadGuard(const char* ptr, u64 size, std::shared_mutex& mutex)
+            ReadGuard(const char* ptr, u64 size, std::shared_lock<std::shared_mutex> lock)
                 : m_Ptr(ptr),
                   m_Size(size),
-                  m_Lock(mutex) {}
+                  m_Lock(std::move(lock)) {}
 
             const char* m_Ptr;
             u64 m_Size;
@@ -89,21 +97,41 @@ namespace Axle {
                 return m_Size;
             }
 
+            /**
+             * Records that a range of the data was written, so syncing only flushes the pages it spans. If it's never
+             * called the whole file is considered written once the guard is released.
+             *
+             * @param offset Offset in bytes of the written range
+             * @param length Length in bytes of the written range
+             * */
+            void MarkDirty(u64 offset, u64 length);
+
+            ~WriteGuard();
+
             // Non-copyable, moveable
             WriteGuard(const WriteGuard&) = delete;
             WriteGuard& operator=(const WriteGuard&) = delete;
-            WriteGuard(WriteGuard&&) = default;
+            WriteGuard(WriteGuard&& other) noexcept
+                : m_Ptr(other.m_Ptr),
+                  m_Size(other.m_Size),
+                  m_Dirty(std::exchange(other.m_Dirty, nullptr)),
+                  m_Marked(other.m_Marked),
+                  m_Lock(std::move(other.m_Lock)) {}
 
         private:
             friend class ResourceManager;
 
-            WriteGuard(char* ptr, u64 size, std::shared_mutex& mutex)
+            WriteGuard(char* ptr, u64 size, DirtyRanges* dirty, std::unique_lock<std::shared_mutex> lock)
                 : m_Ptr(ptr),
                   m_Size(size),
-                  m_Lock(mutex) {}
+                  m_Dirty(dirty),
+                  m_Lock(std::move(lock)) {}
 
             char* m_Ptr;
             u64 m_Size;
+            /// Where the written ranges are recorded, nullptr once moved from
+            DirtyRanges* m_Dirty;
+            bool m_Marked = false;
             std::unique_lock<std::shared_mutex> m_Lock;
         };
 
@@ -176,6 +204,122 @@ namespace Axle {
 
             FileHandle m_Handle = INVALID_FILE_HANDLE;
         };
+
+        /**
+         * Counters of the residency budget, see SetResidencyBudget
+         * */
+        struct ResidencyStats {
+            /// The current budget in bytes, 0 if there's none
+            u64 budget = 0;
+            /// Bytes of the loaded files that are currently mapped (or decompressed)
+            u64 residentBytes = 0;
+            /// Amount of times a mapping was dropped
+            u64 evictions = 0;
+            /// Bytes dropped by those evictions
+            u64 evictedBytes = 0;
+            /// Amount of times an evicted file was mapped again because it was accessed
+            u64 restores = 0;
+        };
+
+        /**
+         * Residency of a single file
+         * */
+        struct ResidencyInfo {
+            /// false while the mapping is dropped, the next guard maps it again
+            bool resident = true;
+            /// When a guard was last taken on the file, or when it was loaded
+            std::chrono::steady_clock::time_point lastAccess;
+            /// Amount of times the file was evicted since it was loaded
+            u32 evictions = 0;
+        };
+
+        /**
+         * What a loaded file takes in memory, see GetMappedFiles
+         * */
+        struct MappedFileInfo {
+            FileHandle handle = INVALID_FILE_HANDLE;
+            std::filesystem::path path;
+            /// Size of the mapping (or the decompressed buffer), 0 while evicted
+            u64 mappedBytes = 0;
+            /// Part of the mapping whose pages are in memory, touching them doesn't read from disk
+            u64 residentBytes = 0;
+        };
+
+        /**
+         * Page faults taken by a thread between two calls to SampleFrameFaults
+         * */
+        struct FaultStats {
+            /// Served without I/O, e.g. from the page cache or a zero page
+            u64 minorFaults = 0;
+            /// Had to wait for the disk
+            u64 majorFaults = 0;
+        };
+
+        /**
+         * Kinds of assets with their own default LoadOptions, see LoadOptions::For
+         * */
+        enum class AssetType : u8 { Generic, Texture, Shader, Blob };
+
+        /**
+         * How a file is brought into memory. None of the options changes what the guards see, only when the pages are
+         * read and what kind of memory backs them.
+         * */
+        struct LoadOptions {
+            /// How the data is going to be read, the kernel tunes its readahead with it
+            enum class Access : u8 { Normal, Sequential, Random };
+
+            /// Faults every page in while loading so later accesses (e.g. from the render thread) never page-fault.
+            /// Same effect as mapping with MAP_POPULATE.
+            bool prefault = false;
+            Access access = Access::Normal;
+            /// Asks for transparent huge pages, only worth it for very large blobs. Whether file mappings get them
+            /// depends on the kernel (CONFIG_READ_ONLY_THP_FOR_FS).
+            bool hugePages = false;
+            /// Read-only files up to this size are copied into a pooled heap buffer instead of being mapped, which
+            /// skips the mapping setup and its page faults. 0 disables it.
+            u64 heapCopyMaxSize = 0;
+            /// Hashes the contents (XXH64) so byte-identical files, even under different paths or some loose and some
+            /// packed, share a single mapping, see GetContentHash. Each file keeps its own handle, so reloading one of
+            /// them doesn't touch the others, when the file the mapping comes from is reloaded the others map their own
+            /// file again. Only read-only files are shared. Hashing reads the whole file unless it's packed, packs
+            /// store the hash of every asset.
+            bool deduplicate = false;
+
+            /**
+             * Gets the default options of an asset type.
+             *
+             * @param type The type of the asset
+             *
+             * @returns The options
+             * */
+            static LoadOptions For(AssetType type) {
+                LoadOptions options;
+
+                switch (type) {
+                case AssetType::Texture:
+                    // Decoded front to back right after being loaded, so hashing them costs no extra faults
+                    options.prefault = true;
+                    options.access = Access::Sequential;
+                    options.deduplicate = true;
+                    break;
+                case AssetType::Shader:
+                    // Small and parsed once
+                    options.heapCopyMaxSize = u64(64) << 10;
+                    options.prefault = true;
+                    options.deduplicate = true;
+                    break;
+                case AssetType::Blob:
+                    // Large and read sparsely
+                    options.access = Access::Random;
+                    options.hugePages = true;
+                    break;
+                case AssetType::Generic:
+                    break;
+                }
+
+                return options;
+            }
+        };
         // --------------
 
         ResourceManager(const ResourceManager&) = delete;
@@ -211,12 +355,85 @@ namespace Axle {
          * @returns A handle to the loaded file.
          * */
         inline static Result<ManagedFileHandle> Load(const std::filesystem::path& path, bool readOnly = true) {
-            return s_Instance->LoadImpl(path, readOnly);
+            return s_Instance->LoadImpl(path, readOnly, LoadOptions());
+        }
+
+        /**
+         * Loads the given file into memory the way the options ask for and returns a handle to it. If the file is
+         * already loaded the existing handle is returned and the options are ignored.
+         *
+         * The options are applied again when an evicted file is mapped again. Packed files only use the hints, and
+         * compressed ones none of them since they're decompressed into the heap anyway.
+         *
+         * This method is thread safe.
+         *
+         * @param path A filesystem path to the file to be loaded
+         * @param options How the file is brought into memory, e.g. LoadOptions::For(AssetType::Texture)
+         * @param readOnly Defines if the loaded file can be modified or not. Writable files are never copied into the
+         * heap
+         *
+         * @returns A handle to the loaded file.
+         * */
+        inline static Result<ManagedFileHandle>
+        Load(const std::filesystem::path& path, const LoadOptions& options, bool readOnly = true) {
+            return s_Instance->LoadImpl(path, readOnly, options);
+        }
+
+        /**
+         * Loads the given file on a job system worker and asks the kernel to start reading it in the background, so
+         * the first access to the data doesn't page-fault the whole file in on the calling thread.
+         *
+         * The returned coroutine is lazy, it has to be awaited (e.g. co_await cw::WhenAll(LoadAsync(path))) or
+         * scheduled to run. Using it requires including CoroWeaver.
+         *
+         * This method is thread safe.
+         *
+         * @param path A filesystem path to the file to be loaded
+         * @param readOnly Defines if the loaded file can be modified or not
+         * @param preTouch If true every page is read once before returning, so the data is fully resident when the
+         * coroutine completes
+         *
+         * @returns A coroutine that yields the handle to the loaded file
+         * */
+        static cw::JobCoroutine<Result<ManagedFileHandle>> LoadAsync(std::filesystem::path path,
+                                                                     bool readOnly = true,
+                                                                     bool preTouch = false);
+
+        /**
+         * Same as LoadAsync but for a list of files. All the files are mapped and hinted before any page is touched so
+         * their reads overlap instead of being done one after the other.
+         *
+         * This method is thread safe.
+         *
+         * @param paths The filesystem paths of the files to be loaded
+         * @param readOnly Defines if the loaded files can be modified or not
+         * @param preTouch If true every page of every file is read once before returning
+         *
+         * @returns A coroutine that yields one result per path, in the same order
+         * */
+        static cw::JobCoroutine<std::vector<Result<ManagedFileHandle>>>
+        LoadBatchAsync(std::vector<std::filesystem::path> paths, bool readOnly = true, bool preTouch = false);
+
+        /**
+         * Hints the kernel that the whole file is going to be needed soon so it starts reading it in the background.
+         * Optionally reads every page once, which blocks until the file is resident.
+         *
+         * This method is thread safe. Touching the pages holds a ReadGuard on the resource.
+         *
+         * @param handle The ManagedFileHandle associated with the file
+         * @param preTouch If true every page is read once before returning
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        inline static bool Prefetch(const ManagedFileHandle& handle, bool preTouch = false) {
+            return s_Instance->PrefetchImpl(handle.Get(), true, preTouch);
         }
 
         /**
          * Syncs current changes made to the map to disk. Flushing changes of a read-only file does nothing.
          *
+         * Only the pages written through WriteGuards since the last sync are flushed, see WriteGuard::MarkDirty.
+         *
          * This method is thread safe.
          *
          * @param handle The ManagedFileHandle associated with the file
@@ -227,6 +444,22 @@ namespace Axle {
             return s_Instance->SyncImpl(handle);
         }
 
+        /**
+         * Starts writing the dirty pages of a file back to disk from a job system worker (or the calling thread if
+         * the job system isn't running) and returns right away. Neither the table nor any writer is blocked while
+         * waiting for the disk. The pages are only guaranteed to be on disk after a later Sync, which is cheap once
+         * the writeback is done.
+         *
+         * This method is thread safe. The file stays open until the job is done.
+         *
+         * @param handle The ManagedFileHandle associated with the file
+         *
+         * @returns true if the flush was started, false if the handle is not valid or the file is read-only
+         * */
+        inline static bool SyncAsync(const ManagedFileHandle& handle) {
+            return s_Instance->SyncAsyncImpl(handle);
+        }
+
         /**
          * Syncs current changes made to the map to disk. Flushing changes of a read-only file does nothing.
          *
@@ -399,13 +632,14 @@ namespace Axle {
          * the file is discarded. If the file was previously smaller than newSize, the file size is increased and the
          * new area appears as if zero-filled.
          *
-         * This method is thread safe. It will block until all active ReadGuards and
-         * WriteGuards on this resource are released before proceeding with the resize.
+         * This method is thread safe. Growing a loose file doesn't wait for the ReadGuards and WriteGuards of this
+         * resource, they keep pointing to the old mapping, which stays valid until they're all released. Shrinking a
+         * file, or resizing an evicted one, blocks until every guard on this resource is released.
          *
          * WARNING: Any ReadGuard or WriteGuard obtained AFTER this method returns will
-         * point to the remapped memory at the new size. However, calling this method
-         * while intentionally holding a guard on the same resource from the same thread
-         * will deadlock, since the resize waits for all guards to be released.
+         * point to the remapped memory at the new size. Guards obtained before only see the old size. Shrinking a
+         * file while holding a guard on the same resource from the same thread will deadlock, since the resize waits
+         * for all guards to be released.
          *
          * @param handle The ManagedFileHandle associated with the file
          * @param newSize What new size do you want
@@ -421,16 +655,17 @@ namespace Axle {
          * the file is discarded. If the file was previously smaller than newSize, the file size is increased and the
          * new area appears as if zero-filled.
          *
-         * This method is thread safe. It will block until all active ReadGuards and
-         * WriteGuards on this resource are released before proceeding with the resize.
+         * This method is thread safe. Growing a loose file doesn't wait for the ReadGuards and WriteGuards of this
+         * resource, they keep pointing to the old mapping, which stays valid until they're all released. Shrinking a
+         * file, or resizing an evicted one, blocks until every guard on this resource is released.
          *
          * It's highly encouraged to use the Resize method that accepts a
          * ManagedFileHandle, as it's possible this will be deleted in the future.
          *
          * WARNING: Any ReadGuard or WriteGuard obtained AFTER this method returns will
-         * point to the remapped memory at the new size. However, calling this method
-         * while intentionally holding a guard on the same resource from the same thread
-         * will deadlock, since the resize waits for all guards to be released.
+         * point to the remapped memory at the new size. Guards obtained before only see the old size. Shrinking a
+         * file while holding a guard on the same resource from the same thread will deadlock, since the resize waits
+         * for all guards to be released.
          *
          * @param handle The ManagedFileHandle associated with the file
          * @param newSize What new size do you want
@@ -441,15 +676,226 @@ namespace Axle {
             return s_Instance->ResizeImpl(handle, newSize);
         }
 
+        /**
+         * Mounts an asset pack built with AAP's pack subcommand. The whole pack is mapped once and every asset inside
+         * it can then be loaded through its path under mountPoint, e.g. a pack built from "assets" mounted at "assets"
+         * serves "assets/textures/skybox/top.jpg". Handles to packed assets point to a sub-range of that single
+         * mapping.
+         *
+         * Loose files always take precedence over packed ones, so an asset can be overridden during development by
+         * just placing it on disk. Packed assets are read-only. If several packs contain the same asset, the one
+         * mounted last wins.
+         *
+         * Compressed assets are decompressed when loaded into a buffer taken from a pool. Their chunks are spread
+         * across the job system workers if it's initialized, the loading thread decompresses the rest.
+         *
+         * This method is thread safe. Handles to packed assets stay valid after the pack is unmounted.
+         *
+         * @param pack A filesystem path to the pack
+         * @param mountPoint The directory the packed paths are relative to
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        inline static bool MountPack(const std::filesystem::path& pack, const std::filesystem::path& mountPoint) {
+            return s_Instance->MountPackImpl(pack, mountPoint);
+        }
+
+        /**
+         * Unmounts a pack previously mounted with MountPack. Already loaded assets keep the mapping alive until their
+         * last handle is released, new loads won't find them anymore.
+         *
+         * This method is thread safe.
+         *
+         * @param pack The same path given to MountPack
+         *
+         * @returns true if the pack was mounted, false otherwise
+         * */
+        inline static bool UnmountPack(const std::filesystem::path& pack) {
+            return s_Instance->UnmountPackImpl(pack);
+        }
+
+        /**
+         * Gets the statistics of the pool holding the decompressed assets.
+         * This method is thread safe.
+         *
+         * @returns The statistics of the pool
+         * */
+        inline static BufferPool::Stats GetBufferPoolStats() {
+            return s_Instance->m_BufferPool.GetStats();
+        }
+
+        /**
+         * Limits the amount of bytes the loaded files keep mapped. Once a load would go over the budget, the mappings
+         * that were accessed the longest time ago are dropped until it fits: loose files are unmapped, decompressed
+         * packed files give their buffer back to the pool and the pages of the other packed files are released with
+         * madvise(MADV_DONTNEED). Handles stay valid, the next guard taken on an evicted file maps it again.
+         *
+         * Files with a guard held are never evicted. Writable files are synced before being unmapped.
+         *
+         * This method is thread safe.
+         *
+         * @param bytes The budget in bytes, 0 disables it (the default)
+         * */
+        inline static void SetResidencyBudget(u64 bytes) {
+            s_Instance->SetResidencyBudgetImpl(bytes);
+        }
+
+        /**
+         * Evicts every file that no guard has touched in the given amount of time, regardless of the budget. Meant to
+         * be called periodically, e.g. once the GPU copies of the assets have been created.
+         *
+         * This method is thread safe.
+         *
+         * @param idleFor How long a file must have gone without being accessed
+         *
+         * @returns The amount of bytes evicted
+         * */
+        inline static u64 EvictIdle(std::chrono::nanoseconds idleFor) {
+            return s_Instance->EvictIdleImpl(idleFor);
+        }
+
+        /**
+         * Gets the counters of the residency budget.
+         * This method is thread safe.
+         *
+         * @returns The counters
+         * */
+        inline static ResidencyStats GetResidencyStats() {
+            return s_Instance->GetResidencyStatsImpl();
+        }
+
+        /**
+         * Gets the residency and the last access of a file.
+         * This method is thread safe.
+         *
+         * @param handle The ManagedFileHandle associated with the file
+         *
+         * @returns An Expected that contains the residency if the handle was valid
+         * */
+        inline static Result<ResidencyInfo> GetResidency(const ManagedFileHandle& handle) {
+            return s_Instance->GetResidencyImpl(handle.Get());
+        }
+
+        /**
+         * Counts the bytes of a file that are in memory. Unlike GetResidency, which only tells if the file is mapped,
+         * this asks the kernel which pages are actually there (mincore on Linux), so it shows how much of the file the
+         * next accesses will have to read from disk.
+         *
+         * This method is thread safe. It costs a syscall and a byte per page of the file, it's meant for debugging.
+         *
+         * @param handle The handle associated with the file
+         *
+         * @returns An Expected that contains the resident bytes if the handle was valid, 0 if the file is evicted
+         * */
+        inline static Result<u64> GetResidentBytes(FileHandle handle) {
+            return s_Instance->GetResidentBytesImpl(handle);
+        }
+
+        /**
+         * Lists every loaded file with its mapped and resident bytes, see GetResidentBytes. The total of the mapped
+         * bytes is GetResidencyStats().residentBytes. Files with a guard held exclusively are skipped instead of
+         * waited for.
+         *
+         * This method is thread safe. It's as expensive as calling GetResidentBytes on every file.
+         *
+         * @returns The loaded files
+         * */
+        inline static std::vector<MappedFileInfo> GetMappedFiles() {
+            return s_Instance->GetMappedFilesImpl();
+        }
+
+        /**
+         * Reads the page fault counters of the calling thread (getrusage(RUSAGE_THREAD) on Linux) and returns how many
+         * were taken since its previous call. Meant to be called once per frame by the render thread, so the faults of
+         * a frame tell whether it stalled on the first touch of mapped files.
+         *
+         * This method is thread safe, each thread has its own counters. The result of the last call is kept for
+         * GetFrameFaults. Always 0 on platforms without per-thread counters.
+         *
+         * @returns The faults since the previous call on this thread, 0 on the first one
+         * */
+        inline static FaultStats SampleFrameFaults() {
+            return s_Instance->SampleFrameFaultsImpl();
+        }
+
+        /**
+         * Gets the result of the last call to SampleFrameFaults, from any thread.
+         * This method is thread safe.
+         *
+         * @returns The faults of the last sampled frame
+         * */
+        inline static FaultStats GetFrameFaults() {
+            return s_Instance->GetFrameFaultsImpl();
+        }
+
+        /**
+         * Maps a loose file again after it changed on disk and bumps its version. The handle stays the same, only
+         * guards taken afterwards see the new contents. If the file can't be mapped right now, e.g. an editor is still
+         * writing it, it's left as if it was evicted and mapped again on the next access.
+         *
+         * This method is thread safe. It blocks until every guard of this resource is released.
+         *
+         * @param handle The handle associated with the file
+         *
+         * @returns true if the file was mapped again, false if the handle is invalid, the file is packed or it
+         * couldn't be mapped
+         * */
+        inline static bool Reload(FileHandle handle) {
+            return s_Instance->ReloadImpl(handle);
+        }
+
+        /**
+         * Gets the version of a file, bumped every time it's reloaded. Lets the owners of derived data, e.g. GPU
+         * objects, tell whether it's stale.
+         * This method is thread safe and doesn't lock the resource.
+         *
+         * @param handle The handle associated with the file
+         *
+         * @returns An Expected that contains the version if the handle was valid
+         * */
+        inline static Result<u32> GetVersion(FileHandle handle) {
+            return s_Instance->GetVersionImpl(handle);
+        }
+
+        /**
+         * Gets the hash of the contents of a file, the same for every byte-identical file. Lets the owners of derived
+         * data, e.g. GPU objects, share them between files. Files loaded with the same hash already share their
+         * mapping, see LoadOptions::deduplicate.
+         * This method is thread safe and doesn't lock the resource.
+         *
+         * @param handle The handle associated with the file
+         *
+         * @returns An Expected that contains the hash if the handle was valid, 0 if the file wasn't loaded with
+         * deduplicate or it has been reloaded since
+         * */
+        inline static Result<u64> GetContentHash(FileHandle handle) {
+            return s_Instance->GetContentHashImpl(handle);
+        }
+
+        /**
+         * Gets the handle of a file if it's loaded, without loading it nor taking a reference.
+         * This method is thread safe.
+         *
+         * @param path The path to the file, any spelling of it
+         *
+         * @returns An Expected that contains the handle or a NotFound error if the file isn't loaded
+         * */
+        inline static Result<FileHandle> Find(const std::filesystem::path& path) {
+            return s_Instance->FindImpl(path);
+        }
+
 #ifdef AXLE_TESTING
-        inline static u16 LargestAvailableIndex() {
+        inline static u32 LargestAvailableIndex() {
             return s_Instance->LargestAvailableIndexImpl();
         }
-        inline static std::priority_queue<u32, std::vector<u32>, std::greater<u32>> AvailableIndexes() {
+        inline static std::vector<u32> AvailableIndexes() {
             return s_Instance->AvailableIndexesImpl();
         }
-        inline static u16 MagicNumberCounter() {
-            return s_Instance->MagicNumberCounterImpl();
+        inline static u32 SlotGeneration(u32 index) {
+            return s_Instance->SlotGenerationImpl(index);
+        }
+        inline static std::vector<std::pair<u64, u64>> DirtyPages(const ManagedFileHandle& handle) {
+            return s_Instance->DirtyPagesImpl(handle.Get());
         }
 #endif // AXLE_TESTING
 
@@ -457,19 +903,21 @@ namespace Axle {
         // Let ManagedFileHandle access the AddRef and ReleaseRef methods
         friend class ManagedFileHandle;
 
-        Result<ManagedFileHandle> LoadImpl(const std::filesystem::path& path, bool readOnly);
+        Result<ManagedFileHandle>
+        LoadImpl(const std::filesystem::path& path, bool readOnly, const LoadOptions& options);
+        bool PrefetchImpl(FileHandle handle, bool advise, bool touch);
         bool SyncImpl(const ManagedFileHandle& handle);
         bool SyncImpl(FileHandle handle);
+        bool SyncAsyncImpl(const ManagedFileHandle& handle);
         Result<WriteGuard> DataImpl(const ManagedFileHandle& handle);
         Result<WriteGuard> DataImpl(FileHandle handle);
-        Result<ReadGuard> DataConstImpl(const ManagedFileHandle& handle) const;
-        Result<ReadGuard> DataConstImpl(FileHandle handle) const;
+        Result<ReadGuard> DataConstImpl(const ManagedFileHandle& handle);
+        Result<ReadGuard> DataConstImpl(FileHandle handle);
         Result<u64> SizeImpl(const ManagedFileHandle& handle) const;
         Result<u64> SizeImpl(FileHandle handle) const;
         bool CreateImpl(const std::filesystem::path& path, u64 size);
         bool IsHandleValidImpl(FileHandle handle) const {
-            std::shared_lock lock(m_Mutex);
-            return IsHandleValidUnsafe(handle);
+            return GetResource(handle) != nullptr;
         }
         Result<bool> IsReadOnlyImpl(const ManagedFileHandle& handle) const;
         Result<bool> IsReadOnlyImpl(FileHandle handle) const;
@@ -477,47 +925,43 @@ namespace Axle {
         Result<std::filesystem::path> GetPathImpl(FileHandle handle) const;
         bool ResizeImpl(const ManagedFileHandle& handle, u64 newSize);
         bool ResizeImpl(FileHandle handle, u64 newSize);
+        bool MountPackImpl(const std::filesystem::path& pack, const std::filesystem::path& mountPoint);
+        bool UnmountPackImpl(const std::filesystem::path& pack);
+        void SetResidencyBudgetImpl(u64 bytes);
+        u64 EvictIdleImpl(std::chrono::nanoseconds idleFor);
+        ResidencyStats GetResidencyStatsImpl() const;
+        Result<ResidencyInfo> GetResidencyImpl(FileHandle handle) const;
+        Result<u64> GetResidentBytesImpl(FileHandle handle) const;
+        std::vector<MappedFileInfo> GetMappedFilesImpl() const;
+        FaultStats SampleFrameFaultsImpl();
+        FaultStats GetFrameFaultsImpl() const;
+        bool ReloadImpl(FileHandle handle);
+        Result<u32> GetVersionImpl(FileHandle handle) const;
+        Result<u64> GetContentHashImpl(FileHandle handle) const;
+        Result<FileHandle> FindImpl(const std::filesystem::path& path) const;
 #ifdef AXLE_TESTING
-        inline u16 LargestAvailableIndexImpl() {
-            std::shared_lock lock(m_Mutex);
-            return m_LargestAvailableIndex;
-        }
-        inline std::priority_queue<u32, std::vector<u32>, std::greater<u32>> AvailableIndexesImpl() {
-            std::shared_lock lock(m_Mutex);
-            return m_AvailableIndexes;
-        }
-        inline u16 MagicNumberCounterImpl() {
-            std::shared_lock lock(m_Mutex);
-            return m_MagicNumberCounter;
+        inline u32 LargestAvailableIndexImpl() {
+            return m_LargestAvailableIndex.load(std::memory_order_acquire);
         }
+        /// Top of the free list first, only meaningful while no file is being loaded or closed
+        std::vector<u32> AvailableIndexesImpl() const;
+        u32 SlotGenerationImpl(u32 index) const;
+        std::vector<std::pair<u64, u64>> DirtyPagesImpl(FileHandle handle);
 #endif // AXLE_TESTING
 
-        /// A zero-overhead wrapper to make std::atomic movable so std::swap works in SparseSet
-        struct MovableAtomic {
-            std::atomic<u32> count{1};
-
-            MovableAtomic() = default;
-            MovableAtomic(u32 initial)
-                : count(initial) {}
-
-            // Prevent copying
-            MovableAtomic(const MovableAtomic&) = delete;
-            MovableAtomic& operator=(const MovableAtomic&) = delete;
-
-            // Custom Move Semantics
-            MovableAtomic(MovableAtomic&& other) noexcept
-                : count(other.count.load(std::memory_order_relaxed)) {}
-
-            MovableAtomic& operator=(MovableAtomic&& other) noexcept {
-                if (this != &other) {
-                    count.store(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
-                }
-                return *this;
-            }
-        };
-
-        /// Small struct designed to keep resources organized
+        /// A slot of the resource table. Slots never move once created so they can be accessed without locking the
+        /// table.
         struct Resource;
+        /// An asset pack mapped by MountPack
+        struct MountedPack;
+        /// A sub-range of a mounted pack or a decompressed copy of it, what the slot of a packed asset maps
+        struct PackedRange;
+        /// A small file copied into the heap instead of being mapped
+        struct HeapCopy;
+        /// A mapping shared by the files with the same contents, see LoadOptions::deduplicate
+        struct SharedMapping;
+        /// An entry of a mounted pack, as found by FindPackedUnsafe
+        struct PackedEntry;
 
         inline static ResourceManager& GetInstance() noexcept {
             return *s_Instance;
@@ -544,9 +988,9 @@ namespace Axle {
         bool ReleaseRef(FileHandle handle);
 
         /**
-         * Closes the file associated with the given handle.
-         * The given handle becomes invalid once the file is closed.
-         * This method is not thread safe.
+         * Closes the file associated with the given handle, which becomes invalid right away. The file stays mapped
+         * until FinishClose is called with its index.
+         * This method is not thread safe, the caller must hold the table mutex exclusively.
          *
          * @param handle The handle associated with the file
          *
@@ -554,38 +998,328 @@ namespace Axle {
          * */
         bool CloseUnsafe(FileHandle handle);
 
+        /**
+         * Waits until every guard of a file closed by CloseUnsafe is released, flushes and unmaps it and gives its
+         * slot back to the free list. It doesn't need the table mutex.
+         *
+         * @param index The index of the closed file
+         * */
+        void FinishClose(u32 index);
+
         /**
          * Checks if a given file has already been opened and returns the handle if it has been.
+         * The lookup is a single hash map access on the normalized path, so its cost doesn't depend on the amount of
+         * opened files.
          *
          * This method is not thread safe.
          *
-         * @param path The filesystem path to the file
+         * @param key The normalized path of the file, as returned by NormalizePath
          *
          * @return An Expected handle value, valid if it has been already opened, otherwise not.
          * */
-        Result<FileHandle> IsAlreadyOpenedUnsafe(const std::filesystem::path& path) const;
+        Result<FileHandle> IsAlreadyOpenedUnsafe(const std::string& key) const;
+
+        /**
+         * Looks the given file up in the mounted packs, starting from the last mounted one.
+         *
+         * This method is not thread safe, the caller must hold the table mutex.
+         *
+         * @param key The normalized path of the file, as returned by NormalizePath
+         * @param entry Filled with the entry of the asset if it's found
+         *
+         * @returns true if a mounted pack contains the file, false otherwise
+         * */
+        bool FindPackedUnsafe(const std::string& key, PackedEntry& entry) const;
+
+        /**
+         * Builds the range a packed asset is served from, decompressing it first if needed.
+         *
+         * This method is thread safe and it doesn't lock any mutex.
+         *
+         * @param entry The entry of the asset
+         * @param range Filled with the range of the asset
+         *
+         * @returns true if the operation was successful, false if the compressed data was corrupted
+         * */
+        bool MapPacked(const PackedEntry& entry, PackedRange& range);
+
+        /**
+         * Maps a loose file, or copies it into the heap, the way the options ask for.
+         *
+         * This method is thread safe and it doesn't lock any mutex.
+         *
+         * @param path The filesystem path to the file
+         * @param readOnly Defines if the file can be modified or not
+         * @param options How the file is brought into memory
+         * @param mmap Filled with the mapping of the file
+         *
+         * @returns The error of the operation, empty if it was successful
+         * */
+        template <typename Mapping>
+        std::error_code
+        MapLooseFile(const std::filesystem::path& path, bool readOnly, const LoadOptions& options, Mapping& mmap);
+
+        /**
+         * Builds the key used to index opened files. Different spellings of the same file (relative, absolute, with
+         * "." or ".." components or through symlinks) all produce the same key.
+         *
+         * This method is thread safe and it doesn't lock any mutex.
+         *
+         * @param path The filesystem path to the file
+         *
+         * @returns The normalized path as a generic string
+         * */
+        static std::string NormalizePath(const std::filesystem::path& path);
 
         /**
          * Syncs current changes made to the map to disk.
          * Flushing changes of a read-only file does nothing.
          *
-         * Unlike the public Sync method this one is not thread safe.
+         * Unlike the public Sync method this one is not thread safe, the caller must hold the resource mutex and its
+         * remap mutex.
          *
-         * @param handle The handle associated with the file
+         * @param resource The resource to flush
          *
          * @returns true if the operation was successful, false otherwise
          * */
-        bool SyncUnsafe(FileHandle handle);
+        bool SyncUnsafe(Resource& resource);
 
         /**
-         * Checks wether or not the given handle is valid.
-         * Unlike the public method this one is not thread safe.
+         * Grows a loose file without waiting for its guards. The file is grown and mapped again, the new mapping is
+         * published and the old one is retired until every guard that may point into it has been released.
+         *
+         * Unlike the public Resize method this one is not thread safe, the caller must hold the remap mutex of the
+         * resource, but not its resource mutex.
+         *
+         * @param resource The resource to grow, resident and not packed
+         * @param newSize The new size, not smaller than the current one
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        bool GrowUnsafe(Resource& resource, u64 newSize);
+
+        /**
+         * Writes the dirty pages of a writable resource back to its file.
+         *
+         * This method is not thread safe, the caller must hold the resource mutex and its remap mutex.
+         *
+         * @param resource A resident writable resource
+         * @param async If true the writeback is only started and the pages stay dirty, so a later sync still waits
+         * for them
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        bool FlushDirtyUnsafe(Resource& resource, bool async);
+
+        /**
+         * Looks for a loaded file with the same contents and, if there's one, takes a reference to its mapping. The
+         * contents are compared byte by byte, a matching hash isn't trusted on its own.
+         * This method is thread safe, the caller must not hold any lock.
+         *
+         * @param contentHash The hash of the contents, see LoadOptions::deduplicate
+         * @param data The contents
+         * @param size The size of the contents
+         * @param shared Filled with the mapping of the loaded file, its source is left untouched
+         *
+         * @returns true if a loaded file has the same contents, false otherwise
+         * */
+        bool ShareIdentical(u64 contentHash, const char* data, u64 size, SharedMapping& shared);
+
+        /**
+         * Moves a mapping behind a reference count so files loaded later with the same contents can share it. Its
+         * bytes are counted as resident once, until the last file sharing it drops it.
+         *
+         * This method is thread safe and it doesn't lock any mutex.
+         *
+         * @param mmap The mapping, replaced by the shared one
+         * @param source Where the file comes from, to map it again on its own once evicted
+         * */
+        template <typename Mapping>
+        void ShareMapping(Mapping& mmap, const PackedEntry& source);
+
+        /**
+         * Stops sharing the contents of a resource: removes it from the content index, so files loaded from now on
+         * with its contents don't get its mapping. The files already sharing it keep it.
+         * This method is not thread safe, the caller must hold the table lock exclusively.
+         *
+         * @param resource The resource
+         * @param index The index of its slot
+         * */
+        void ForgetContentUnsafe(Resource& resource, u32 index);
+
+        /**
+         * Maps a resource that shared a mapping again from its own file or pack entry, shared from then on with the
+         * files loaded after it.
+         * This method is not thread safe, the caller must hold the resource mutex exclusively and its remap mutex.
+         *
+         * @param resource A resource holding a shared mapping, already unmapped
+         *
+         * @returns The error of mapping it, if any
+         * */
+        std::error_code MapSharedAgainUnsafe(Resource& resource);
+
+        /**
+         * Maps every resource still sharing the given mapping on its own. Called once the file the mapping comes from
+         * was reloaded, since a loose mapping shows the new contents of its file.
+         *
+         * This method is thread safe, it must be called without holding any mutex.
+         *
+         * @param owner The mapping
+         * */
+        void DetachShared(const std::shared_ptr<const void>& owner);
+
+        /**
+         * Counts the bytes of a resource that are in memory, see GetResidentBytes.
+         * This method is not thread safe, the caller must hold the resource mutex.
+         *
+         * @param resource The resource
+         *
+         * @returns The resident bytes, 0 if the resource is evicted
+         * */
+        static u64 ResidentBytesUnsafe(const Resource& resource);
+
+        /**
+         * Drops the mapping of a resource, see SetResidencyBudget.
+         * This method is not thread safe, the caller must hold the resource mutex exclusively.
+         *
+         * @param resource A resident resource
+         *
+         * @returns The amount of bytes evicted
+         * */
+        u64 EvictUnsafe(Resource& resource);
+
+        /**
+         * Maps an evicted resource again.
+         * This method is not thread safe, the caller must hold the resource mutex exclusively.
+         *
+         * @param resource An evicted resource
+         *
+         * @returns true if the operation was successful, false otherwise
+         * */
+        bool RestoreUnsafe(Resource& resource);
+
+        /**
+         * Makes room for an evicted resource within the budget and maps it again.
+         *
+         * This method is thread safe, it must be called without holding any mutex.
          *
          * @param handle The handle associated with the file
          *
-         * @returns true if the handle is valid, false otherwise
+         * @returns false if the file could not be mapped again, true otherwise (even if the handle is not valid)
+         * */
+        bool RestoreResource(FileHandle handle);
+
+        /**
+         * Maps a file again with its contents on disk, see Reload.
+         *
+         * This method is thread safe, it must be called without holding any mutex.
+         *
+         * @param handle The handle associated with the file
+         * @param previous Set to the mapping the file shared if other files still share it, see DetachShared
+         *
+         * @returns true if the file was mapped again, false otherwise
          * */
-        bool IsHandleValidUnsafe(FileHandle handle) const;
+        bool ReloadResource(FileHandle handle, std::shared_ptr<const void>& previous);
+
+        /**
+         * Evicts the least recently accessed resources that have no guard held until at most targetBytes are
+         * resident.
+         *
+         * This method is thread safe, it must be called without holding any mutex.
+         *
+         * @param targetBytes The amount of resident bytes to get down to
+         * @param idleBefore Resources accessed after this steady clock tick are kept
+         *
+         * @returns The amount of bytes evicted
+         * */
+        u64 EvictLeastRecentlyUsed(u64 targetBytes, i64 idleBefore);
+
+        /**
+         * Evicts resources until the given amount of bytes can be mapped without going over the budget. Does nothing
+         * if there's no budget.
+         *
+         * This method is thread safe, it must be called without holding any mutex.
+         *
+         * @param incoming The amount of bytes about to be mapped
+         * */
+        void MakeRoom(u64 incoming);
+
+        /**
+         * Gets the slot associated with the given handle if the handle is valid.
+         *
+         * This method is lock-free. Because the resource may be closed right after the check, the handle has to be
+         * validated again once the resource mutex is held before touching the mapping.
+         *
+         * @param handle The handle associated with the file
+         *
+         * @returns A pointer to the slot or nullptr if the handle is not valid
+         * */
+        Resource* GetResource(FileHandle handle) const;
+
+        /**
+         * Gets the slot associated with the given handle and locks its mutex with the given lock type. The handle is
+         * validated again once the lock is held so the returned slot is guaranteed to stay alive until the lock is
+         * released.
+         *
+         * This method doesn't lock the table.
+         *
+         * @param handle The handle associated with the file
+         * @param lock The lock that will own the resource mutex if the call succeeds
+         *
+         * @returns A pointer to the slot or nullptr if the handle is not valid
+         * */
+        template <typename Lock>
+        Resource* LockResource(FileHandle handle, Lock& lock) const;
+
+        /**
+         * Same as LockResource but it also records the access and maps the resource again if it was evicted.
+         *
+         * This method doesn't lock the table. It must be called without holding any mutex.
+         *
+         * @param handle The handle associated with the file
+         * @param lock The lock that will own the resource mutex if the call succeeds
+         *
+         * @returns A pointer to the resident slot, an InvalidArgument error if the handle is not valid or an
+         * AssetLoadFailed one if the evicted file could not be mapped again
+         * */
+        template <typename Lock>
+        Result<Resource*> LockResidentResource(FileHandle handle, Lock& lock);
+
+        /**
+         * Gets the slot stored at the given index if its chunk has been allocated.
+         * This method is lock-free.
+         *
+         * @param index The index of the slot
+         *
+         * @returns A pointer to the slot or nullptr if it doesn't exist
+         * */
+        Resource* GetSlot(u32 index) const;
+
+        /**
+         * Gets the slot stored at the given index, allocating the chunk that contains it if needed.
+         * This method is lock-free.
+         *
+         * @param index The index of the slot
+         *
+         * @returns A pointer to the slot or nullptr if the table is full
+         * */
+        Resource* GetOrCreateSlot(u32 index);
+
+        /**
+         * Takes a slot out of the free list, or a never used one if the list is empty.
+         * This method is lock-free.
+         *
+         * @returns The index of the slot or an OutOfMemory error if the table is full
+         * */
+        Result<u32> AcquireSlot();
+
+        /**
+         * Gives a slot back to the free list. Its handle must already be invalid.
+         * This method is lock-free.
+         *
+         * @param index The index of the slot
+         * */
+        void ReleaseSlot(u32 index);
 
         /**
          * Checks if the given path points to an existing file.
@@ -672,15 +1406,41 @@ namespace Axle {
 
         static std::unique_ptr<ResourceManager> s_Instance;
 
-        /// A counter that stores the largest available index
-        u32 m_LargestAvailableIndex = 0;
-        /// Contains the deleted indexes that are available once again to be used
-        std::priority_queue<u32, std::vector<u32>, std::greater<u32>> m_AvailableIndexes;
-
-        u32 m_MagicNumberCounter = 0;
-        /// The id of the SparseSet are the indexes, not the whole handle
-        std::unique_ptr<SparseSet<Resource>> m_Resources{};
-
+        /// A counter that stores the largest available index, every slot below it has been handed out at least once
+        std::atomic<u32> m_LargestAvailableIndex{0};
+        /// Treiber stack of the freed slots: the index plus one of the top slot in the low half, 0 if it's empty, and
+        /// a tag bumped by every push and pop in the high half so a head that changed and came back fails the exchange
+        std::atomic<u64> m_FreeSlots{0};
+
+        /// Slots are allocated in chunks that are never moved or freed until shutdown
+        static constexpr u32 SlotChunkShift = 10;
+        static constexpr u32 SlotChunkSize = 1 << SlotChunkShift;
+        static constexpr u32 MaxSlotChunks = 4096;
+        /// The table is indexed by the index of the handle, not the whole handle
+        std::array<std::atomic<Resource*>, MaxSlotChunks> m_Chunks{};
+        /// Maps the normalized path of every opened file to its index in m_Chunks
+        std::unordered_map<std::string, u32> m_PathIndex;
+        /// Maps the content hash of the deduplicated files to their index in m_Chunks. On a collision between
+        /// different contents the first file keeps the entry.
+        std::unordered_map<u64, u32> m_ContentIndex;
+        /// Mounted asset packs in mount order
+        std::vector<MountedPack> m_Packs;
+        /// Holds the decompressed packed assets. Slots are freed in the destructor body, so it outlives all of them
+        BufferPool m_BufferPool;
+
+        /// Residency budget in bytes, 0 if there's none
+        std::atomic<u64> m_ResidencyBudget{0};
+        /// Bytes currently mapped by the resident resources
+        std::atomic<u64> m_ResidentBytes{0};
+        std::atomic<u64> m_Evictions{0};
+        std::atomic<u64> m_EvictedBytes{0};
+        std::atomic<u64> m_Restores{0};
+        /// Last result of SampleFrameFaults
+        std::atomic<u64> m_FrameMinorFaults{0};
+        std::atomic<u64> m_FrameMajorFaults{0};
+
+        /// Only guards the path index, the mounted packs and publishing or closing files. Slots are allocated and freed
+        /// without it.
         mutable std::shared_mutex m_Mutex;
     };
 } // namespace Axle
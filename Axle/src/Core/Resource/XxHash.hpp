@@ -0,0 +1,117 @@
+#pragma once
+
+// Dependency-free XXH64, as described in doc/xxhash_spec.md of https://github.com/Cyan4973/xxHash. Used to hash the
+// contents of assets so identical ones are loaded once. Like AssetPack.hpp it's shared with AAP, which stores the hash
+// of every packed asset in the TOC, so it must only depend on the standard library.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Axle::XxHash {
+    namespace Detail {
+        constexpr std::uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+        constexpr std::uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr std::uint64_t PRIME3 = 0x165667B19E3779F9ull;
+        constexpr std::uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+        constexpr std::uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+        constexpr std::uint64_t RotateLeft(std::uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline std::uint64_t Read64(const std::uint8_t* p) {
+            std::uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline std::uint32_t Read32(const std::uint8_t* p) {
+            std::uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        constexpr std::uint64_t Round(std::uint64_t accumulator, std::uint64_t lane) {
+            accumulator += lane * PRIME2;
+            accumulator = RotateLeft(accumulator, 31);
+            return accumulator * PRIME1;
+        }
+
+        constexpr std::uint64_t MergeRound(std::uint64_t hash, std::uint64_t accumulator) {
+            hash ^= Round(0, accumulator);
+            return hash * PRIME1 + PRIME4;
+        }
+    } // namespace Detail
+
+    /**
+     * Hashes a block of memory (XXH64). Reads are unaligned and little endian, like every platform the engine runs on.
+     *
+     * @param data The data to hash
+     * @param size Size of the data in bytes
+     * @param seed Changes the whole hash, 0 unless different families of hashes are needed
+     *
+     * @returns The hash
+     * */
+    inline std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed = 0) {
+        using namespace Detail;
+
+        const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
+        const std::uint8_t* const end = p + size;
+        std::uint64_t hash;
+
+        // Four independent lanes over 32 byte stripes, so the loop isn't bound by the latency of a single multiply
+        if (size >= 32) {
+            std::uint64_t v1 = seed + PRIME1 + PRIME2;
+            std::uint64_t v2 = seed + PRIME2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - PRIME1;
+
+            const std::uint8_t* const limit = end - 32;
+
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = seed + PRIME5;
+        }
+
+        hash += static_cast<std::uint64_t>(size);
+
+        // The remaining 0 to 31 bytes
+        for (; p + 8 <= end; p += 8) {
+            hash ^= Round(0, Read64(p));
+            hash = RotateLeft(hash, 27) * PRIME1 + PRIME4;
+        }
+
+        if (p + 4 <= end) {
+            hash ^= static_cast<std::uint64_t>(Read32(p)) * PRIME1;
+            hash = RotateLeft(hash, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+
+        for (; p < end; ++p) {
+            hash ^= static_cast<std::uint64_t>(*p) * PRIME5;
+            hash = RotateLeft(hash, 11) * PRIME1;
+        }
+
+        // Avalanche
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+} // namespace Axle::XxHash
@@ -6,20 +6,75 @@
 #include "Logger/Log.hpp"
 #include "Core/Input/InputManager.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
 #include "Core/Config/Config.hpp"
+#include "Core/Threading/ThreadPlacement.hpp"
 #include <CoroWeaver.hpp>
 
 namespace Axle {
+    namespace {
+        /// Overrides a placement with a CPU list from the config, like "0-3,8", if there is one
+        void OverrideCpus(std::vector<u32>& cpus, const std::string& name) {
+            const std::string list = Config::GetOrSet<std::string>("affinity", name, "");
+            if (list.empty())
+                return;
+
+            std::vector<u32> parsed = CpuTopology::ParseCpuList(list);
+            if (parsed.empty())
+                AX_CORE_WARN(LogChannel::Core, "Invalid CPU list \"{0}\" for affinity.{1}, ignoring it", list, name);
+            else
+                cpus = std::move(parsed);
+        }
+
+        /// Pins the main thread, the render thread and the job system workers to CPUs, if enabled in the config
+        void PinThreads() {
+            if (!Config::GetOrSet<bool>("affinity", "enabled", false))
+                return;
+
+            const u32 workers = cw::JobSystem::GetNumThreads();
+            ThreadPlacement placement = ThreadPlacement::Plan(CpuTopology::Probe(), workers);
+
+            OverrideCpus(placement.main, "main_cpus");
+            if (workers > RENDER_THREAD_ID)
+                OverrideCpus(placement.workers[RENDER_THREAD_ID], "render_cpus");
+
+            std::vector<u32> workerCpus;
+            OverrideCpus(workerCpus, "worker_cpus");
+            if (!workerCpus.empty()) {
+                for (u32 worker = 0; worker < workers; ++worker) {
+                    if (worker != RENDER_THREAD_ID)
+                        placement.workers[worker] = workerCpus;
+                }
+            }
+
+            if (placement.Apply())
+                AX_CORE_INFO(LogChannel::Core, "Pinned the main thread and {0} job system workers to CPUs", workers);
+            else
+                AX_CORE_WARN(LogChannel::Core, "Couldn't pin every thread to its CPUs, some will run anywhere");
+        }
+    } // namespace
+
     void InitSystems() {
         Axle::Log::Init();
         Axle::Config::Init("assets/tests/config.ini");
         Axle::EventHandler::Init();
+        Axle::EventHandler::SetFanOut(Config::GetOrSet<u32>("events", "fan_out", 4));
         Axle::InputManager::Init();
         Axle::ResourceManager::Init();
+        Axle::ResourceManager::SetResidencyBudget(Config::GetOrSet<u64>("resources", "residency_budget_mb", 0) << 20);
+        if (Config::GetOrSet<bool>("resources", "hot_reload", true))
+            Axle::FileWatcher::Init(
+                std::chrono::milliseconds(Config::GetOrSet<u32>("resources", "hot_reload_debounce_ms", 100)));
         cw::JobSystem::Init(Config::GetOrSet<u8>("jobsystem", "threads", 3));
+        cw::JobSystem::SetIdlePolicy({Config::GetOrSet<u32>("jobsystem", "spin_iterations", 64),
+                                      Config::GetOrSet<u32>("jobsystem", "yield_iterations", 8)});
+        cw::JobSystem::SetTimerSpin(std::chrono::microseconds(Config::GetOrSet<u32>("jobsystem", "timer_spin_us", 50)));
+        PinThreads();
     }
 
     void ShutdownSystems() {
+        if (Axle::FileWatcher::IsInitialized())
+            Axle::FileWatcher::ShutDown();
         Axle::ResourceManager::ShutDown();
         Axle::InputManager::ShutDown();
         Axle::EventHandler::ShutDown();
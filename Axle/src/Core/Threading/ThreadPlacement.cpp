@@ -0,0 +1,282 @@
+#include "axpch.hpp"
+
+#include "ThreadPlacement.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <cctype>
+#include <charconv>
+#include <fstream>
+
+#ifdef AX_PLATFORM_LINUX
+#    include <sched.h>
+#endif
+
+namespace Axle {
+    namespace {
+        /// First line of a sysfs file without the trailing new line
+        std::optional<std::string> ReadLine(const std::filesystem::path& path) {
+            std::ifstream file(path);
+            std::string line;
+            if (!file || !std::getline(file, line))
+                return std::nullopt;
+            return line;
+        }
+
+        std::optional<i64> ReadNumber(const std::filesystem::path& path) {
+            std::optional<std::string> line = ReadLine(path);
+            if (!line)
+                return std::nullopt;
+
+            i64 value = 0;
+            auto [end, error] = std::from_chars(line->data(), line->data() + line->size(), value);
+            if (error != std::errc())
+                return std::nullopt;
+            return value;
+        }
+
+        /// Lowest CPU sharing the highest level cache of cpu, the cpu itself if the caches aren't listed
+        u32 ReadCacheGroup(const std::filesystem::path& cpuDir, u32 cpu) {
+            std::error_code error;
+            std::filesystem::directory_iterator it(cpuDir / "cache", error);
+            if (error)
+                return cpu;
+
+            i64 highestLevel = -1;
+            u32 group = cpu;
+
+            for (const std::filesystem::directory_entry& entry : it) {
+                if (!entry.path().filename().string().starts_with("index"))
+                    continue;
+
+                const std::optional<i64> level = ReadNumber(entry.path() / "level");
+                const std::optional<std::string> shared = ReadLine(entry.path() / "shared_cpu_list");
+                if (!level || !shared || *level <= highestLevel)
+                    continue;
+
+                const std::vector<u32> cpus = CpuTopology::ParseCpuList(*shared);
+                if (cpus.empty())
+                    continue;
+
+                highestLevel = *level;
+                group = *std::min_element(cpus.begin(), cpus.end());
+            }
+
+            return group;
+        }
+    } // namespace
+
+    CpuTopology CpuTopology::Probe(const std::filesystem::path& root) {
+        CpuTopology topology;
+
+        const std::optional<std::string> online = ReadLine(root / "online");
+        if (!online)
+            return topology;
+
+        for (u32 id : ParseCpuList(*online)) {
+            const std::filesystem::path dir = root / ("cpu" + std::to_string(id));
+
+            LogicalCpu cpu;
+            cpu.id = id;
+            // Without topology files every CPU is its own core
+            cpu.core = static_cast<u32>(ReadNumber(dir / "topology" / "core_id").value_or(id));
+            // Some ARM boards report -1
+            cpu.package =
+                static_cast<u32>(std::max<i64>(ReadNumber(dir / "topology" / "physical_package_id").value_or(0), 0));
+            cpu.cacheGroup = ReadCacheGroup(dir, id);
+
+            // ARM exposes the scheduler's view of big/little cores, elsewhere the max frequency tells them apart
+            std::optional<i64> capacity = ReadNumber(dir / "cpu_capacity");
+            if (!capacity)
+                capacity = ReadNumber(dir / "cpufreq" / "cpuinfo_max_freq");
+            cpu.capacity = static_cast<u64>(std::max<i64>(capacity.value_or(0), 0));
+
+            topology.m_Cpus.push_back(cpu);
+        }
+
+        return topology;
+    }
+
+    std::vector<u32> CpuTopology::ParseCpuList(std::string_view list) {
+        std::vector<u32> cpus;
+
+        // Trailing new lines and spaces
+        while (!list.empty() && std::isspace(static_cast<unsigned char>(list.back())))
+            list.remove_suffix(1);
+
+        for (auto range : std::views::split(list, ',')) {
+            const char* first = range.data();
+            const char* last = range.data() + range.size();
+
+            u32 begin = 0;
+            auto [dash, error] = std::from_chars(first, last, begin);
+            if (error != std::errc())
+                return {};
+
+            u32 end = begin;
+            if (dash != last) {
+                if (*dash != '-')
+                    return {};
+
+                auto [rangeEnd, rangeError] = std::from_chars(dash + 1, last, end);
+                if (rangeError != std::errc() || rangeEnd != last || end < begin)
+                    return {};
+            }
+
+            for (u32 cpu = begin; cpu <= end; ++cpu)
+                cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    std::vector<std::vector<u32>> CpuTopology::GetCores() const {
+        struct Core {
+            u32 package;
+            u32 core;
+            u32 cacheGroup;
+            u64 capacity;
+            std::vector<u32> cpus;
+        };
+
+        std::vector<Core> cores;
+        for (const LogicalCpu& cpu : m_Cpus) {
+            auto it = std::find_if(cores.begin(), cores.end(), [&cpu](const Core& core) {
+                return core.package == cpu.package && core.core == cpu.core;
+            });
+
+            if (it == cores.end()) {
+                cores.push_back({cpu.package, cpu.core, cpu.cacheGroup, cpu.capacity, {cpu.id}});
+            } else {
+                it->cpus.push_back(cpu.id);
+                it->capacity = std::max(it->capacity, cpu.capacity);
+            }
+        }
+
+        std::stable_sort(cores.begin(), cores.end(), [](const Core& a, const Core& b) {
+            if (a.capacity != b.capacity)
+                return a.capacity > b.capacity;
+            return std::tie(a.cacheGroup, a.package, a.core) < std::tie(b.cacheGroup, b.package, b.core);
+        });
+
+        std::vector<std::vector<u32>> result;
+        result.reserve(cores.size());
+        for (Core& core : cores) {
+            std::sort(core.cpus.begin(), core.cpus.end());
+            result.push_back(std::move(core.cpus));
+        }
+        return result;
+    }
+
+    ThreadPlacement ThreadPlacement::Plan(const CpuTopology& topology, u32 workers) {
+        ThreadPlacement placement;
+        placement.workers.resize(workers);
+
+        const std::vector<std::vector<u32>> cores = topology.GetCores();
+        const bool hasRender = workers > RENDER_THREAD_ID;
+
+        // The render and main threads only get a core to themselves if at least one is left for the rest
+        const u64 dedicated = hasRender ? 2 : 1;
+        if (cores.size() <= dedicated)
+            return placement;
+
+        u64 next = 0;
+        if (hasRender)
+            placement.workers[RENDER_THREAD_ID] = cores[next++];
+        placement.main = cores[next++];
+
+        const std::span<const std::vector<u32>> left(cores.begin() + next, cores.end());
+        const u32 others = workers - (hasRender ? 1 : 0);
+
+        // A core each while there are enough of them, past that a worker pinned to a single core could end up
+        // sharing it while another core idles, so they all share the remaining cores instead
+        std::vector<u32> shared;
+        if (others > left.size()) {
+            for (const std::vector<u32>& core : left)
+                shared.insert(shared.end(), core.begin(), core.end());
+            std::sort(shared.begin(), shared.end());
+        }
+
+        u64 core = 0;
+        for (u32 worker = 0; worker < workers; ++worker) {
+            if (hasRender && worker == RENDER_THREAD_ID)
+                continue;
+
+            placement.workers[worker] = shared.empty() ? left[core++] : shared;
+        }
+
+        return placement;
+    }
+
+    bool ThreadPlacement::Apply() const {
+        bool pinned = SetCurrentThreadAffinity(main);
+
+        if (!cw::JobSystem::IsInitialized())
+            return pinned;
+
+        // Workers can only pin themselves, so each gets a job
+        const u32 count = std::min<u32>(static_cast<u32>(workers.size()), cw::JobSystem::GetNumThreads());
+        if (count == 0)
+            return pinned;
+
+        cw::JobCounter done(count);
+        std::atomic<bool> failed{false};
+
+        for (u32 worker = 0; worker < count; ++worker) {
+            auto pin = [this, worker, &done, &failed]() {
+                if (!SetCurrentThreadAffinity(workers[worker]))
+                    failed.store(true, std::memory_order_relaxed);
+                done.Decrement();
+            };
+            CW_SCHEDULE(
+                pin, cw::JobPriority::High, static_cast<cw::ThreadAffinity>(worker), cw::InvalidTag, "Pin worker");
+        }
+
+        done.Wait();
+        return pinned && !failed.load(std::memory_order_relaxed);
+    }
+
+    bool SetCurrentThreadAffinity(std::span<const u32> cpus) {
+#ifdef AX_PLATFORM_LINUX
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        if (cpus.empty()) {
+            // The kernel drops the CPUs that don't exist or aren't allowed
+            for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                CPU_SET(cpu, &set);
+        }
+
+        for (u32 cpu : cpus) {
+            if (cpu >= CPU_SETSIZE)
+                return false;
+            CPU_SET(cpu, &set);
+        }
+
+        // 0 is the calling thread
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void) cpus;
+        return false;
+#endif
+    }
+
+    std::vector<u32> GetCurrentThreadAffinity() {
+        std::vector<u32> cpus;
+
+#ifdef AX_PLATFORM_LINUX
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        if (sched_getaffinity(0, sizeof(set), &set) != 0)
+            return cpus;
+
+        for (u32 cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        }
+#endif
+
+        return cpus;
+    }
+} // namespace Axle
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "axpch.hpp"
+
+#include "Core/Core.hpp"
+#include "Core/Types.hpp"
+
+#include <span>
+
+namespace Axle {
+    /**
+     * A logical CPU as seen by the scheduler, one per hardware thread
+     * */
+    struct LogicalCpu {
+        u32 id = 0;
+        /// Logical CPUs with the same core and package are hardware threads of the same physical core
+        u32 core = 0;
+        u32 package = 0;
+        /// Lowest CPU id sharing the last level cache with this one, CPUs with the same value share it
+        u32 cacheGroup = 0;
+        /// Relative speed, the kernel's cpu_capacity or the max frequency in kHz. Only comparable within a machine,
+        /// 0 if unknown
+        u64 capacity = 0;
+    };
+
+    /**
+     * The CPUs of the machine and how they share cores and caches, read from sysfs.
+     * */
+    class AXLE_TEST_API CpuTopology {
+    public:
+        /**
+         * Reads the topology of the online CPUs.
+         *
+         * @param root The sysfs CPU directory, only changed by tests
+         * @returns The topology, empty if it couldn't be read, e.g. outside of Linux
+         * */
+        static CpuTopology Probe(const std::filesystem::path& root = "/sys/devices/system/cpu");
+
+        /**
+         * Parses a kernel CPU list like "0-3,8,10-11".
+         *
+         * @returns The CPU ids in the order they appear, empty if the list is malformed
+         * */
+        static std::vector<u32> ParseCpuList(std::string_view list);
+
+        /**
+         * Groups the logical CPUs by physical core. Faster cores go first and, among equally fast ones, cores
+         * sharing a last level cache are kept next to each other so picking from the front keeps threads close.
+         *
+         * @returns The CPU ids of every physical core
+         * */
+        std::vector<std::vector<u32>> GetCores() const;
+
+        inline const std::vector<LogicalCpu>& GetCpus() const {
+            return m_Cpus;
+        }
+
+        inline bool IsEmpty() const {
+            return m_Cpus.empty();
+        }
+
+    private:
+        std::vector<LogicalCpu> m_Cpus;
+    };
+
+    /**
+     * Which CPUs each engine thread may run on. An empty set leaves the thread free to run anywhere.
+     *
+     * The render thread and the main/update thread carry the frame, so each gets a fast physical core to itself.
+     * Job system workers get one of the remaining cores each, next to them first, so they don't bounce between
+     * cores and lose their caches. The job system's worker RENDER_THREAD_ID is the render thread.
+     * */
+    struct AXLE_TEST_API ThreadPlacement {
+        std::vector<u32> main;
+        /// Indexed by job system worker
+        std::vector<std::vector<u32>> workers;
+
+        /**
+         * Places the threads on the cores of a topology.
+         *
+         * @param topology The machine, an empty one places nothing
+         * @param workers Job system workers, including the render thread
+         * */
+        static ThreadPlacement Plan(const CpuTopology& topology, u32 workers);
+
+        /**
+         * Pins the calling thread, which must be the main thread, and every job system worker. Threads with an empty
+         * set are unpinned. Workers are pinned by a job scheduled to each of them, this waits until all of them ran, so
+         * the calling thread must not be a worker.
+         *
+         * This function is NOT thread safe, call it once after initializing the job system.
+         *
+         * @returns false if any thread couldn't be pinned
+         * */
+        bool Apply() const;
+    };
+
+    /**
+     * Restricts the calling thread to some CPUs.
+     *
+     * @param cpus The CPU ids, empty allows all of them
+     * @returns false if the system refused or it isn't supported on this platform
+     * */
+    AXLE_TEST_API bool SetCurrentThreadAffinity(std::span<const u32> cpus);
+
+    /**
+     * @returns The CPUs the calling thread may run on, empty if unknown
+     * */
+    AXLE_TEST_API std::vector<u32> GetCurrentThreadAffinity();
+} // namespace Axle
@@ -41,7 +41,4 @@ namespace Axle {
 
     // Job system defines
 #define RENDER_THREAD_ID 0
-
-#define EVENT_INPUT_TAG 0
-#define LAYERS_TAG 1
 } // namespace Axle
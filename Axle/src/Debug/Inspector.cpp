@@ -6,8 +6,10 @@
 #include "Core/Application.hpp"
 #include "Renderer/Camera/Camera.hpp"
 #include "Core/Logger/Log.hpp"
+#include "Core/Resource/ResourceManager.hpp"
 
 #include <imgui.h>
+#include <CoroWeaver.hpp>
 
 namespace Axle::Debug {
     static void HelpMarker(const char* desc) {
@@ -40,6 +42,8 @@ namespace Axle::Debug {
         // Headers
         s_Instance->CameraHeader();
         s_Instance->LogHeader();
+        s_Instance->ResourcesHeader();
+        s_Instance->JobSystemHeader();
 
         // Custom headers
         for (auto& f : s_Instance->m_Headers) {
@@ -166,4 +170,235 @@ namespace Axle::Debug {
             HelpMarker("Log a custom message. 256 characters max");
         }
     }
+
+    void Inspector::ResourcesHeader() {
+        if (ImGui::CollapsingHeader("Resources")) {
+            constexpr f32 MiB = 1024.0f * 1024.0f;
+
+            ResourceManager::ResidencyStats stats = ResourceManager::GetResidencyStats();
+            ResourceManager::FaultStats faults = ResourceManager::GetFrameFaults();
+
+            // Page faults of the render thread, kept for the last frames to spot the ones that stalled
+            static std::array<f32, 120> majorHistory{};
+            static u32 historyOffset = 0;
+            majorHistory[historyOffset] = static_cast<f32>(faults.majorFaults);
+            historyOffset = (historyOffset + 1) % majorHistory.size();
+
+            ImGui::Text("Faults last frame: %llu minor, ", static_cast<unsigned long long>(faults.minorFaults));
+            ImGui::SameLine(0.0f, 0.0f);
+            if (faults.majorFaults > 0)
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f),
+                                   "%llu major",
+                                   static_cast<unsigned long long>(faults.majorFaults));
+            else
+                ImGui::Text("0 major");
+            ImGui::SameLine();
+            HelpMarker("Page faults taken by the render thread. Major faults waited for the disk, usually the first "
+                       "touch of a mapped file that wasn't in the page cache.");
+
+            ImGui::PlotHistogram("Major faults",
+                                 majorHistory.data(),
+                                 static_cast<i32>(majorHistory.size()),
+                                 static_cast<i32>(historyOffset),
+                                 nullptr,
+                                 0.0f,
+                                 std::numeric_limits<f32>::max(),
+                                 ImVec2(0.0f, 40.0f));
+
+            ImGui::Text("Mapped: %.2f MiB", stats.residentBytes / MiB);
+            if (stats.budget != 0) {
+                ImGui::SameLine();
+                ImGui::Text("/ %.2f MiB budget", stats.budget / MiB);
+            }
+            ImGui::Text("Evictions: %llu (%.2f MiB), restores: %llu",
+                        static_cast<unsigned long long>(stats.evictions),
+                        stats.evictedBytes / MiB,
+                        static_cast<unsigned long long>(stats.restores));
+
+            // Asking the kernel costs a syscall per file, so the list is only refreshed twice a second
+            if (ImGui::TreeNode("Files")) {
+                static std::vector<ResourceManager::MappedFileInfo> files;
+                static f64 lastRefresh = -1.0;
+
+                const f64 now = ImGui::GetTime();
+                if (lastRefresh < 0.0 || now - lastRefresh > 0.5) {
+                    files = ResourceManager::GetMappedFiles();
+                    lastRefresh = now;
+                }
+
+                u64 mapped = 0, resident = 0;
+                for (const ResourceManager::MappedFileInfo& file : files) {
+                    mapped += file.mappedBytes;
+                    resident += file.residentBytes;
+                }
+                ImGui::Text("Resident: %.2f of %.2f MiB", resident / MiB, mapped / MiB);
+
+                if (ImGui::BeginTable("MappedFiles", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("File");
+                    ImGui::TableSetupColumn("Mapped KiB");
+                    ImGui::TableSetupColumn("Resident");
+                    ImGui::TableHeadersRow();
+
+                    for (const ResourceManager::MappedFileInfo& file : files) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(file.path.filename().string().c_str());
+                        ImGui::SetItemTooltip("%s", file.path.string().c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", file.mappedBytes / 1024.0f);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.0f%%",
+                                    file.mappedBytes == 0 ? 0.0f : 100.0f * file.residentBytes / file.mappedBytes);
+                    }
+
+                    ImGui::EndTable();
+                }
+
+                ImGui::TreePop();
+            }
+        }
+    }
+
+    void Inspector::JobSystemHeader() {
+        if (ImGui::CollapsingHeader("Job System")) {
+            cw::IdlePolicy policy = cw::JobSystem::GetIdlePolicy();
+            i32 spins = static_cast<i32>(policy.m_SpinIterations);
+            i32 yields = static_cast<i32>(policy.m_YieldIterations);
+
+            bool changed = ImGui::SliderInt("Spins", &spins, 0, 1024);
+            changed |= ImGui::SliderInt("Yields", &yields, 0, 256);
+            ImGui::SameLine();
+            HelpMarker("How long a worker out of jobs keeps looking for more before parking. Spinning picks new jobs "
+                       "up faster and saves the scheduler a wake-up, but keeps the core busy. Not saved to the config "
+                       "file, see spin_iterations and yield_iterations under [jobsystem].");
+            if (changed)
+                cw::JobSystem::SetIdlePolicy({static_cast<u32>(spins), static_cast<u32>(yields)});
+
+            cw::IdleStats stats = cw::JobSystem::GetIdleStats();
+
+            std::array<f32, cw::WakeLatencyBuckets> latency;
+            u64 wakes = 0;
+            for (u32 i = 0; i < cw::WakeLatencyBuckets; ++i) {
+                latency[i] = static_cast<f32>(stats.m_WakeLatency[i]);
+                wakes += stats.m_WakeLatency[i];
+            }
+
+            ImGui::Text("Spin hits: %llu, parks: %llu, wake-ups: %llu",
+                        static_cast<unsigned long long>(stats.m_SpinHits),
+                        static_cast<unsigned long long>(stats.m_Parks),
+                        static_cast<unsigned long long>(wakes));
+            ImGui::PlotHistogram("Wake latency",
+                                 latency.data(),
+                                 static_cast<i32>(latency.size()),
+                                 0,
+                                 nullptr,
+                                 0.0f,
+                                 std::numeric_limits<f32>::max(),
+                                 ImVec2(0.0f, 60.0f));
+            ImGui::SameLine();
+            HelpMarker("Time between a parked worker being notified and running again. Bar i counts the wake-ups "
+                       "that took less than 2^i microseconds, the first one under 1 us and the last one everything "
+                       "above 16 ms.");
+
+            if (ImGui::Button("Reset stats"))
+                cw::JobSystem::ResetIdleStats();
+
+            ImGui::Separator();
+
+            const cw::JobSystemStats jobStats = cw::JobSystem::GetStats();
+
+            // Share of the workers' time spent out of the idle wait, kept for the last frames to spot starvation
+            static std::array<f32, 120> busyHistory{};
+            static u32 historyOffset = 0;
+
+            u64 busy = 0, idle = 0, jobs = 0;
+            for (cw::ThreadAffinity i = 0; i < jobStats.m_WorkerCount; ++i) {
+                busy += jobStats.m_Workers[i].m_BusyNs;
+                idle += jobStats.m_Workers[i].m_IdleNs;
+                jobs += jobStats.m_Workers[i].m_JobsRun;
+            }
+            const f32 busyPercent = busy + idle == 0 ? 0.0f : 100.0f * busy / (busy + idle);
+            busyHistory[historyOffset] = busyPercent;
+            historyOffset = (historyOffset + 1) % busyHistory.size();
+
+            ImGui::Text("Busy: %.1f%%, %llu jobs last frame", busyPercent, static_cast<unsigned long long>(jobs));
+            ImGui::SameLine();
+            HelpMarker("Time the workers spent outside of the idle wait. Always close to 100% means more threads "
+                       "would help, always low means there are more than needed. Threads converted to workers, like "
+                       "the render thread, count their own work as busy too.");
+            ImGui::PlotLines("Busy %",
+                             busyHistory.data(),
+                             static_cast<i32>(busyHistory.size()),
+                             static_cast<i32>(historyOffset),
+                             nullptr,
+                             0.0f,
+                             100.0f,
+                             ImVec2(0.0f, 40.0f));
+
+            ImGui::Text("Injected: %u high, %u medium, %u low, timers: %u",
+                        jobStats.m_InjectedJobs[static_cast<u8>(cw::JobPriority::High)],
+                        jobStats.m_InjectedJobs[static_cast<u8>(cw::JobPriority::Medium)],
+                        jobStats.m_InjectedJobs[static_cast<u8>(cw::JobPriority::Low)],
+                        jobStats.m_TimerJobs);
+
+            if (ImGui::TreeNode("Workers")) {
+                if (ImGui::BeginTable("JobWorkers", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Worker");
+                    ImGui::TableSetupColumn("Busy");
+                    ImGui::TableSetupColumn("Jobs");
+                    ImGui::TableSetupColumn("Steals");
+                    ImGui::TableSetupColumn("Queued");
+                    ImGui::TableHeadersRow();
+
+                    for (cw::ThreadAffinity i = 0; i < jobStats.m_WorkerCount; ++i) {
+                        const cw::WorkerStats& worker = jobStats.m_Workers[i];
+                        const u64 total = worker.m_BusyNs + worker.m_IdleNs;
+
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", static_cast<u32>(i));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.0f%%", total == 0 ? 0.0f : 100.0f * worker.m_BusyNs / total);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%llu", static_cast<unsigned long long>(worker.m_JobsRun));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%llu", static_cast<unsigned long long>(worker.m_Steals));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", worker.m_QueuedJobs);
+                    }
+
+                    ImGui::EndTable();
+                }
+
+                ImGui::TreePop();
+            }
+
+            if (ImGui::TreeNode("Tags")) {
+                ImGui::SameLine();
+                HelpMarker("Jobs pending on each tag. Tags grow on demand, the high water column shows the most "
+                           "jobs each one ever held.");
+
+                if (ImGui::BeginTable("JobTags", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Tag");
+                    ImGui::TableSetupColumn("Pending");
+                    ImGui::TableSetupColumn("High water");
+                    ImGui::TableHeadersRow();
+
+                    for (const cw::TagStats& tag : jobStats.m_Tags) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", static_cast<u32>(tag.m_Tag));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", tag.m_PendingJobs);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", tag.m_HighWater);
+                    }
+
+                    ImGui::EndTable();
+                }
+
+                ImGui::TreePop();
+            }
+        }
+    }
 } // namespace Axle::Debug
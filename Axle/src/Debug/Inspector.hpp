@@ -28,6 +28,8 @@ namespace Axle::Debug {
     private:
         void CameraHeader();
         void LogHeader();
+        void ResourcesHeader();
+        void JobSystemHeader();
 
         static std::unique_ptr<Inspector> s_Instance;
 
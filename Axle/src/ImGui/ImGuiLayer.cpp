@@ -22,7 +22,9 @@ namespace Axle {
         Debug::Inspector::Init();
     }
 
-    void ImGuiLayer::OnAttach() {}
+    void ImGuiLayer::OnAttach() {
+        SubscribeEvents(Events::Mask);
+    }
 
     void ImGuiLayer::OnUpdate(f64 fixedDeltaTime) {}
 
@@ -93,14 +95,13 @@ namespace Axle {
     void ImGuiLayer::EndFrame() {}
 
     void ImGuiLayer::OnEvent(Event& event) {
-        EventDispatcher dispatcher(event);
-
-        dispatcher.Dispatch<KeyPressedEvent>(AX_BIND_EVENT_FN(OnKeyPressed));
-        dispatcher.Dispatch<KeyIsPressedEvent>(AX_BIND_EVENT_FN(OnKeyIsPressed));
-        dispatcher.Dispatch<KeyReleasedEvent>(AX_BIND_EVENT_FN(OnKeyReleased));
-        dispatcher.Dispatch<MouseButtonPressedEvent>(AX_BIND_EVENT_FN(OnMouseButtonPressed));
-        dispatcher.Dispatch<MouseButtonIsPressedEvent>(AX_BIND_EVENT_FN(OnMouseButtonIsPressed));
-        dispatcher.Dispatch<MouseButtonReleasedEvent>(AX_BIND_EVENT_FN(OnMouseButtonReleased));
+        Events::Dispatch(event,
+                         AX_BIND_EVENT_FN(OnKeyPressed),
+                         AX_BIND_EVENT_FN(OnKeyIsPressed),
+                         AX_BIND_EVENT_FN(OnKeyReleased),
+                         AX_BIND_EVENT_FN(OnMouseButtonPressed),
+                         AX_BIND_EVENT_FN(OnMouseButtonIsPressed),
+                         AX_BIND_EVENT_FN(OnMouseButtonReleased));
     }
 
     bool ImGuiLayer::OnKeyPressed(KeyPressedEvent& event) {
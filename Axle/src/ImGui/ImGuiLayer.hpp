@@ -30,6 +30,13 @@ namespace Axle {
         static void EndFrame();
 
     private:
+        using Events = TypedEventDispatcher<KeyPressedEvent,
+                                            KeyIsPressedEvent,
+                                            KeyReleasedEvent,
+                                            MouseButtonPressedEvent,
+                                            MouseButtonIsPressedEvent,
+                                            MouseButtonReleasedEvent>;
+
         bool OnKeyPressed(KeyPressedEvent& event);
         bool OnKeyIsPressed(KeyIsPressedEvent& event);
         bool OnKeyReleased(KeyReleasedEvent& event);
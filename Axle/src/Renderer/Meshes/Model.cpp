@@ -5,6 +5,8 @@
 #include "Renderer/Textures/Texture.hpp"
 #include "Core/Logger/Log.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
+#include "Core/Error/Result.hpp"
 
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
@@ -23,9 +25,67 @@ namespace Axle {
         LoadMaterialTextures(aiMaterial* mat, aiTextureType aiType, TextureType type, const std::string& directory);
     };
 
-    Model::Model(const std::string& path) {
+    Model::Model(const std::string& path)
+        : m_Path(path) {
         ZoneScopedN("Create model");
 
+        if (!Import(path))
+            return;
+
+        // Assimp reads the file (and the ones it references) by itself, the handle is only kept to be told when it
+        // changes on disk
+        Result<ResourceManager::ManagedFileHandle> handle = ResourceManager::Load(path);
+
+        if (handle.IsOk()) {
+            m_Handle = handle.Unwrap();
+            Watch();
+        }
+    }
+
+    Model::Model(Model&& other) noexcept
+        : m_Meshes(std::move(other.m_Meshes)),
+          m_Handle(std::move(other.m_Handle)),
+          m_Path(std::move(other.m_Path)),
+          m_Directory(std::move(other.m_Directory)) {
+        // The callback points to the moved-from object
+        if (other.m_Reload.IsActive()) {
+            other.m_Reload.Reset();
+            Watch();
+        }
+    }
+
+    Model& Model::operator=(Model&& other) noexcept {
+        if (this != &other) {
+            m_Meshes = std::move(other.m_Meshes);
+            m_Handle = std::move(other.m_Handle);
+            m_Path = std::move(other.m_Path);
+            m_Directory = std::move(other.m_Directory);
+
+            m_Reload.Reset();
+            if (other.m_Reload.IsActive()) {
+                other.m_Reload.Reset();
+                Watch();
+            }
+        }
+        return *this;
+    }
+
+    void Model::Reload() {
+        ZoneScopedN("Reload model");
+
+        std::vector<Mesh> previous = std::move(m_Meshes);
+        m_Meshes.clear();
+
+        if (!Import(m_Path)) {
+            AX_CORE_ERROR(LogChannel::Renderer, "Couldn't reload model {0}, keeping the previous meshes", m_Path);
+            m_Meshes = std::move(previous);
+            return;
+        }
+
+        AX_CORE_INFO(LogChannel::Renderer, "Reloaded model {0}", m_Path);
+    }
+
+    bool Model::Import(const std::string& path) {
         Assimp::Importer import;
         const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
 
@@ -34,7 +94,7 @@ namespace Axle {
                           "Couldn't import model from file: {0}. Error: {1}",
                           path,
                           import.GetErrorString());
-            return;
+            return false;
         }
         m_Directory = path.substr(0, path.find_last_of('/'));
 
@@ -45,6 +105,11 @@ namespace Axle {
                      scene->mRootNode->mNumChildren);
 
         InternalMethods::ProcessNode(scene->mRootNode, scene, this);
+        return true;
+    }
+
+    void Model::Watch() {
+        m_Reload = FileWatcher::Subscribe(m_Handle.Get(), [this]() { Reload(); });
     }
 
     void Model::Draw(const Ref<Shader>& shader, const glm::mat4& transform) {
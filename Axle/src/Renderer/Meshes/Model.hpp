@@ -4,6 +4,7 @@
 
 #include "Core/Types.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
 #include "Renderer/Shaders/Shader.hpp"
 #include "Mesh.hpp"
 
@@ -15,13 +16,41 @@ namespace Axle {
         Model() = default;
         Model(const std::string& path);
 
+        Model(Model&& other) noexcept;
+        Model& operator=(Model&& other) noexcept;
+
+        Model(const Model&) = delete;
+        Model& operator=(const Model&) = delete;
+
         void Draw(const Ref<Shader>& shader, const glm::mat4& transform = glm::mat4(1.0f));
 
+        /**
+         * Imports the file again and replaces the meshes in place. If it can't be imported the previous meshes are
+         * kept. It's called automatically when the file changes on disk and the FileWatcher is running.
+         * */
+        void Reload();
+
     private:
         struct InternalMethods;
 
+        /**
+         * Imports the meshes of a file into this model
+         *
+         * @param path The path to the model file
+         *
+         * @returns true if the file could be imported
+         * */
+        bool Import(const std::string& path);
+
+        /**
+         * Reloads this model whenever its file changes on disk
+         * */
+        void Watch();
+
         std::vector<Mesh> m_Meshes;
         ResourceManager::ManagedFileHandle m_Handle;
+        std::string m_Path;
         std::string m_Directory;
+        FileWatcher::Subscription m_Reload;
     };
 } // namespace Axle
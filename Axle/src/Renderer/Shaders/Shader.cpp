@@ -9,6 +9,7 @@
 #include "Core/Error/Panic.hpp"
 #include "Core/Error/Result.hpp"
 #include "Core/Logger/Log.hpp"
+#include "Core/Resource/FileWatcher.hpp"
 #include "Other/CustomTypes/Ref.hpp"
 
 #include <ShaderSource_generated.h>
@@ -85,15 +86,48 @@ namespace Axle {
         : m_Name(name) {
         ZoneScopedN("Create shader from file");
 
-        auto exp = ResourceManager::Load(filename);
+        auto exp = ResourceManager::Load(
+            filename, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Shader));
         AX_ENSURE(exp.IsOk(), LogChannel::Renderer, "Couldn't open {0} shader file", filename);
         // TODO: Put an ugly default shader if it couldn't load the file
 
         m_Handle = exp.Unwrap();
-        ResourceManager::ReadGuard readGuard = ResourceManager::DataConst(m_Handle).Unwrap();
+
+        Result<u32> program = CreateProgram();
+        AX_ENSURE(program.IsOk(), LogChannel::Renderer, "{0}", program.UnwrapErr());
+
+        m_ID = program.Unwrap();
+        Watch();
+    }
+
+    void Shader::Reload() {
+        ZoneScopedN("Reload shader");
+
+        // Built before touching the current program so a broken edit keeps the last working one on screen
+        Result<u32> program = CreateProgram();
+
+        if (program.IsErr()) {
+            AX_CORE_ERROR(LogChannel::Renderer,
+                          "Couldn't reload shader {0}, keeping the previous program. {1}",
+                          m_Name,
+                          program.UnwrapErr());
+            return;
+        }
+
+        Reset();
+        m_ID = program.Unwrap();
+
+        AX_CORE_INFO(LogChannel::Renderer, "Reloaded shader {0}", m_Name);
+    }
+
+    Result<u32> Shader::CreateProgram() const {
+        Result<ResourceManager::ReadGuard> guard = ResourceManager::DataConst(m_Handle);
+
+        if (guard.IsErr())
+            return Result<u32>::Err(guard.UnwrapErr());
 
         // Flatbuffer binary
-        const ShaderCollection* collection = GetShaderCollection(readGuard.Data());
+        const ShaderCollection* collection = GetShaderCollection(guard.Unwrap().Data());
 
         // AX_ENSURE(ShaderCollectionBufferHasIdentifier(collection),
         //           LogChannel::Renderer,
@@ -101,45 +135,63 @@ namespace Axle {
         //           filename);
         // TODO: Put an ugly default shader if it couldn't load the file
 
-        TracyGpuZone("Create shader from file");
+        TracyGpuZone("Create shader program");
 
-        m_ID = glCreateProgram();
+        const u32 id = glCreateProgram();
         std::vector<u32> shaderIDs;
 
+        // Nothing built so far is needed if the program can't be completed
+        auto discard = [&]() {
+            for (u32& shaderID : shaderIDs) {
+                AX_GL_CALL(glDeleteShader(shaderID));
+            }
+            AX_GL_CALL(glDeleteProgram(id));
+        };
+
         for (u8 i = 1; i < static_cast<u8>(ShaderType::MaxShaderTypes); ++i) {
             Result<u32> res = CompileShader(static_cast<ShaderType>(i), collection);
 
             if (res.IsOk()) {
-                AX_GL_CALL(glAttachShader(m_ID, res.Unwrap()));
+                AX_GL_CALL(glAttachShader(id, res.Unwrap()));
                 shaderIDs.push_back(res.Unwrap());
             } else if (static_cast<ShaderType>(i) == ShaderType::Vertex ||
                        static_cast<ShaderType>(i) == ShaderType::Fragment) {
-                AX_PANIC(LogChannel::Renderer, "{0}", res.UnwrapErr());
+                discard();
+                return Result<u32>::Err(res.UnwrapErr());
             } else {
                 AX_CORE_TRACE(LogChannel::Renderer, "{0}", res.UnwrapErr());
             }
         }
 
-        AX_GL_CALL(glLinkProgram(m_ID));
+        AX_GL_CALL(glLinkProgram(id));
 
 #ifdef AX_DEBUG
         // Check linking errors
         i32 success;
         char infoLog[1024];
 
-        AX_GL_CALL(glGetProgramiv(m_ID, GL_LINK_STATUS, &success));
+        AX_GL_CALL(glGetProgramiv(id, GL_LINK_STATUS, &success));
 
         if (success) {
-            AX_CORE_TRACE(LogChannel::Renderer, "Successfully linked shader program: {0}", m_ID);
+            AX_CORE_TRACE(LogChannel::Renderer, "Successfully linked shader program: {0}", id);
         } else {
-            AX_GL_CALL(glGetProgramInfoLog(m_ID, sizeof(infoLog), nullptr, infoLog));
-            AX_PANIC(LogChannel::Renderer, "Error linking program {0}. Log: {1}", m_ID, infoLog);
+            AX_GL_CALL(glGetProgramInfoLog(id, sizeof(infoLog), nullptr, infoLog));
+            discard();
+            return Result<u32>::Err(
+                Error(ErrorCode::ShaderCompileFailed,
+                      "Error linking program " + std::to_string(id) + ". Log: " + std::string(infoLog)));
         }
 #endif // AX_DEBUG
 
-        for (u32& id : shaderIDs) {
-            AX_GL_CALL(glDeleteShader(id));
+        for (u32& shaderID : shaderIDs) {
+            AX_GL_CALL(glDeleteShader(shaderID));
         }
+
+        return id;
+    }
+
+    void Shader::Watch() {
+        m_Reload = FileWatcher::Subscribe(m_Handle.Get(), [this]() { Reload(); });
     }
 
     Result<u32> Shader::CompileShader(ShaderType type, const void* source) {
@@ -218,6 +270,12 @@ namespace Axle {
           m_Handle(std::move(other.m_Handle)),
           m_Name(other.m_Name) {
         other.m_ID = 0;
+
+        // The callback points to the moved-from object
+        if (other.m_Reload.IsActive()) {
+            other.m_Reload.Reset();
+            Watch();
+        }
     }
 
     Shader& Shader::operator=(Shader&& other) noexcept {
@@ -229,6 +287,12 @@ namespace Axle {
             m_Name = other.m_Name;
 
             other.m_ID = 0;
+
+            m_Reload.Reset();
+            if (other.m_Reload.IsActive()) {
+                other.m_Reload.Reset();
+                Watch();
+            }
         }
         return *this;
     }
@@ -268,16 +332,31 @@ namespace Axle {
     }
 
     Ref<Shader> Shader::Create(const std::string& filename, const std::string& name, bool checkCached) {
+        // Loaded first to get the hash of its contents, the shader then finds it already loaded
+        ResourceManager::ManagedFileHandle handle;
+        u64 contentHash = 0;
+
         if (checkCached) {
-            Result<Ref<Shader>> res = ShaderManager::Get(filename);
-            if (res.IsOk())
-                return res.Unwrap();
+            Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(
+                filename, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Shader));
+
+            if (res.IsOk()) {
+                handle = res.Unwrap();
+                contentHash = ResourceManager::GetContentHash(handle.Get()).Unwrap();
+            }
+
+            if (contentHash != 0) {
+                Result<Ref<Shader>> cached = ShaderManager::GetByContent(contentHash);
+                if (cached.IsOk())
+                    return cached.Unwrap();
+            }
         }
 
         Ref<Shader> shader = Ref<Shader>::Create(filename, name); // strong count now 1, safely
 
-        if (checkCached)
-            ShaderManager::Add(filename, shader, true); // takes a WeakRef from an already-owned Ref
+        // takes a WeakRef from an already-owned Ref
+        if (contentHash != 0)
+            ShaderManager::AddByContent(contentHash, handle.Get(), shader);
 
         return shader;
     }
@@ -4,6 +4,7 @@
 
 #include "Core/Core.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
 #include "Core/Types.hpp"
 #include "Other/CustomTypes/Ref.hpp"
 #include "Core/Error/Result.hpp"
@@ -94,6 +95,13 @@ namespace Axle {
         void SetFloatUniform(const std::string& name, f32 value) const;
         void SetMat4Uniform(const std::string& name, const glm::mat4& value) const;
 
+        /**
+         * Builds the program again from the current contents of the file and swaps it in place, so every reference
+         * to this shader uses the new one. If it doesn't compile the previous program is kept.
+         * It's called automatically when the file changes on disk and the FileWatcher is running.
+         * */
+        void Reload();
+
     private:
         /**
          * Deallocates all used memory
@@ -110,8 +118,21 @@ namespace Axle {
          * */
         static Result<u32> CompileShader(ShaderType type, const void* source);
 
+        /**
+         * Compiles and links a new program from the loaded file
+         *
+         * @returns A result with the program id if every required stage compiled and it linked
+         * */
+        Result<u32> CreateProgram() const;
+
+        /**
+         * Reloads this shader whenever its file changes on disk
+         * */
+        void Watch();
+
         u32 m_ID = 0;
         std::string m_Name;
         ResourceManager::ManagedFileHandle m_Handle;
+        FileWatcher::Subscription m_Reload;
     };
 } // namespace Axle
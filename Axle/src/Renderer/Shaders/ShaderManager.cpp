@@ -4,6 +4,7 @@
 #include "Core/Error/Error.hpp"
 #include "Core/Error/Result.hpp"
 #include "Core/Logger/Log.hpp"
+#include "Core/Resource/ResourceManager.hpp"
 #include "Other/CustomTypes/Ref.hpp"
 #include "Renderer/Shaders/Shader.hpp"
 
@@ -39,6 +40,25 @@ namespace Axle {
         return Result<Ref<Shader>>::Err(Error(ErrorCode::NotFound, "Shader with name " + name + " is not cached"));
     }
 
+    Result<Ref<Shader>> ShaderManager::GetByContentImpl(u64 contentHash) {
+        auto found = m_ShadersByContent.find(contentHash);
+
+        if (found != m_ShadersByContent.end()) {
+            // The hash only changes when the file is reloaded, the shader then follows the new contents. The handle is
+            // only valid while the shader is alive.
+            if (!found->second.shader.Expired()) {
+                Result<u64> current = ResourceManager::GetContentHash(found->second.handle);
+
+                if (current.IsOk() && current.Unwrap() == contentHash)
+                    return found->second.shader.Lock();
+            }
+
+            m_ShadersByContent.erase(found);
+        }
+
+        return Result<Ref<Shader>>::Err(Error(ErrorCode::NotFound, "Shader is not cached"));
+    }
+
     void ShaderManager::AddImpl(const std::string& name, const Ref<Shader>& shader, bool onlyCache) {
         if (onlyCache)
             m_ShadersWeak[name] = WeakRef<Shader>(shader);
@@ -9,7 +9,9 @@
 
 namespace Axle {
     /**
-     * This manager ensures that no shader program is compiled/linked more times than necessary by caching.
+     * This manager ensures that no shader program is compiled/linked more times than necessary by caching. Shaders
+     * created from files are cached by the hash of their contents (see ResourceManager::GetContentHash), so identical
+     * files under different paths share a single program.
      *
      * All the functionality of this class is NOT THREAD SAFE and must only be accessed by the render thread.
      * */
@@ -68,6 +70,28 @@ namespace Axle {
             return s_Instance->AddImpl(name, shader, onlyCache);
         }
 
+        /**
+         * Gets a cached shader by the contents of its file
+         *
+         * @param contentHash Hash of the contents of the shader file
+         *
+         * @returns A Result containing a shader reference if a live shader was created from those contents
+         * */
+        inline static Result<Ref<Shader>> GetByContent(u64 contentHash) {
+            return s_Instance->GetByContentImpl(contentHash);
+        }
+
+        /**
+         * Caches a shader by the contents of its file, only a weak reference is kept
+         *
+         * @param contentHash Hash of the contents of the shader file, must not be 0
+         * @param handle The handle of the shader file, used to notice when it's reloaded with other contents
+         * @param shader A reference to the shader to cache
+         * */
+        inline static void AddByContent(u64 contentHash, FileHandle handle, const Ref<Shader>& shader) {
+            s_Instance->m_ShadersByContent[contentHash] = {WeakRef<Shader>(shader), handle};
+        }
+
         /**
          * Loads a shader and automatically addes it for future use
          *
@@ -96,11 +120,19 @@ namespace Axle {
     private:
         // Static methods' implementations
         Result<Ref<Shader>> GetImpl(const std::string& name);
+        Result<Ref<Shader>> GetByContentImpl(u64 contentHash);
         void AddImpl(const std::string& name, const Ref<Shader>& shader, bool onlyCache);
         Ref<Shader> LoadImpl(const std::string& name, const std::string& path, bool onlyCache);
 
+        struct CachedShader {
+            WeakRef<Shader> shader;
+            /// Kept valid by the shader's own reference to the file while the shader is alive
+            FileHandle handle;
+        };
+
         static std::unique_ptr<ShaderManager> s_Instance;
 
+        std::unordered_map<u64, CachedShader> m_ShadersByContent;
         std::unordered_map<std::string, WeakRef<Shader>> m_ShadersWeak;
         std::unordered_map<std::string, Ref<Shader>> m_ShadersStrong;
     };
@@ -9,6 +9,7 @@
 #include "Core/Error/Result.hpp"
 #include "Core/Logger/Log.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
 #include "Renderer/Textures/TextureManager.hpp"
 
 #include <stb_image.h>
@@ -124,33 +125,68 @@ namespace Axle {
     }
 
     Texture2D::Texture2D(const std::string& path, i32 mipmaps, bool flipVertically, TextureType type)
-        : m_Type(type) {
+        : m_Type(type),
+          m_Mipmaps(mipmaps),
+          m_FlipVertically(flipVertically) {
         ZoneScopedN("Create texture with source");
 
-        Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(path);
+        Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(
+            path, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Texture));
 
         AX_ENSURE(res.IsOk(), LogChannel::Renderer, "Couldn't load texture: {0}", path);
         // TODO: Default to an ugly texture if it couldn't load it
 
         m_Handle = res.Unwrap();
-        ResourceManager::ReadGuard readGuard = ResourceManager::DataConst(m_Handle).Unwrap();
+
+        Result<u32> texture = CreateFromFile();
+        AX_ENSURE(texture.IsOk(), LogChannel::Renderer, "{0}: {1}", texture.UnwrapErr(), path);
+        // TODO: Default to an ugly texture if it couldn't load it
+
+        m_ID = texture.Unwrap();
+        Watch();
+    }
+
+    void Texture2D::Reload() {
+        ZoneScopedN("Reload texture");
+
+        const std::string path = ResourceManager::GetPath(m_Handle).Unwrap().string();
+
+        // Decoded before touching the current texture so a broken file keeps the last working one on screen
+        Result<u32> texture = CreateFromFile();
+
+        if (texture.IsErr()) {
+            AX_CORE_ERROR(LogChannel::Renderer,
+                          "Couldn't reload texture {0}, keeping the previous one. {1}",
+                          path,
+                          texture.UnwrapErr());
+            return;
+        }
+
+        Reset();
+        m_ID = texture.Unwrap();
+
+        AX_CORE_INFO(LogChannel::Renderer, "Reloaded texture {0}", path);
+    }
+
+    Result<u32> Texture2D::CreateFromFile() {
+        Result<ResourceManager::ReadGuard> guard = ResourceManager::DataConst(m_Handle);
+
+        if (guard.IsErr())
+            return Result<u32>::Err(guard.UnwrapErr());
 
         i32 width, height, nrChannels;
         // Inerpret loaded data
-        stbi_set_flip_vertically_on_load(flipVertically);
-        u8* data = stbi_load_from_memory(reinterpret_cast<const u8*>(readGuard.Data()),
-                                         static_cast<i32>(readGuard.Size()),
+        stbi_set_flip_vertically_on_load(m_FlipVertically);
+        u8* data = stbi_load_from_memory(reinterpret_cast<const u8*>(guard.Unwrap().Data()),
+                                         static_cast<i32>(guard.Unwrap().Size()),
                                          &width,
                                          &height,
                                          &nrChannels,
                                          0);
         stbi_set_flip_vertically_on_load(false);
 
-        AX_ENSURE(data != nullptr, LogChannel::Renderer, "Error interpreting image of file: {0}", path);
-        // TODO: Default to an ugly texture if it couldn't load it
-
-        m_Width = static_cast<u32>(width);
-        m_Height = static_cast<u32>(height);
+        if (data == nullptr)
+            return Result<u32>::Err(Error(ErrorCode::AssetLoadFailed, "Error interpreting image of file"));
 
         // Detect format automatically
         GLenum internalFormat;
@@ -165,42 +201,67 @@ namespace Axle {
             internalFormat = GL_RGBA8;
             dataFormat = GL_RGBA;
         } else {
-            AX_PANIC(LogChannel::Renderer, "Image format not supported");
+            stbi_image_free(data);
+            return Result<u32>::Err(Error(ErrorCode::AssetLoadFailed, "Image format not supported"));
         }
 
+        m_Width = static_cast<u32>(width);
+        m_Height = static_cast<u32>(height);
+
         TracyGpuZone("Create texture");
 
         // OpenGL stuff
-        AX_GL_CALL(glCreateTextures(GL_TEXTURE_2D, 1, &m_ID));
-        AX_GL_CALL(glTextureStorage2D(m_ID,
-                                      (mipmaps < 0) ? 1 + CalculateMipmaps(m_Width, m_Height) : 1 + mipmaps,
+        u32 id;
+        AX_GL_CALL(glCreateTextures(GL_TEXTURE_2D, 1, &id));
+        AX_GL_CALL(glTextureStorage2D(id,
+                                      (m_Mipmaps < 0) ? 1 + CalculateMipmaps(m_Width, m_Height) : 1 + m_Mipmaps,
                                       internalFormat,
                                       m_Width,
                                       m_Height));
 
         // Set default parameters
-        AX_GL_CALL(glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, GL_REPEAT));
-        AX_GL_CALL(glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, GL_REPEAT));
-        AX_GL_CALL(glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
-        AX_GL_CALL(glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        AX_GL_CALL(glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_REPEAT));
+        AX_GL_CALL(glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_REPEAT));
+        AX_GL_CALL(glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+        AX_GL_CALL(glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 
-        AX_GL_CALL(glTextureSubImage2D(m_ID, 0, 0, 0, m_Width, m_Height, dataFormat, GL_UNSIGNED_BYTE, data));
-        AX_GL_CALL(glGenerateTextureMipmap(m_ID));
+        AX_GL_CALL(glTextureSubImage2D(id, 0, 0, 0, m_Width, m_Height, dataFormat, GL_UNSIGNED_BYTE, data));
+        AX_GL_CALL(glGenerateTextureMipmap(id));
 
         stbi_image_free(data);
+        return id;
+    }
+
+    void Texture2D::Watch() {
+        m_Reload = FileWatcher::Subscribe(m_Handle.Get(), [this]() { Reload(); });
     }
 
     Ref<Texture2D> Texture2D::Create(const std::string& filename, i32 mipmaps, TextureType type, bool checkCached) {
+        // Loaded first to get the hash of its contents, the texture then finds it already loaded
+        ResourceManager::ManagedFileHandle handle;
+        u64 contentHash = 0;
+
         if (checkCached) {
-            Result<Ref<Texture2D>> res = TextureManager::IsCached2D(filename);
-            if (res.IsOk())
-                return res.Unwrap();
+            Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(
+                filename, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Texture));
+
+            if (res.IsOk()) {
+                handle = res.Unwrap();
+                contentHash = ResourceManager::GetContentHash(handle.Get()).Unwrap();
+            }
+
+            if (contentHash != 0) {
+                Result<Ref<Texture2D>> cached = TextureManager::IsCached2D(contentHash);
+                if (cached.IsOk())
+                    return cached.Unwrap();
+            }
         }
 
         Ref<Texture2D> tex = Ref<Texture2D>::Create(filename, mipmaps, true, type); // strong count now 1, safely
 
-        if (checkCached)
-            TextureManager::Cache2D(filename, tex); // takes a WeakRef from an already-owned Ref
+        // takes a WeakRef from an already-owned Ref
+        if (contentHash != 0)
+            TextureManager::Cache2D(contentHash, handle.Get(), tex);
 
         return tex;
     }
@@ -213,8 +274,17 @@ namespace Axle {
         : m_ID(other.m_ID),
           m_Width(other.m_Width),
           m_Height(other.m_Height),
-          m_Handle(std::move(other.m_Handle)) {
+          m_Handle(std::move(other.m_Handle)),
+          m_Type(other.m_Type),
+          m_Mipmaps(other.m_Mipmaps),
+          m_FlipVertically(other.m_FlipVertically) {
         other.m_ID = 0;
+
+        // The callback points to the moved-from object
+        if (other.m_Reload.IsActive()) {
+            other.m_Reload.Reset();
+            Watch();
+        }
     }
 
     Texture2D& Texture2D::operator=(Texture2D&& other) noexcept {
@@ -225,8 +295,17 @@ namespace Axle {
             m_Width = other.m_Width;
             m_Height = other.m_Height;
             m_Handle = std::move(other.m_Handle);
+            m_Type = other.m_Type;
+            m_Mipmaps = other.m_Mipmaps;
+            m_FlipVertically = other.m_FlipVertically;
 
             other.m_ID = 0;
+
+            m_Reload.Reset();
+            if (other.m_Reload.IsActive()) {
+                other.m_Reload.Reset();
+                Watch();
+            }
         }
         return *this;
     }
@@ -245,36 +324,74 @@ namespace Axle {
     // Texture Cubemap
     // --------------
 
-    TextureCubemap::TextureCubemap(const std::string& path, bool flipVertically) {
+    TextureCubemap::TextureCubemap(const std::string& path, bool flipVertically)
+        : m_FlipVertically(flipVertically) {
         ZoneScopedN("Create cubemap texture");
 
         // Load data
-        Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(path);
+        Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(
+            path, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Texture));
 
         AX_ENSURE(res.IsOk(), LogChannel::Renderer, "Couldn't load texture: {0}", path);
         // TODO: Default to an ugly texture if it couldn't load it
 
         m_Handle = res.Unwrap();
-        ResourceManager::ReadGuard readGuard = ResourceManager::DataConst(m_Handle).Unwrap();
+
+        Result<u32> texture = CreateFromFile();
+        AX_ENSURE(texture.IsOk(), LogChannel::Renderer, "{0}: {1}", texture.UnwrapErr(), path);
+        // TODO: Default to an ugly texture if it couldn't load it
+
+        m_ID = texture.Unwrap();
+        Watch();
+    }
+
+    void TextureCubemap::Reload() {
+        ZoneScopedN("Reload cubemap texture");
+
+        const std::string path = ResourceManager::GetPath(m_Handle).Unwrap().string();
+
+        // Decoded before touching the current texture so a broken file keeps the last working one on screen
+        Result<u32> texture = CreateFromFile();
+
+        if (texture.IsErr()) {
+            AX_CORE_ERROR(LogChannel::Renderer,
+                          "Couldn't reload cubemap texture {0}, keeping the previous one. {1}",
+                          path,
+                          texture.UnwrapErr());
+            return;
+        }
+
+        Reset();
+        m_ID = texture.Unwrap();
+
+        AX_CORE_INFO(LogChannel::Renderer, "Reloaded cubemap texture {0}", path);
+    }
+
+    Result<u32> TextureCubemap::CreateFromFile() {
+        Result<ResourceManager::ReadGuard> guard = ResourceManager::DataConst(m_Handle);
+
+        if (guard.IsErr())
+            return Result<u32>::Err(guard.UnwrapErr());
 
         i32 width, height, nrChannels;
         // Inerpret loaded data
-        stbi_set_flip_vertically_on_load(flipVertically);
-        u8* data = stbi_load_from_memory(reinterpret_cast<const u8*>(readGuard.Data()),
-                                         static_cast<i32>(readGuard.Size()),
+        stbi_set_flip_vertically_on_load(m_FlipVertically);
+        u8* data = stbi_load_from_memory(reinterpret_cast<const u8*>(guard.Unwrap().Data()),
+                                         static_cast<i32>(guard.Unwrap().Size()),
                                          &width,
                                          &height,
                                          &nrChannels,
                                          0);
         stbi_set_flip_vertically_on_load(false);
 
-        AX_ENSURE(data != nullptr, LogChannel::Renderer, "Error interpreting image of file: {0}", path);
-        // TODO: Default to an ugly texture if it couldn't load it
+        if (data == nullptr)
+            return Result<u32>::Err(Error(ErrorCode::AssetLoadFailed, "Error interpreting image of file"));
 
-        m_Width = static_cast<u32>(width);
-        m_Height = static_cast<u32>(height);
+        if (width / 4 != height / 3) {
+            stbi_image_free(data);
+            return Result<u32>::Err(Error(ErrorCode::AssetLoadFailed, "Texture is not valid as a cubemap texture"));
+        }
 
-        AX_ASSERT(width / 4 == height / 3, LogChannel::Renderer, "Texture is not valid as a cubemap texture");
         const i32 faceWidth = width / 4;
 
         // Detect format automatically
@@ -290,14 +407,19 @@ namespace Axle {
             internalFormat = GL_RGBA8;
             dataFormat = GL_RGBA;
         } else {
-            AX_PANIC(LogChannel::Renderer, "Image format not supported");
+            stbi_image_free(data);
+            return Result<u32>::Err(Error(ErrorCode::AssetLoadFailed, "Image format not supported"));
         }
 
+        m_Width = static_cast<u32>(width);
+        m_Height = static_cast<u32>(height);
+
         // OpenGL sutuff
         TracyGpuZone("Create texture cubemap");
 
-        AX_GL_CALL(glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_ID));
-        AX_GL_CALL(glTextureStorage2D(m_ID, 1, internalFormat, faceWidth, faceWidth));
+        u32 id;
+        AX_GL_CALL(glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &id));
+        AX_GL_CALL(glTextureStorage2D(id, 1, internalFormat, faceWidth, faceWidth));
 
         // Store space for one face of the cubemap
         std::vector<u8> faceBuf(faceWidth * faceWidth * nrChannels);
@@ -307,30 +429,50 @@ namespace Axle {
             const i32 faceIndex = f.target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
 
             AX_GL_CALL(glTextureSubImage3D(
-                m_ID, 0, 0, 0, faceIndex, faceWidth, faceWidth, 1, dataFormat, GL_UNSIGNED_BYTE, faceBuf.data()));
+                id, 0, 0, 0, faceIndex, faceWidth, faceWidth, 1, dataFormat, GL_UNSIGNED_BYTE, faceBuf.data()));
         }
 
         // Default options for test purposes
-        glTextureParameteri(m_ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTextureParameteri(m_ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_ID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(id, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
         stbi_image_free(data);
+        return id;
+    }
+
+    void TextureCubemap::Watch() {
+        m_Reload = FileWatcher::Subscribe(m_Handle.Get(), [this]() { Reload(); });
     }
 
     Ref<TextureCubemap> TextureCubemap::Create(const std::string& filename, bool checkCached) {
+        // Loaded first to get the hash of its contents, the texture then finds it already loaded
+        ResourceManager::ManagedFileHandle handle;
+        u64 contentHash = 0;
+
         if (checkCached) {
-            Result<Ref<TextureCubemap>> res = TextureManager::IsCachedCubemap(filename);
-            if (res.IsOk())
-                return res.Unwrap();
+            Result<ResourceManager::ManagedFileHandle> res = ResourceManager::Load(
+                filename, ResourceManager::LoadOptions::For(ResourceManager::AssetType::Texture));
+
+            if (res.IsOk()) {
+                handle = res.Unwrap();
+                contentHash = ResourceManager::GetContentHash(handle.Get()).Unwrap();
+            }
+
+            if (contentHash != 0) {
+                Result<Ref<TextureCubemap>> cached = TextureManager::IsCachedCubemap(contentHash);
+                if (cached.IsOk())
+                    return cached.Unwrap();
+            }
         }
 
         Ref<TextureCubemap> tex = Ref<TextureCubemap>::Create(filename); // strong count now 1, safely
 
-        if (checkCached)
-            TextureManager::CacheCubemap(filename, tex); // takes a WeakRef from an already-owned Ref
+        // takes a WeakRef from an already-owned Ref
+        if (contentHash != 0)
+            TextureManager::CacheCubemap(contentHash, handle.Get(), tex);
 
         return tex;
     }
@@ -343,8 +485,16 @@ namespace Axle {
         : m_ID(other.m_ID),
           m_Width(other.m_Width),
           m_Height(other.m_Height),
-          m_Handle(std::move(other.m_Handle)) {
+          m_Handle(std::move(other.m_Handle)),
+          m_Type(other.m_Type),
+          m_FlipVertically(other.m_FlipVertically) {
         other.m_ID = 0;
+
+        // The callback points to the moved-from object
+        if (other.m_Reload.IsActive()) {
+            other.m_Reload.Reset();
+            Watch();
+        }
     }
 
     TextureCubemap& TextureCubemap::operator=(TextureCubemap&& other) noexcept {
@@ -355,8 +505,16 @@ namespace Axle {
             m_Width = other.m_Width;
             m_Height = other.m_Height;
             m_Handle = std::move(other.m_Handle);
+            m_Type = other.m_Type;
+            m_FlipVertically = other.m_FlipVertically;
 
             other.m_ID = 0;
+
+            m_Reload.Reset();
+            if (other.m_Reload.IsActive()) {
+                other.m_Reload.Reset();
+                Watch();
+            }
         }
         return *this;
     }
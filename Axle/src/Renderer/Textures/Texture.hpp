@@ -5,6 +5,8 @@
 #include "Core/Types.hpp"
 #include "Other/CustomTypes/Ref.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
+#include "Core/Error/Result.hpp"
 
 namespace Axle {
     enum class TextureWrapMode { Repeat = 0, MirroredRepeat, ClampToEdge, ClampToBorder };
@@ -150,17 +152,41 @@ namespace Axle {
 
         virtual void Bind(u32 textureUnit) const override;
 
+        /**
+         * Decodes the file again and swaps the new texture in place, so every reference to this texture samples the
+         * new one. If it can't be decoded the previous texture is kept.
+         * It's called automatically when the file changes on disk and the FileWatcher is running.
+         * */
+        void Reload();
+
     private:
         /**
          * Deallocates all used memory
          * */
         void Reset();
 
+        /**
+         * Decodes the loaded file into a new texture and updates the size
+         *
+         * @returns A result with the texture id if the image could be decoded
+         * */
+        Result<u32> CreateFromFile();
+
+        /**
+         * Reloads this texture whenever its file changes on disk
+         * */
+        void Watch();
+
         u32 m_ID = 0;
         u32 m_Width = 0, m_Height = 0;
         ResourceManager::ManagedFileHandle m_Handle;
 
         TextureType m_Type = TextureType::Unknown;
+
+        // Kept to build the texture the same way when the file is reloaded
+        i32 m_Mipmaps = 0;
+        bool m_FlipVertically = true;
+        FileWatcher::Subscription m_Reload;
     };
 
     class TextureCubemap : public Texture {
@@ -216,16 +242,39 @@ namespace Axle {
 
         virtual void Bind(u32 textureUnit) const override;
 
+        /**
+         * Decodes the file again and swaps the new texture in place, so every reference to this texture samples the
+         * new one. If it can't be decoded the previous texture is kept.
+         * It's called automatically when the file changes on disk and the FileWatcher is running.
+         * */
+        void Reload();
+
     private:
         /**
          * Deallocates all used memory
          * */
         void Reset();
 
+        /**
+         * Decodes the loaded file into a new texture and updates the size
+         *
+         * @returns A result with the texture id if the image could be decoded
+         * */
+        Result<u32> CreateFromFile();
+
+        /**
+         * Reloads this texture whenever its file changes on disk
+         * */
+        void Watch();
+
         u32 m_ID = 0;
         u32 m_Width = 0, m_Height = 0;
         ResourceManager::ManagedFileHandle m_Handle;
 
         TextureType m_Type = TextureType::Unknown;
+
+        // Kept to build the texture the same way when the file is reloaded
+        bool m_FlipVertically = false;
+        FileWatcher::Subscription m_Reload;
     };
 } // namespace Axle
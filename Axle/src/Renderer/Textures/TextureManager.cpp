@@ -7,6 +7,7 @@
 #include "Core/Logger/Log.hpp"
 #include "Core/Error/Result.hpp"
 #include "Renderer/Textures/Texture.hpp"
+#include "Core/Resource/ResourceManager.hpp"
 #include "Renderer/GLDebug.hpp"
 
 #include <tracy/Tracy.hpp>
@@ -27,44 +28,40 @@ namespace Axle {
         AX_CORE_INFO(LogChannel::Renderer, "Texture manager deleted");
     }
 
-    Result<Ref<Texture2D>> TextureManager::IsCached2D(const std::string& filename) {
-        auto found = s_Instance->m_Texture2Ds.find(filename);
+    template <typename T>
+    Result<Ref<T>> TextureManager::Find(std::unordered_map<u64, CachedTexture<T>>& cache, u64 contentHash) {
+        auto found = cache.find(contentHash);
 
-        if (found != s_Instance->m_Texture2Ds.end()) {
-            if (found->second.Expired()) {
-                s_Instance->m_Texture2Ds.erase(found);
-                return Result<Ref<Texture2D>>::Err(
-                    Error(ErrorCode::NotFound, "Shader with file " + filename + " is not cached"));
-            } else
-                return found->second.Lock();
+        if (found != cache.end()) {
+            // The hash only changes when the file is reloaded, the texture then follows the new contents. The handle
+            // is only valid while the texture is alive.
+            if (!found->second.texture.Expired()) {
+                Result<u64> current = ResourceManager::GetContentHash(found->second.handle);
+
+                if (current.IsOk() && current.Unwrap() == contentHash)
+                    return found->second.texture.Lock();
+            }
+
+            cache.erase(found);
         }
 
-        return Result<Ref<Texture2D>>::Err(
-            Error(ErrorCode::NotFound, "Shader with file " + filename + " is not cached"));
+        return Result<Ref<T>>::Err(Error(ErrorCode::NotFound, "Texture is not cached"));
     }
 
-    Result<Ref<TextureCubemap>> TextureManager::IsCachedCubemap(const std::string& filename) {
-        auto found = s_Instance->m_TextureCubemaps.find(filename);
-
-        if (found != s_Instance->m_TextureCubemaps.end()) {
-            if (found->second.Expired()) {
-                s_Instance->m_TextureCubemaps.erase(found);
-                return Result<Ref<TextureCubemap>>::Err(
-                    Error(ErrorCode::NotFound, "Shader with file " + filename + " is not cached"));
-            } else
-                return found->second.Lock();
-        }
+    Result<Ref<Texture2D>> TextureManager::IsCached2D(u64 contentHash) {
+        return Find(s_Instance->m_Texture2Ds, contentHash);
+    }
 
-        return Result<Ref<TextureCubemap>>::Err(
-            Error(ErrorCode::NotFound, "Shader with file " + filename + " is not cached"));
+    Result<Ref<TextureCubemap>> TextureManager::IsCachedCubemap(u64 contentHash) {
+        return Find(s_Instance->m_TextureCubemaps, contentHash);
     }
 
-    void TextureManager::Cache2D(const std::string& filename, const Ref<Texture2D>& texture) {
-        s_Instance->m_Texture2Ds[filename] = WeakRef<Texture2D>(texture);
+    void TextureManager::Cache2D(u64 contentHash, FileHandle handle, const Ref<Texture2D>& texture) {
+        s_Instance->m_Texture2Ds[contentHash] = {WeakRef<Texture2D>(texture), handle};
     }
 
-    void TextureManager::CacheCubemap(const std::string& filename, const Ref<TextureCubemap>& texture) {
-        s_Instance->m_TextureCubemaps[filename] = WeakRef<TextureCubemap>(texture);
+    void TextureManager::CacheCubemap(u64 contentHash, FileHandle handle, const Ref<TextureCubemap>& texture) {
+        s_Instance->m_TextureCubemaps[contentHash] = {WeakRef<TextureCubemap>(texture), handle};
     }
 
 } // namespace Axle
@@ -3,12 +3,14 @@
 #include "axpch.hpp"
 
 #include "Texture.hpp"
+#include "Core/Types.hpp"
 #include "Other/CustomTypes/Ref.hpp"
 #include "Core/Error/Result.hpp"
 
 namespace Axle {
     /**
-     * Manages the texture caching of the renderer
+     * Manages the texture caching of the renderer. Textures are keyed by the hash of the contents of their file (see
+     * ResourceManager::GetContentHash), so byte-identical files under different paths share a single GPU texture.
      *
      * ALL the functionality of this class is NOT THREAD SAFE and must only be called from the renderer thread. Loadings
      * are planned to be pararelized but it's currently not in effect
@@ -34,41 +36,61 @@ namespace Axle {
         /**
          * Checks wether a texture2D is cached or not
          *
-         * @param filename Path to the desired texture
+         * @param contentHash Hash of the contents of the desired texture's file
          *
          * @returns A result that contains a reference to a cached texture if the request succeedes
          * */
-        static Result<Ref<Texture2D>> IsCached2D(const std::string& filename);
+        static Result<Ref<Texture2D>> IsCached2D(u64 contentHash);
 
         /**
          * Checks wether a texture cubemap is cached or not
          *
-         * @param filename Path to the desired texture cubemap
+         * @param contentHash Hash of the contents of the desired texture cubemap's file
          *
          * @returns A result that contains a reference to a cached texture if the request succeedes
          * */
-        static Result<Ref<TextureCubemap>> IsCachedCubemap(const std::string& filename);
+        static Result<Ref<TextureCubemap>> IsCachedCubemap(u64 contentHash);
 
         /**
          * Caches a texture2D
          *
-         * @param filename Path of the texture to cache
-         * @param shader Counted reference to the texture to cache
+         * @param contentHash Hash of the contents of the texture's file, must not be 0
+         * @param handle The handle of the texture's file, used to notice when it's reloaded with other contents
+         * @param texture Counted reference to the texture to cache
          * */
-        static void Cache2D(const std::string& filename, const Ref<Texture2D>& texture);
+        static void Cache2D(u64 contentHash, FileHandle handle, const Ref<Texture2D>& texture);
 
         /**
          * Caches a texture cubemap
          *
-         * @param filename Path of the texture to cache
-         * @param shader Counted reference to the texture to cache
+         * @param contentHash Hash of the contents of the texture's file, must not be 0
+         * @param handle The handle of the texture's file, used to notice when it's reloaded with other contents
+         * @param texture Counted reference to the texture to cache
          * */
-        static void CacheCubemap(const std::string& filename, const Ref<TextureCubemap>& texture);
+        static void CacheCubemap(u64 contentHash, FileHandle handle, const Ref<TextureCubemap>& texture);
 
     private:
+        template <typename T>
+        struct CachedTexture {
+            WeakRef<T> texture;
+            /// Kept valid by the texture's own reference to the file while the texture is alive
+            FileHandle handle;
+        };
+
+        /**
+         * Looks a texture up and drops its entry if it's dead or its file no longer has the same contents
+         *
+         * @param cache The cache to look in
+         * @param contentHash Hash of the contents of the texture's file
+         *
+         * @returns A result that contains a reference to the cached texture if it's still valid
+         * */
+        template <typename T>
+        static Result<Ref<T>> Find(std::unordered_map<u64, CachedTexture<T>>& cache, u64 contentHash);
+
         static std::unique_ptr<TextureManager> s_Instance;
 
-        std::unordered_map<std::string, WeakRef<Texture2D>> m_Texture2Ds;
-        std::unordered_map<std::string, WeakRef<TextureCubemap>> m_TextureCubemaps;
+        std::unordered_map<u64, CachedTexture<Texture2D>> m_Texture2Ds;
+        std::unordered_map<u64, CachedTexture<TextureCubemap>> m_TextureCubemaps;
     };
 } // namespace Axle
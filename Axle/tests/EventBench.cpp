@@ -0,0 +1,157 @@
+#include <doctest.h>
+
+#include "Core/Types.hpp"
+#include "Core/Events/Event.hpp"
+#include "Core/Events/EventHandler.hpp"
+#include "Core/Layer/Layer.hpp"
+#include "Core/Layer/LayerStack.hpp"
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <chrono>
+#include <vector>
+
+// Benchmarks are skipped by default, run them with: AxleTests --no-skip --test-case="*Bench*"
+
+using namespace Axle;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Reads the event like an input layer would, without ever handling it
+    class BenchLayer : public Layer {
+    public:
+        explicit BenchLayer(EventMask mask = AllEvents)
+            : Layer("Bench layer") {
+            SubscribeEvents(mask);
+        }
+
+        void OnAttach() override {}
+        void OnDettach() override {}
+        void OnAttachRender() override {}
+        void OnDettachRender() override {}
+        void OnUpdate(f64) override {}
+        void OnRender(f64) override {}
+
+        void OnEvent(Event& event) override {
+            EventDispatcher dispatcher(event);
+            dispatcher.Dispatch<MouseMovedEvent>([this](MouseMovedEvent& moved) {
+                m_Sum += moved.GetX() + moved.GetY();
+                return false;
+            });
+            // Engine layers usually look for a few types
+            dispatcher.Dispatch<KeyPressedEvent>([](KeyPressedEvent&) { return false; });
+            dispatcher.Dispatch<WindowResizeEvent>([](WindowResizeEvent&) { return false; });
+        }
+
+    private:
+        f64 m_Sum = 0.0;
+    };
+
+    void SubmitFrame(u32 events) {
+        for (u32 i = 0; i < events; ++i)
+            AX_SUBMIT_EVENT(MouseMovedEvent(static_cast<f32>(i), 1.0f));
+    }
+} // namespace
+
+TEST_CASE("Event Bench - Batched dispatch against a job per event" * doctest::skip()) {
+    constexpr u32 Events = 10'000;
+    constexpr u32 Frames = 50;
+    constexpr u32 Layers = 4;
+
+    EventHandler::Init();
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(3, "Bench worker");
+
+        LayerStack stack;
+        for (u32 i = 0; i < Layers; ++i)
+            stack.PushLayer(new BenchLayer());
+
+        // What ProcessEvents did before batching: a job per event walking every layer, waited on as a whole
+        f64 perEventUs = 0.0;
+        {
+            std::vector<MouseMovedEvent> events;
+            events.reserve(Events);
+
+            Clock::time_point start = Clock::now();
+            for (u32 frame = 0; frame < Frames; ++frame) {
+                events.clear();
+                for (u32 i = 0; i < Events; ++i)
+                    events.emplace_back(static_cast<f32>(i), 1.0f);
+
+                cw::JobCounter done(Events);
+                for (MouseMovedEvent& event : events) {
+                    auto notify = [&stack, &event, &done]() {
+                        for (auto it = stack.rbegin(); it != stack.rend() && !event.IsHandled(); ++it)
+                            (*it)->OnEvent(event);
+                        done.Decrement();
+                    };
+                    CW_SCHEDULE(notify, cw::JobPriority::Medium, cw::InvalidThreadIndex, cw::InvalidTag, "Bench event");
+                }
+                done.Wait();
+            }
+            perEventUs = std::chrono::duration<f64, std::micro>(Clock::now() - start).count() / Frames;
+        }
+
+        MESSAGE(Events << " events, " << Layers << " layers");
+        MESSAGE("Job per event: " << perEventUs << " us per frame");
+
+        for (u32 fanOut : {1u, 2u, 4u, 8u}) {
+            EventHandler::SetFanOut(fanOut);
+
+            Clock::time_point start = Clock::now();
+            for (u32 frame = 0; frame < Frames; ++frame) {
+                SubmitFrame(Events);
+                // This thread isn't a worker, it blocks instead of awaiting
+                EventHandler::ProcessEvents(stack.rbegin(), stack.rend()).m_Counter.Wait();
+            }
+            const f64 batchedUs = std::chrono::duration<f64, std::micro>(Clock::now() - start).count() / Frames;
+
+            MESSAGE("Batched, fan-out " << fanOut << ": " << batchedUs << " us per frame");
+        }
+    }
+
+    cw::JobSystem::Shutdown();
+    EventHandler::ShutDown();
+}
+
+TEST_CASE("Event Bench - Dozens of layers with and without subscriptions" * doctest::skip()) {
+    constexpr u32 Events = 10'000;
+    constexpr u32 Frames = 50;
+    constexpr u32 Layers = 32;
+    // Layers interested in mouse movement, the rest only want window events
+    constexpr u32 Listeners = 2;
+
+    EventHandler::Init();
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(3, "Bench worker");
+        EventHandler::SetFanOut(4);
+
+        for (bool subscribed : {false, true}) {
+            LayerStack stack;
+            for (u32 i = 0; i < Layers; ++i) {
+                const EventMask mask = i < Listeners ? AllEvents : EventCategoryMask(EventCategory::Window);
+                stack.PushLayer(new BenchLayer(subscribed ? mask : AllEvents));
+            }
+
+            Clock::time_point start = Clock::now();
+            for (u32 frame = 0; frame < Frames; ++frame) {
+                SubmitFrame(Events);
+                // This thread isn't a worker, it blocks instead of awaiting
+                EventHandler::ProcessEvents(stack.rbegin(), stack.rend()).m_Counter.Wait();
+            }
+            const f64 frameUs = std::chrono::duration<f64, std::micro>(Clock::now() - start).count() / Frames;
+
+            MESSAGE(Events << " events, " << Layers << " layers, " << (subscribed ? "subscribed" : "every event")
+                           << ": " << frameUs << " us per frame");
+        }
+    }
+
+    cw::JobSystem::Shutdown();
+    EventHandler::ShutDown();
+}
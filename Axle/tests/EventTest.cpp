@@ -4,9 +4,15 @@
 #include "Core/Logger/Log.hpp"
 #include "Core/Events/Event.hpp"
 #include "Core/Events/EventHandler.hpp"
+#include "Core/Events/EventQueue.hpp"
 #include "Core/Layer/Layer.hpp"
 #include "Core/Layer/LayerStack.hpp"
 
+#include "GlobalNewCounter.hpp"
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
 using namespace Axle;
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
@@ -108,6 +114,40 @@ public:
     }
 };
 
+// A TestLayer that only subscribes to some event types
+class SubscribedLayer : public TestLayer {
+public:
+    SubscribedLayer(const std::string& name, EventMask mask, EventPredicate pred = nullptr)
+        : TestLayer(name, std::move(pred)) {
+        SubscribeEvents(mask);
+    }
+};
+
+// Not trivially destructible, counts how many times it was destroyed
+class TestCountedEvent : public Event {
+public:
+    TestCountedEvent(std::shared_ptr<int> destroyed, u32 id)
+        : m_Destroyed(std::move(destroyed)),
+          m_ID(id) {}
+    TestCountedEvent(TestCountedEvent&& other) noexcept
+        : m_Destroyed(std::move(other.m_Destroyed)),
+          m_ID(other.m_ID) {}
+    ~TestCountedEvent() override {
+        if (m_Destroyed)
+            (*m_Destroyed)++;
+    }
+
+    u32 GetID() const noexcept {
+        return m_ID;
+    }
+
+    DEFINE_EVENT_TYPE(AppTick);
+
+private:
+    std::shared_ptr<int> m_Destroyed;
+    u32 m_ID;
+};
+
 struct EHFixture {
     EHFixture() {
         Log::Init();
@@ -213,6 +253,55 @@ TEST_CASE("EventDispatcher with KeyPressedEvent carries key payload") {
     CHECK(received == Keys::A);
 }
 
+// ─── TypedEventDispatcher ─────────────────────────────────────────────────────
+
+TEST_CASE("TypedEventDispatcher calls only the handler of the event's type") {
+    using Events = TypedEventDispatcher<TestKeyPressedEvent, TestWindowResizeEvent>;
+
+    int keys = 0;
+    u32 width = 0;
+    auto onKey = [&](TestKeyPressedEvent& ev) {
+        keys++;
+        return ev.GetKey() == Keys::A;
+    };
+    auto onResize = [&](TestWindowResizeEvent& ev) {
+        width = ev.GetWidth();
+        return false;
+    };
+
+    TestKeyPressedEvent key(Keys::A);
+    CHECK(Events::Dispatch(key, onKey, onResize));
+    CHECK(keys == 1);
+    CHECK(width == 0);
+    CHECK(key.IsHandled());
+
+    TestWindowResizeEvent resize(800, 600);
+    CHECK(Events::Dispatch(resize, onKey, onResize));
+    CHECK(keys == 1);
+    CHECK(width == 800);
+    CHECK_FALSE(resize.IsHandled());
+
+    MouseMovedEvent moved(1.0f, 2.0f);
+    CHECK_FALSE(Events::Dispatch(moved, onKey, onResize));
+    CHECK(keys == 1);
+}
+
+TEST_CASE("Event masks cover the right types") {
+    using Events = TypedEventDispatcher<TestKeyPressedEvent, TestWindowResizeEvent>;
+    static_assert(Events::Mask == (EventTypeMask(EventType::KeyPressed) | EventTypeMask(EventType::WindowResize)));
+
+    constexpr EventMask window = EventCategoryMask(EventCategory::Window);
+    constexpr EventMask input = EventCategoryMask(EventCategory::Input);
+    CHECK((window & EventTypeMask(EventType::WindowClose)) != 0);
+    CHECK((window & EventTypeMask(EventType::WindowMoved)) != 0);
+    CHECK((window & EventTypeMask(EventType::KeyPressed)) == 0);
+    CHECK((input & EventTypeMask(EventType::KeyPressed)) != 0);
+    CHECK((input & EventTypeMask(EventType::MouseScrolled)) != 0);
+    CHECK((input & EventTypeMask(EventType::AppTick)) == 0);
+    CHECK((window & input) == 0);
+    CHECK(EventCategoryMask(EventCategory::None) == 0);
+}
+
 // ─── Core dispatch through layer stack ───────────────────────────────────────
 
 TEST_CASE("Single layer receives dispatched event") {
@@ -471,3 +560,228 @@ TEST_CASE("Concurrent DispatchEvent is thread-safe") {
 
     CHECK(eventCount.load() == kThreads * kPerThread);
 }
+
+// ─── Batches ──────────────────────────────────────────────────────────────────
+
+TEST_CASE("Every layer sees the batch in order and handled events stop, whatever the fan-out") {
+    EHFixture f;
+
+    for (u32 fanOut : {1u, 3u, 7u, 32u}) {
+        LayerStack stack;
+
+        std::vector<u32> top, bottom;
+        auto record = [](std::vector<u32>& ids) {
+            return [&ids](Event& event) {
+                if (event.GetEventType() == EventType::MouseMoved)
+                    ids.push_back(static_cast<u32>(static_cast<MouseMovedEvent&>(event).GetX()));
+                else
+                    ids.push_back(1000);
+            };
+        };
+        TestLayer* l1 = new TestLayer("Bottom", record(bottom));
+        ConsumingLayer* l2 = new ConsumingLayer("Middle");
+        TestLayer* l3 = new TestLayer("Top", record(top));
+        stack.PushLayer(l1);
+        stack.PushLayer(l2);
+        stack.PushLayer(l3);
+
+        // Every third event is consumed by the middle layer
+        for (u32 i = 0; i < 12; ++i) {
+            if (i % 3 == 2)
+                AX_SUBMIT_EVENT(TestKeyPressedEvent(Keys::K));
+            else
+                AX_SUBMIT_EVENT(MouseMovedEvent(static_cast<f32>(i), 0.0f));
+        }
+
+        EventHandler::SetFanOut(fanOut);
+        f.process(stack);
+
+        CHECK(top == std::vector<u32>{0, 1, 1000, 3, 4, 1000, 6, 7, 1000, 9, 10, 1000});
+        CHECK(bottom == std::vector<u32>{0, 1, 3, 4, 6, 7, 9, 10});
+        CHECK(l2->eventCount == 12);
+    }
+}
+
+TEST_CASE("Batches run on the job system keep the order and never run a layer on two threads") {
+    constexpr u32 Events = 1000;
+    constexpr u32 Layers = 4;
+
+    EHFixture f;
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+
+        LayerStack stack;
+        std::array<std::vector<u32>, Layers> seen;
+        std::array<std::atomic<bool>, Layers> inside{};
+        std::atomic<bool> overlapped{false};
+
+        for (u32 layer = 0; layer < Layers; ++layer) {
+            stack.PushLayer(new TestLayer("L", [&, layer](Event& event) {
+                if (inside[layer].exchange(true, std::memory_order_acquire))
+                    overlapped.store(true, std::memory_order_relaxed);
+                seen[layer].push_back(static_cast<u32>(static_cast<MouseMovedEvent&>(event).GetX()));
+                inside[layer].store(false, std::memory_order_release);
+            }));
+        }
+
+        EventHandler::SetFanOut(3);
+        for (u32 frame = 0; frame < 3; ++frame) {
+            for (u32 i = 0; i < Events; ++i)
+                AX_SUBMIT_EVENT(MouseMovedEvent(static_cast<f32>(frame * Events + i), 0.0f));
+
+            // This thread isn't a worker, it blocks instead of awaiting
+            EventHandler::ProcessEvents(stack.rbegin(), stack.rend()).m_Counter.Wait();
+        }
+
+        for (const std::vector<u32>& ids : seen) {
+            REQUIRE(ids.size() == 3 * Events);
+            bool inOrder = true;
+            for (u32 i = 0; i < ids.size(); ++i)
+                inOrder &= ids[i] == i;
+            CHECK(inOrder);
+        }
+        CHECK_FALSE(overlapped.load());
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("Layers only receive the event types they subscribed to") {
+    EHFixture f;
+    LayerStack stack;
+
+    TestLayer* all = new TestLayer("All");
+    SubscribedLayer* keys = new SubscribedLayer("Keys", EventTypeMask(EventType::KeyPressed));
+    SubscribedLayer* window = new SubscribedLayer("Window", EventCategoryMask(EventCategory::Window));
+    SubscribedLayer* none = new SubscribedLayer("None", 0);
+    stack.PushLayer(all);
+    stack.PushLayer(keys);
+    stack.PushLayer(window);
+    stack.PushLayer(none);
+
+    AX_SUBMIT_EVENT(TestKeyPressedEvent(Keys::K));
+    AX_SUBMIT_EVENT(TestWindowResizeEvent(640, 480));
+    AX_SUBMIT_EVENT(MouseMovedEvent(1.0f, 1.0f));
+    AX_SUBMIT_EVENT(TestKeyPressedEvent(Keys::K));
+
+    f.process(stack);
+
+    CHECK(all->eventCount == 4);
+    CHECK(keys->eventCount == 2);
+    CHECK(window->eventCount == 1);
+    CHECK(none->eventCount == 0);
+}
+
+TEST_CASE("A layer that doesn't subscribe to an event doesn't stop it from reaching the ones below") {
+    EHFixture f;
+    LayerStack stack;
+
+    TestLayer* bottom = new TestLayer("Bottom");
+    // Would handle everything it receives, but only subscribes to window events
+    SubscribedLayer* top =
+        new SubscribedLayer("Top", EventCategoryMask(EventCategory::Window), [](Event& e) { e.Handle(true); });
+    stack.PushLayer(bottom);
+    stack.PushLayer(top);
+
+    AX_SUBMIT_EVENT(TestKeyPressedEvent(Keys::K));
+    AX_SUBMIT_EVENT(TestWindowResizeEvent(640, 480));
+
+    f.process(stack);
+
+    CHECK(top->eventCount == 1);
+    CHECK(bottom->eventCount == 1);
+}
+
+// ─── Event queue ──────────────────────────────────────────────────────────────
+
+TEST_CASE("EventQueue keeps events by value and in order across chunks") {
+    EventQueue queue;
+
+    // Enough to need several chunks
+    constexpr u32 Count = 2 * EventQueue::ChunkSize / sizeof(TestWindowResizeEvent);
+    for (u32 i = 0; i < Count; ++i) {
+        if (i % 2 == 0)
+            queue.Push(TestWindowResizeEvent(i, i + 1));
+        else
+            queue.Push(TestKeyPressedEvent(Keys::A));
+    }
+    REQUIRE(queue.Size() == Count);
+
+    u32 index = 0;
+    bool inOrder = true;
+    queue.ForEach([&](Event& event) {
+        if (index % 2 == 0) {
+            auto& resize = static_cast<TestWindowResizeEvent&>(event);
+            inOrder &= event.GetEventType() == EventType::WindowResize && resize.GetWidth() == index &&
+                       resize.GetHeight() == index + 1;
+        } else {
+            inOrder &= event.GetEventType() == EventType::KeyPressed;
+        }
+        index++;
+    });
+    CHECK(inOrder);
+    CHECK(index == Count);
+
+    queue.Clear();
+    CHECK(queue.IsEmpty());
+}
+
+TEST_CASE("EventQueue destroys events that need it exactly once") {
+    auto destroyed = std::make_shared<int>(0);
+
+    {
+        EventQueue queue;
+        queue.Push(TestCountedEvent(destroyed, 1));
+        queue.Push(TestCountedEvent(destroyed, 2));
+        // The temporaries were moved from, nothing counted yet
+        CHECK(*destroyed == 0);
+
+        std::vector<u32> ids;
+        queue.ForEach([&](Event& event) { ids.push_back(static_cast<TestCountedEvent&>(event).GetID()); });
+        CHECK(ids == std::vector<u32>{1, 2});
+
+        queue.Clear();
+        CHECK(*destroyed == 2);
+
+        // The one left when the queue goes away is destroyed too
+        queue.Push(TestCountedEvent(destroyed, 3));
+    }
+
+    CHECK(*destroyed == 3);
+}
+
+TEST_CASE("Steady state event flow doesn't allocate") {
+    EHFixture f;
+    LayerStack stack;
+
+    TestLayer* l1 = new TestLayer("L1");
+    ConsumingLayer* l2 = new ConsumingLayer("L2");
+    stack.PushLayer(l1);
+    stack.PushOverlay(l2);
+
+    // Like a frame with the mouse moving at 1000 Hz and a few keys held
+    auto frame = [&]() {
+        for (u32 i = 0; i < 64; ++i) {
+            AX_SUBMIT_EVENT(MouseMovedEvent(static_cast<f32>(i), 0.0f));
+            AX_SUBMIT_EVENT(KeyIsPressedEvent(Keys::W));
+            AX_SUBMIT_EVENT(KeyIsPressedEvent(Keys::A));
+        }
+        AX_SUBMIT_EVENT(TestKeyPressedEvent(Keys::Space));
+        AX_SUBMIT_EVENT(WindowResizeEvent(1280, 720));
+        f.process(stack);
+    };
+
+    // Warm up, the queues grow to the size of a frame
+    for (u32 i = 0; i < 4; ++i)
+        frame();
+
+    const u64 before = GetGlobalNewCalls();
+    for (u32 i = 0; i < 100; ++i)
+        frame();
+    const u64 allocations = GetGlobalNewCalls() - before;
+
+    CHECK(allocations == 0);
+    CHECK(l2->eventCount == 104 * (64 * 3 + 2));
+}
@@ -0,0 +1,26 @@
+#include "GlobalNewCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<Axle::u64> s_GlobalNewCalls{0};
+
+Axle::u64 GetGlobalNewCalls() {
+    return s_GlobalNewCalls.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    s_GlobalNewCalls.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "Core/Types.hpp"
+
+// Every call to the global operator new of the test binary is counted (Axle included, it's a shared library), so
+// tests can check that a code path doesn't allocate. The replacement lives in GlobalNewCounter.cpp.
+Axle::u64 GetGlobalNewCalls();
@@ -0,0 +1,89 @@
+#include <doctest.h>
+
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stop_token>
+
+// Benchmarks are skipped by default, run them with: AxleTests --no-skip --test-case="*Bench*"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr cw::Tag BenchTag = 101;
+
+    std::atomic<cw::u64> s_Sink{0};
+
+    // Same pattern as a layer update in Application::UpdateLoop: fan out `jobs` tagged jobs and wait on the tag.
+    // Stores the average time of a fan-out/fan-in round in microseconds.
+    cw::JobCoroutine<void> FanOutRounds(cw::u32 jobs, cw::u32 rounds, double* averageUs, std::stop_source* done) {
+        Clock::time_point start = Clock::now();
+
+        for (cw::u32 round = 0; round < rounds; ++round) {
+            for (cw::u32 i = 0; i < jobs; ++i)
+                cw::JobSystem::Schedule([i]() { s_Sink.fetch_add(i, std::memory_order_relaxed); },
+                                        cw::JobPriority::Medium,
+                                        cw::InvalidThreadIndex,
+                                        BenchTag);
+
+            cw::JobSystem::ScheduleTag(BenchTag);
+            co_await cw::WaitOnTag(BenchTag);
+        }
+
+        *averageUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+        done->request_stop();
+    }
+
+    // Same fan-out/fan-in but declared once as a graph and replayed every round
+    cw::JobCoroutine<void> GraphRounds(cw::u32 jobs, cw::u32 rounds, double* averageUs, std::stop_source* done) {
+        cw::JobGraph graph;
+        for (cw::u32 i = 0; i < jobs; ++i)
+            graph.AddNode([i]() { s_Sink.fetch_add(i, std::memory_order_relaxed); });
+
+        Clock::time_point start = Clock::now();
+
+        for (cw::u32 round = 0; round < rounds; ++round)
+            co_await graph.Run();
+
+        *averageUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+        done->request_stop();
+    }
+} // namespace
+
+TEST_CASE("JobSystem Bench - Fan-out/fan-in latency" * doctest::skip()) {
+    constexpr cw::u32 Rounds = 2000;
+    // Same amount of workers as the engine's default config, plus the calling thread
+    constexpr cw::u32 Workers = 3;
+
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Bench");
+
+    {
+        WorkerPool pool(Workers, "Bench worker");
+
+        for (cw::u32 jobs = 4; jobs <= 64; jobs *= 2) {
+            double averageUs = 0.0;
+            std::stop_source done;
+
+            cw::JobCoroutine<void> job = FanOutRounds(jobs, Rounds, &averageUs, &done);
+            CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Fan-out");
+            cw::JobSystem::RunWorkerUntil(done.get_token());
+
+            double graphUs = 0.0;
+            std::stop_source graphDone;
+
+            cw::JobCoroutine<void> graphJob = GraphRounds(jobs, Rounds, &graphUs, &graphDone);
+            CW_SCHEDULE(
+                graphJob, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Graph fan-out");
+            cw::JobSystem::RunWorkerUntil(graphDone.get_token());
+
+            MESSAGE(jobs << " jobs: " << averageUs << " us per tag fan-out/fan-in, " << graphUs << " us per graph run");
+        }
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
@@ -0,0 +1,863 @@
+#include <doctest.h>
+
+#include "GlobalNewCounter.hpp"
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr cw::Tag TestTag = 100;
+
+    cw::JobCoroutine<void> FanOut(cw::u32 jobs, std::vector<std::atomic<cw::u32>>* runs, std::atomic<bool>* done) {
+        for (cw::u32 i = 0; i < jobs; ++i)
+            cw::JobSystem::Schedule([runs, i]() { (*runs)[i].fetch_add(1, std::memory_order_relaxed); },
+                                    cw::JobPriority::Medium,
+                                    cw::InvalidThreadIndex,
+                                    TestTag);
+
+        cw::JobSystem::ScheduleTag(TestTag);
+        co_await cw::WaitOnTag(TestTag);
+
+        done->store(true, std::memory_order_release);
+    }
+
+    cw::JobCoroutine<cw::u32> Double(cw::u32 value) {
+        co_return value * 2;
+    }
+
+    // Same shape as a layer update tick: fan out tagged jobs, wait on the tag, then await a child coroutine.
+    // Stores how many times the global operator new was called after the warm up rounds.
+    cw::JobCoroutine<void> SteadyStateRounds(cw::u32 warmupRounds,
+                                             cw::u32 rounds,
+                                             std::atomic<cw::u64>* sum,
+                                             cw::u64* newCalls,
+                                             std::atomic<bool>* done) {
+        constexpr cw::u32 JobsPerRound = 32;
+        cw::u64 before = 0;
+
+        for (cw::u32 round = 0; round < warmupRounds + rounds; ++round) {
+            if (round == warmupRounds)
+                before = GetGlobalNewCalls();
+
+            // 56 bytes of captures, too big for the small buffer of std::function
+            std::array<cw::u64, 6> payload{round, 1, 2, 3, 4, 5};
+            for (cw::u32 i = 0; i < JobsPerRound; ++i)
+                cw::JobSystem::Schedule(
+                    [payload, sum]() { sum->fetch_add(payload[0] + payload[5], std::memory_order_relaxed); },
+                    cw::JobPriority::Medium,
+                    cw::InvalidThreadIndex,
+                    TestTag);
+
+            cw::JobSystem::ScheduleTag(TestTag);
+            co_await cw::WaitOnTag(TestTag);
+
+            auto [doubled] = co_await cw::WhenAll(Double(round));
+            sum->fetch_add(doubled, std::memory_order_relaxed);
+        }
+
+        *newCalls = GetGlobalNewCalls() - before;
+        done->store(true, std::memory_order_release);
+    }
+
+    // Bulk schedules jobs that each count themselves down and waits on the counter without blocking the worker
+    cw::JobCoroutine<void> BulkAndWait(cw::u32 jobs, std::vector<std::atomic<cw::u32>>* runs, std::atomic<bool>* done) {
+        auto counter = std::make_shared<cw::JobCounter>(jobs);
+
+        auto job = [runs, counter](cw::u32 index) {
+            (*runs)[index].fetch_add(1, std::memory_order_relaxed);
+            counter->Decrement();
+        };
+        CW_SCHEDULE_BULK(job, jobs, cw::JobPriority::Medium, "Bulk");
+
+        co_await cw::WaitOnCounter(*counter);
+
+        done->store(counter->IsDone(), std::memory_order_release);
+    }
+
+    cw::JobCoroutine<void> RunGraph(cw::JobGraph* graph, std::atomic<bool>* done) {
+        co_await graph->Run();
+
+        done->store(true, std::memory_order_release);
+    }
+
+    // Sleeps with WaitFor and stores how late each wake-up was, in microseconds
+    cw::JobCoroutine<void> SleepRounds(std::chrono::microseconds delay,
+                                       cw::u32 rounds,
+                                       std::vector<cw::i64>* lateness,
+                                       std::atomic<bool>* done) {
+        for (cw::u32 round = 0; round < rounds; ++round) {
+            const auto start = std::chrono::steady_clock::now();
+            co_await cw::WaitFor(delay);
+            const auto slept = std::chrono::steady_clock::now() - start;
+            lateness->push_back(std::chrono::duration_cast<std::chrono::microseconds>(slept - delay).count());
+        }
+
+        done->store(true, std::memory_order_release);
+    }
+
+    void RunJobsUntil(const std::atomic<bool>& done) {
+        while (!done.load(std::memory_order_acquire))
+            cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(5));
+    }
+} // namespace
+
+TEST_CASE("WorkStealingDeque - Owner pops LIFO and thieves steal FIFO") {
+    cw::WorkStealingDeque<cw::u64*> deque(4);
+    cw::u64 values[3] = {0, 1, 2};
+
+    cw::u64* value = nullptr;
+    CHECK_FALSE(deque.Pop(value));
+    CHECK_FALSE(deque.Steal(value));
+
+    for (cw::u64& v : values)
+        deque.Push(&v);
+    CHECK_EQ(deque.SizeApprox(), (cw::u64) 3);
+
+    REQUIRE(deque.Pop(value));
+    CHECK_EQ(value, &values[2]);
+    REQUIRE(deque.Steal(value));
+    CHECK_EQ(value, &values[0]);
+    REQUIRE(deque.Pop(value));
+    CHECK_EQ(value, &values[1]);
+
+    CHECK(deque.Empty());
+}
+
+TEST_CASE("WorkStealingDeque - Grows past its initial capacity") {
+    constexpr cw::u64 Count = 1000;
+    cw::WorkStealingDeque<cw::u64*> deque(2);
+    std::vector<cw::u64> values(Count);
+
+    for (cw::u64& v : values)
+        deque.Push(&v);
+    CHECK_EQ(deque.SizeApprox(), Count);
+
+    cw::u64* value = nullptr;
+    for (cw::u64 i = 0; i < Count; ++i) {
+        REQUIRE(deque.Steal(value));
+        CHECK_EQ(value, &values[i]);
+    }
+    CHECK(deque.Empty());
+}
+
+TEST_CASE("WorkStealingDeque - Every element is taken exactly once under concurrent steals") {
+    constexpr cw::u32 Count = 100'000;
+    constexpr cw::u32 Thieves = 3;
+
+    cw::WorkStealingDeque<cw::u32*> deque(2);
+    std::vector<cw::u32> values(Count);
+    std::vector<std::atomic<cw::u32>> taken(Count);
+    std::atomic<bool> ownerDone{false};
+
+    auto take = [&](cw::u32* value) { taken[value - values.data()].fetch_add(1, std::memory_order_relaxed); };
+
+    std::vector<std::thread> thieves;
+    for (cw::u32 t = 0; t < Thieves; ++t) {
+        thieves.emplace_back([&]() {
+            cw::u32* value;
+            while (!ownerDone.load(std::memory_order_acquire) || !deque.Empty()) {
+                if (deque.Steal(value))
+                    take(value);
+            }
+        });
+    }
+
+    // The owner keeps popping some of its own work while pushing, like a worker spawning jobs
+    cw::u32* value;
+    for (cw::u32 i = 0; i < Count; ++i) {
+        deque.Push(&values[i]);
+        if (i % 4 == 0 && deque.Pop(value))
+            take(value);
+    }
+    while (deque.Pop(value))
+        take(value);
+
+    ownerDone.store(true, std::memory_order_release);
+    for (std::thread& thief : thieves)
+        thief.join();
+
+    cw::u32 wrong = 0;
+    for (const std::atomic<cw::u32>& count : taken)
+        wrong += count.load() != 1;
+    CHECK_EQ(wrong, (cw::u32) 0);
+}
+
+TEST_CASE("JobSystem - Fan-out from a worker runs every job once") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        for (cw::u32 jobs : {4u, 64u, 200u}) {
+            std::vector<std::atomic<cw::u32>> runs(jobs);
+            std::atomic<bool> done{false};
+
+            cw::JobCoroutine<void> job = FanOut(jobs, &runs, &done);
+            CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Fan-out");
+            RunJobsUntil(done);
+
+            cw::u32 wrong = 0;
+            for (const std::atomic<cw::u32>& count : runs)
+                wrong += count.load() != 1;
+            CHECK_EQ(wrong, (cw::u32) 0);
+        }
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Bulk scheduled jobs resume the coroutine waiting on their counter") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        for (cw::u32 jobs : {1u, 16u, 500u}) {
+            std::vector<std::atomic<cw::u32>> runs(jobs);
+            std::atomic<bool> done{false};
+
+            cw::JobCoroutine<void> job = BulkAndWait(jobs, &runs, &done);
+            CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Bulk");
+            RunJobsUntil(done);
+
+            cw::u32 wrong = 0;
+            for (const std::atomic<cw::u32>& count : runs)
+                wrong += count.load() != 1;
+            CHECK_EQ(wrong, (cw::u32) 0);
+        }
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobCounter - Blocking wait returns once every decrement happened") {
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+
+        auto counter = std::make_shared<cw::JobCounter>();
+        CHECK(counter->IsDone());
+
+        constexpr cw::u32 Jobs = 64;
+        std::atomic<cw::u32> ran{0};
+        counter->Add(Jobs);
+        CHECK_FALSE(counter->IsDone());
+
+        cw::JobSystem::ScheduleBulk(
+            [&ran, counter](cw::u32) {
+                ran.fetch_add(1, std::memory_order_relaxed);
+                counter->Decrement();
+            },
+            Jobs);
+
+        counter->Wait();
+        CHECK_EQ(ran.load(), Jobs);
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobGraph - Nodes run after their dependencies, every time the graph runs") {
+    constexpr cw::u32 Runs = 50;
+    constexpr cw::u32 Fan = 16;
+
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        // first -> Fan nodes in parallel -> last, plus a chain hanging from first that last also waits on
+        std::atomic<cw::u32> clock{0};
+        std::vector<std::atomic<cw::u32>> finished(Fan + 4);
+        std::atomic<cw::u32> wrong{0};
+        auto stamp = [&](cw::u32 node) { finished[node].store(++clock, std::memory_order_relaxed); };
+
+        cw::JobGraph graph;
+        cw::NodeId first = graph.AddNode([&]() { stamp(0); });
+
+        std::vector<cw::NodeId> middle;
+        for (cw::u32 i = 0; i < Fan; ++i)
+            middle.push_back(graph.AddNode(
+                [&, i]() {
+                    wrong += finished[0].load() == 0;
+                    stamp(i + 1);
+                },
+                {first}));
+
+        cw::NodeId chainA = graph.AddNode([&]() { stamp(Fan + 1); }, {first});
+        cw::NodeId chainB = graph.AddNode(
+            [&]() {
+                wrong += finished[Fan + 1].load() == 0;
+                stamp(Fan + 2);
+            },
+            {chainA});
+
+        middle.push_back(chainB);
+        graph.AddNode(
+            [&]() {
+                for (cw::u32 node = 0; node < Fan + 3; ++node)
+                    wrong += finished[node].load() == 0;
+                stamp(Fan + 3);
+            },
+            middle);
+        CHECK_EQ(graph.Size(), Fan + 4);
+
+        for (cw::u32 run = 0; run < Runs; ++run) {
+            for (std::atomic<cw::u32>& stampValue : finished)
+                stampValue.store(0);
+
+            std::atomic<bool> done{false};
+            cw::JobCoroutine<void> job = RunGraph(&graph, &done);
+            CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Graph");
+            RunJobsUntil(done);
+
+            CHECK(graph.IsDone());
+            for (const std::atomic<cw::u32>& stampValue : finished)
+                wrong += stampValue.load() == 0;
+        }
+
+        CHECK_EQ(wrong.load(), (cw::u32) 0);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobGraph - Long chains and blocking waits from a non-worker thread") {
+    constexpr cw::u32 Length = 1000;
+
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+
+        std::vector<cw::u32> order;
+        order.reserve(Length);
+
+        cw::JobGraph graph;
+        cw::NodeId previous = cw::InvalidNodeId;
+        for (cw::u32 i = 0; i < Length; ++i) {
+            auto push = [&order, i]() { order.push_back(i); };
+            previous = previous == cw::InvalidNodeId ? graph.AddNode(push) : graph.AddNode(push, {previous});
+        }
+
+        for (cw::u32 run = 0; run < 3; ++run) {
+            order.clear();
+            graph.Run();
+            graph.Wait();
+
+            REQUIRE_EQ(order.size(), (std::size_t) Length);
+            CHECK(std::is_sorted(order.begin(), order.end()));
+        }
+
+        // An empty graph is done right away
+        cw::JobGraph empty;
+        empty.Run();
+        empty.Wait();
+        CHECK(empty.IsDone());
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Tags hold any amount of jobs, whatever their id") {
+    // Well past what a tag used to hold, from several threads at once, to a tag in the first page and one far out
+    constexpr cw::u32 Producers = 4;
+    constexpr cw::u32 JobsPerProducer = 2500;
+    constexpr std::array<cw::Tag, 2> Tags{TestTag, 40'000};
+
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+
+        for (cw::Tag tag : Tags) {
+            std::vector<std::atomic<cw::u32>> runs(Producers * JobsPerProducer);
+            std::atomic<cw::u32> ran{0};
+
+            std::vector<std::thread> producers;
+            for (cw::u32 producer = 0; producer < Producers; ++producer) {
+                producers.emplace_back([&runs, &ran, producer, tag]() {
+                    for (cw::u32 i = 0; i < JobsPerProducer; ++i) {
+                        const cw::u32 index = producer * JobsPerProducer + i;
+                        auto job = [&runs, &ran, index]() {
+                            runs[index].fetch_add(1, std::memory_order_relaxed);
+                            ran.fetch_add(1, std::memory_order_release);
+                        };
+                        cw::JobSystem::Schedule(job, cw::JobPriority::Medium, cw::InvalidThreadIndex, tag);
+                    }
+                });
+            }
+            for (std::thread& producer : producers)
+                producer.join();
+
+            // Nothing runs before the tag is scheduled
+            CHECK_EQ(ran.load(), (cw::u32) 0);
+
+            cw::JobSystem::ScheduleTag(tag);
+            while (ran.load(std::memory_order_acquire) != Producers * JobsPerProducer)
+                std::this_thread::yield();
+
+            CHECK(std::all_of(runs.begin(), runs.end(), [](const std::atomic<cw::u32>& ran) {
+                return ran.load(std::memory_order_relaxed) == 1;
+            }));
+        }
+
+        cw::JobSystem::SampleStats();
+        const cw::JobSystemStats stats = cw::JobSystem::GetStats();
+        REQUIRE_EQ(stats.m_Tags.size(), Tags.size());
+        for (cw::u64 i = 0; i < Tags.size(); ++i) {
+            CHECK_EQ(stats.m_Tags[i].m_Tag, Tags[i]);
+            CHECK_EQ(stats.m_Tags[i].m_HighWater, Producers * JobsPerProducer);
+        }
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Jobs scheduled from a non-worker thread are run") {
+    constexpr cw::u32 Jobs = 128;
+
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+        std::atomic<cw::u32> ran{0};
+
+        // This thread is not a worker so the jobs go through the injection queues
+        for (cw::u32 i = 0; i < Jobs; ++i)
+            cw::JobSystem::Schedule([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); },
+                                    static_cast<cw::JobPriority>(i % 3));
+
+        while (ran.load(std::memory_order_acquire) != Jobs)
+            std::this_thread::yield();
+
+        CHECK_EQ(ran.load(), Jobs);
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Idle policy decides whether workers spin or park") {
+    constexpr cw::u32 Jobs = 64;
+
+    cw::JobSystem::Init(0);
+
+    // One job at a time, each only scheduled once the previous one ran, so the worker is idle every time
+    auto runOneByOne = [] {
+        std::atomic<cw::u32> ran{0};
+
+        for (cw::u32 i = 0; i < Jobs; ++i) {
+            cw::JobSystem::Schedule([&ran]() { ran.fetch_add(1, std::memory_order_release); });
+
+            while (ran.load(std::memory_order_acquire) != i + 1)
+                std::this_thread::yield();
+        }
+
+        return ran.load();
+    };
+
+    auto wakeUps = [](const cw::IdleStats& stats) {
+        cw::u64 total = 0;
+        for (cw::u64 bucket : stats.m_WakeLatency)
+            total += bucket;
+        return total;
+    };
+
+    // Park right away, every job has to wake the worker up. Set before the worker starts waiting, a worker already
+    // spinning finishes with the old policy
+    cw::JobSystem::SetIdlePolicy({0, 0});
+
+    {
+        WorkerPool pool(1);
+
+        CHECK_EQ(cw::JobSystem::GetIdlePolicy().m_SpinIterations, (cw::u32) 0);
+        CHECK_EQ(cw::JobSystem::GetIdlePolicy().m_YieldIterations, (cw::u32) 0);
+        cw::JobSystem::ResetIdleStats();
+
+        CHECK_EQ(runOneByOne(), Jobs);
+
+        cw::IdleStats parked = cw::JobSystem::GetIdleStats();
+        CHECK_EQ(parked.m_SpinHits, (cw::u64) 0);
+        CHECK_GE(parked.m_Parks, (cw::u64) Jobs);
+        CHECK_GT(wakeUps(parked), (cw::u64) 0);
+
+        // Yield long enough for this thread to schedule the next job in the meantime
+        cw::JobSystem::SetIdlePolicy({16, 100'000});
+        cw::JobSystem::ResetIdleStats();
+
+        CHECK_EQ(runOneByOne(), Jobs);
+        CHECK_GT(cw::JobSystem::GetIdleStats().m_SpinHits, (cw::u64) 0);
+
+        // Back to something that doesn't keep the worker busy while the pool shuts down
+        cw::JobSystem::SetIdlePolicy({});
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Stats count what happened since the previous sample") {
+    constexpr cw::u32 Jobs = 200;
+    constexpr cw::u32 Tagged = 10;
+
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(2);
+        std::atomic<cw::u32> ran{0};
+
+        for (cw::u32 i = 0; i < Jobs; ++i)
+            cw::JobSystem::Schedule([&ran]() { ran.fetch_add(1, std::memory_order_release); });
+        while (ran.load(std::memory_order_acquire) != Jobs)
+            std::this_thread::yield();
+
+        // Held by the tag until it's scheduled
+        for (cw::u32 i = 0; i < Tagged; ++i)
+            cw::JobSystem::Schedule(
+                [&ran]() { ran.fetch_add(1, std::memory_order_release); }, cw::JobPriority::Low, cw::InvalidThreadIndex,
+                TestTag);
+
+        cw::JobSystem::SampleStats();
+        cw::JobSystemStats stats = cw::JobSystem::GetStats();
+
+        CHECK_EQ(stats.m_WorkerCount, (cw::ThreadAffinity) 2);
+        cw::u64 jobsRun = 0, busy = 0;
+        for (cw::ThreadAffinity i = 0; i < stats.m_WorkerCount; ++i) {
+            jobsRun += stats.m_Workers[i].m_JobsRun;
+            busy += stats.m_Workers[i].m_BusyNs;
+        }
+        CHECK_EQ(jobsRun, (cw::u64) Jobs);
+        CHECK_GT(busy, (cw::u64) 0);
+
+        REQUIRE_EQ(stats.m_Tags.size(), (std::size_t) 1);
+        CHECK_EQ(stats.m_Tags[0].m_Tag, TestTag);
+        CHECK_EQ(stats.m_Tags[0].m_PendingJobs, Tagged);
+        CHECK_EQ(stats.m_Tags[0].m_HighWater, Tagged);
+
+        cw::JobSystem::ScheduleTag(TestTag);
+        while (ran.load(std::memory_order_acquire) != Jobs + Tagged)
+            std::this_thread::yield();
+
+        // Only the tagged jobs ran since the first sample, the high water mark stays
+        cw::JobSystem::SampleStats();
+        stats = cw::JobSystem::GetStats();
+
+        jobsRun = 0;
+        for (cw::ThreadAffinity i = 0; i < stats.m_WorkerCount; ++i)
+            jobsRun += stats.m_Workers[i].m_JobsRun;
+        CHECK_EQ(jobsRun, (cw::u64) Tagged);
+        CHECK_GT(stats.m_IntervalNs, (cw::u64) 0);
+        CHECK_EQ(stats.m_Tags[0].m_HighWater, Tagged);
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("TimerWheel - Timers fire in order of expiry across every level") {
+    cw::TimerWheel<cw::u64> wheel(1000);
+
+    // From the first level up to the last, some right at slot boundaries, plus one already due
+    const std::vector<cw::u64> delays{1, 2, 63, 64, 65, 100, 4095, 4096, 5000, 262'144, 1'000'000, 70'000'000,
+                                      1ULL << 40, 0};
+    for (cw::u64 delay : delays)
+        wheel.Add(1000 + delay, 1000 + delay);
+    // A second timer on an existing expiry
+    wheel.Add(1100, 1100);
+
+    std::vector<cw::u64> expected;
+    for (cw::u64 delay : delays)
+        expected.push_back(1000 + delay);
+    expected.push_back(1100);
+    std::sort(expected.begin(), expected.end());
+
+    REQUIRE_EQ(wheel.Size(), (cw::u64) expected.size());
+
+    // Jump from one expiry to the next, the wheel must name each one exactly and fire nothing early
+    std::vector<cw::u64> fired;
+    while (std::optional<cw::u64> next = wheel.NextExpiry()) {
+        const cw::u64 before = fired.size();
+        wheel.Advance(*next - (*next > 1000 ? 1 : 0), [&fired](cw::u64 expiry) { fired.push_back(expiry); });
+        if (*next > 1000)
+            CHECK_EQ(fired.size(), before);
+
+        wheel.Advance(*next, [&fired, next](cw::u64 expiry) {
+            CHECK_EQ(expiry, *next);
+            fired.push_back(expiry);
+        });
+        CHECK_GT(fired.size(), before);
+    }
+
+    CHECK(fired == expected);
+    CHECK(wheel.Empty());
+}
+
+TEST_CASE("TimerWheel - Cancelled timers don't fire and their ids can't cancel newer ones") {
+    cw::TimerWheel<cw::u64> wheel(0);
+
+    const cw::TimerId near = wheel.Add(10, 10);
+    const cw::TimerId far = wheel.Add(100'000, 100'000);
+    wheel.Add(50, 50);
+
+    cw::u64 value = 0;
+    CHECK(wheel.Cancel(far, value));
+    CHECK_EQ(value, (cw::u64) 100'000);
+    CHECK_FALSE(wheel.Cancel(far, value));
+    CHECK_FALSE(wheel.Cancel(cw::InvalidTimerId, value));
+    CHECK_EQ(wheel.NextExpiry(), std::optional<cw::u64>(10));
+
+    std::vector<cw::u64> fired;
+    wheel.Advance(1'000'000, [&fired](cw::u64 expiry) { fired.push_back(expiry); });
+    CHECK(fired == std::vector<cw::u64>{10, 50});
+
+    // The node of the first timer is reused, its old id must not reach the new timer
+    const cw::TimerId reused = wheel.Add(2'000'000, 7);
+    CHECK_FALSE(wheel.Cancel(near, value));
+    CHECK(wheel.Cancel(reused, value));
+    CHECK_EQ(value, (cw::u64) 7);
+    CHECK(wheel.Empty());
+    CHECK_FALSE(wheel.NextExpiry().has_value());
+}
+
+TEST_CASE("TimerWheel - Timers past the current span are clamped to its last tick") {
+    constexpr cw::u64 Start = 1000;
+    constexpr cw::u64 End = Start | cw::TimerWheel<cw::u64>::MaxDelay;
+    cw::TimerWheel<cw::u64> wheel(Start);
+
+    wheel.Add(std::numeric_limits<cw::u64>::max(), 1);
+    wheel.Add(Start + 10, 2);
+    CHECK_EQ(wheel.NextExpiry(), std::optional<cw::u64>(Start + 10));
+
+    std::vector<cw::u64> fired;
+    wheel.Advance(End - 1, [&fired](cw::u64 value) { fired.push_back(value); });
+    CHECK(fired == std::vector<cw::u64>{2});
+    CHECK_EQ(wheel.NextExpiry(), std::optional<cw::u64>(End));
+
+    wheel.Advance(End, [&fired](cw::u64 value) { fired.push_back(value); });
+    CHECK(fired == std::vector<cw::u64>{2, 1});
+    CHECK(wheel.Empty());
+
+    // Past the end of the span the next one starts, with its own last tick
+    wheel.Advance(End + 100, [](cw::u64) {});
+    wheel.Add(std::numeric_limits<cw::u64>::max(), 3);
+    CHECK_EQ(wheel.NextExpiry(), std::optional<cw::u64>(End + 1 + cw::TimerWheel<cw::u64>::MaxDelay));
+}
+
+TEST_CASE("JobSystem - Delayed jobs wake up on time") {
+    constexpr cw::u32 Rounds = 20;
+    // Generous for loaded CI machines, what's achieved is reported below
+    constexpr cw::i64 MaxLatenessUs = 20'000;
+
+    cw::JobSystem::Init(0);
+
+    {
+        WorkerPool pool(1);
+
+        for (std::chrono::microseconds delay : {std::chrono::microseconds(1000), std::chrono::microseconds(5000)}) {
+            std::vector<cw::i64> lateness;
+            std::atomic<bool> done{false};
+            cw::JobCoroutine<void> sleeper = SleepRounds(delay, Rounds, &lateness, &done);
+            cw::JobSystem::Schedule(sleeper);
+
+            while (!done.load(std::memory_order_acquire))
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            REQUIRE_EQ(lateness.size(), (std::size_t) Rounds);
+            std::sort(lateness.begin(), lateness.end());
+
+            // Timers have a microsecond tick, so the start of the wait can be rounded down by up to one
+            CHECK_GE(lateness.front(), -1);
+            CHECK_LE(lateness[Rounds / 2], MaxLatenessUs);
+            MESSAGE("WaitFor " << delay.count() << " us: " << lateness[Rounds / 2] << " us late on median, "
+                               << lateness.back() << " us at worst");
+        }
+
+        // Function jobs, one of them cancelled before it's due
+        std::atomic<cw::i64> ranAt{0};
+        std::atomic<bool> cancelledRan{false};
+        const auto start = std::chrono::steady_clock::now();
+
+        auto record = [&ranAt, start]() {
+            ranAt.store(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+                            .count(),
+                        std::memory_order_release);
+        };
+        auto never = [&cancelledRan]() { cancelledRan.store(true, std::memory_order_relaxed); };
+
+        const cw::TimerId cancelled =
+            CW_SCHEDULE_AFTER(never, std::chrono::microseconds(1000), cw::JobPriority::High, 0, cw::InvalidTag, "");
+        CW_SCHEDULE_AFTER(record, std::chrono::microseconds(3000), cw::JobPriority::High, 0, cw::InvalidTag, "");
+        CHECK(cw::JobSystem::CancelTimer(cancelled));
+        CHECK_FALSE(cw::JobSystem::CancelTimer(cancelled));
+
+        while (ranAt.load(std::memory_order_acquire) == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        CHECK_GE(ranAt.load(), (cw::i64) 3000);
+        CHECK_LE(ranAt.load(), (cw::i64) 3000 + MaxLatenessUs);
+        CHECK_FALSE(cancelledRan.load());
+    }
+
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("PoolAllocator - Blocks freed by another thread go back to their owner") {
+    constexpr cw::u32 Count = 256;
+
+    // Warm the pools of this thread
+    std::vector<void*> blocks;
+    for (cw::u32 i = 0; i < Count; ++i)
+        blocks.push_back(cw::PoolAllocator::Allocate(100));
+    for (void* block : blocks)
+        cw::PoolAllocator::Free(block, 100);
+
+    // Blocks must be usable and aligned like the global operator new
+    blocks.clear();
+    for (cw::u32 i = 0; i < Count; ++i) {
+        blocks.push_back(cw::PoolAllocator::Allocate(100));
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(blocks.back()) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, (std::uintptr_t) 0);
+        std::memset(blocks.back(), static_cast<int>(i), 100);
+    }
+
+    std::thread([&blocks]() {
+        for (void* block : blocks)
+            cw::PoolAllocator::Free(block, 100);
+    }).join();
+
+    // Everything came back through the remote list, so reallocating doesn't need new memory
+    const cw::u64 before = GetGlobalNewCalls();
+    blocks.clear();
+    blocks.reserve(Count);
+    const cw::u64 afterReserve = GetGlobalNewCalls();
+    for (cw::u32 i = 0; i < Count; ++i)
+        blocks.push_back(cw::PoolAllocator::Allocate(100));
+    CHECK_EQ(GetGlobalNewCalls() - afterReserve, (cw::u64) 0);
+    CHECK_LE(afterReserve - before, (cw::u64) 1);
+
+    for (void* block : blocks)
+        cw::PoolAllocator::Free(block, 100);
+
+    // Too big for the pools, goes to the global heap
+    void* big = cw::PoolAllocator::Allocate(cw::PoolAllocator::MaxBlockSize + 1);
+    cw::PoolAllocator::Free(big, cw::PoolAllocator::MaxBlockSize + 1);
+}
+
+namespace {
+    // Destroyed after the allocator's thread slot when constructed before the thread first allocates
+    struct LateFree {
+        void* block = nullptr;
+        std::atomic<bool>* orphaned = nullptr;
+        std::atomic<bool>* adopted = nullptr;
+
+        ~LateFree() {
+            if (block == nullptr)
+                return;
+
+            orphaned->store(true, std::memory_order_release);
+            while (!adopted->load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            cw::PoolAllocator::Free(block, 100);
+            cw::PoolAllocator::Free(cw::PoolAllocator::Allocate(100), 100);
+        }
+    };
+} // namespace
+
+TEST_CASE("PoolAllocator - Blocks freed while the thread exits don't touch its handed back pools") {
+    std::atomic<bool> orphaned{false};
+    std::atomic<bool> adopted{false};
+    std::atomic<bool> exited{false};
+
+    std::thread exiting([&]() {
+        thread_local LateFree late;
+        late.orphaned = &orphaned;
+        late.adopted = &adopted;
+        late.block = cw::PoolAllocator::Allocate(100);
+    });
+
+    // Takes the pools of the exiting thread and keeps using them while it frees its last block
+    std::thread adopting([&]() {
+        while (!orphaned.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        std::vector<void*> blocks;
+        blocks.push_back(cw::PoolAllocator::Allocate(100));
+        adopted.store(true, std::memory_order_release);
+
+        while (!exited.load(std::memory_order_acquire)) {
+            blocks.push_back(cw::PoolAllocator::Allocate(100));
+            cw::PoolAllocator::Free(blocks.back(), 100);
+            blocks.pop_back();
+        }
+
+        // The block freed late is back in these pools and can be allocated again
+        for (cw::u32 i = 0; i < 1024; ++i)
+            blocks.push_back(cw::PoolAllocator::Allocate(100));
+        for (void* block : blocks)
+            cw::PoolAllocator::Free(block, 100);
+    });
+
+    exiting.join();
+    exited.store(true, std::memory_order_release);
+    adopting.join();
+}
+
+TEST_CASE("JobSystem - Callables bigger than the inline storage still run") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        std::array<cw::u64, 32> big{};
+        big.back() = 7;
+        std::atomic<cw::u64> result{0};
+        static_assert(sizeof(big) > cw::JobFunction::InlineStorageSize);
+
+        cw::JobSystem::Schedule([big, &result]() { result.store(big.back(), std::memory_order_release); });
+
+        while (result.load(std::memory_order_acquire) == 0)
+            cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(5));
+
+        CHECK_EQ(result.load(), (cw::u64) 7);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("JobSystem - Steady state scheduling doesn't call the global operator new") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(2);
+
+        std::atomic<cw::u64> sum{0};
+        cw::u64 newCalls = ~0ull;
+        std::atomic<bool> done{false};
+
+        cw::JobCoroutine<void> job = SteadyStateRounds(200, 500, &sum, &newCalls, &done);
+        CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Steady state");
+        RunJobsUntil(done);
+
+        CHECK_NE(sum.load(), (cw::u64) 0);
+        CHECK_EQ(newCalls, (cw::u64) 0);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
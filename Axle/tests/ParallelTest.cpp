@@ -0,0 +1,184 @@
+#include <doctest.h>
+
+#include "Core/Types.hpp"
+#include "Core/Parallel/Parallel.hpp"
+#include "Core/Parallel/ParallelAsync.hpp"
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace Axle;
+
+namespace {
+    std::vector<i32> RandomValues(u64 count) {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<i32> dist(-1000, 1000);
+
+        std::vector<i32> values(count);
+        for (i32& value : values)
+            value = dist(rng);
+        return values;
+    }
+
+    u32 WrongVisits(const std::vector<std::atomic<u32>>& visits) {
+        u32 wrong = 0;
+        for (const std::atomic<u32>& count : visits)
+            wrong += count.load() != 1;
+        return wrong;
+    }
+
+    cw::JobCoroutine<void> AsyncAlgorithms(std::vector<std::atomic<u32>>* visits,
+                                           u64* sum,
+                                           std::vector<i32>* values,
+                                           std::atomic<bool>* done) {
+        co_await cw::WhenAll(ParallelForAsync(0, visits->size(), 16, [visits](u64 i) {
+            (*visits)[i].fetch_add(1, std::memory_order_relaxed);
+        }));
+
+        auto [reduced] = co_await cw::WhenAll(ParallelReduceAsync(
+            1, 100'001, 256, (u64) 0, [](u64 value, u64 i) { return value + i; }, std::plus<>()));
+        *sum = reduced;
+
+        co_await cw::WhenAll(ParallelSortAsync(values->begin(), values->end()));
+
+        done->store(true, std::memory_order_release);
+    }
+} // namespace
+
+TEST_CASE("Parallel - Runs inline without the job system") {
+    std::vector<std::atomic<u32>> visits(1000);
+    ParallelFor(0, visits.size(), 1, [&](u64 i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+    CHECK_EQ(WrongVisits(visits), (u32) 0);
+
+    CHECK_EQ(ParallelReduce(0, 10, 1, (u64) 0, [](u64 value, u64 i) { return value + i; }, std::plus<>()), (u64) 45);
+
+    std::vector<i32> values = RandomValues(10'000);
+    ParallelSort(values.begin(), values.end());
+    CHECK(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST_CASE("Parallel - ParallelFor visits every index once") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        for (u64 count : {1ull, 7ull, 1000ull, 100'000ull}) {
+            std::vector<std::atomic<u32>> visits(count);
+            ParallelFor(0, count, 16, [&](u64 i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+            CHECK_EQ(WrongVisits(visits), (u32) 0);
+        }
+
+        // Chunk overload, with an offset range
+        std::vector<std::atomic<u32>> visits(5000);
+        std::atomic<u32> smallChunks{0};
+        ParallelFor(100, 5100, 64, [&](u64 begin, u64 end) {
+            // Only the last chunk can be smaller than the grain
+            if (end != 5100 && end - begin < 64)
+                smallChunks.fetch_add(1, std::memory_order_relaxed);
+            for (u64 i = begin; i < end; ++i)
+                visits[i - 100].fetch_add(1, std::memory_order_relaxed);
+        });
+        CHECK_EQ(WrongVisits(visits), (u32) 0);
+        CHECK_EQ(smallChunks.load(), (u32) 0);
+
+        // Empty ranges don't call anything
+        u32 calls = 0;
+        ParallelFor(10, 10, 1, [&calls](u64) { ++calls; });
+        CHECK_EQ(calls, (u32) 0);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("Parallel - ParallelReduce combines partials in order") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        constexpr u64 Count = 100'000;
+
+        CHECK_EQ(ParallelReduce(1, Count + 1, 256, (u64) 0, [](u64 value, u64 i) { return value + i; }, std::plus<>()),
+                 Count * (Count + 1) / 2);
+
+        // Not commutative, only correct if the chunks are combined in order
+        std::vector<u64> order = ParallelReduce(
+            0,
+            Count,
+            128,
+            std::vector<u64>(),
+            [](std::vector<u64> value, u64 i) {
+                value.push_back(i);
+                return value;
+            },
+            [](std::vector<u64> left, const std::vector<u64>& right) {
+                left.insert(left.end(), right.begin(), right.end());
+                return left;
+            });
+        REQUIRE_EQ(order.size(), Count);
+        CHECK(std::is_sorted(order.begin(), order.end()));
+
+        CHECK_EQ(ParallelReduce(5, 5, 1, (u64) 42, [](u64 value, u64) { return value + 1; }, std::plus<>()), (u64) 42);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("Parallel - ParallelSort matches std::sort") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        for (u64 count : {0ull, 1ull, 100ull, 5000ull, 123'457ull}) {
+            std::vector<i32> values = RandomValues(count);
+            std::vector<i32> expected = values;
+            std::sort(expected.begin(), expected.end(), std::greater<>());
+
+            ParallelSort(values.begin(), values.end(), std::greater<>());
+            CHECK(values == expected);
+        }
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
+
+TEST_CASE("Parallel - Coroutine versions can be awaited") {
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        WorkerPool pool(3);
+
+        std::vector<std::atomic<u32>> visits(10'000);
+        u64 sum = 0;
+        std::vector<i32> values = RandomValues(50'000);
+        std::atomic<bool> done{false};
+
+        cw::JobCoroutine<void> job = AsyncAlgorithms(&visits, &sum, &values, &done);
+        CW_SCHEDULE(job, cw::JobPriority::Medium, cw::JobSystem::GetThreadIndex(), cw::InvalidTag, "Parallel async");
+
+        while (!done.load(std::memory_order_acquire))
+            cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(5));
+
+        CHECK_EQ(WrongVisits(visits), (u32) 0);
+        CHECK_EQ(sum, (u64) 100'000 * 100'001 / 2);
+        CHECK(std::is_sorted(values.begin(), values.end()));
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+}
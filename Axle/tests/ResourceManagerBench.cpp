@@ -0,0 +1,489 @@
+#include <doctest.h>
+
+#include "Core/Types.hpp"
+#include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/AssetPack.hpp"
+#include "Core/Error/Result.hpp"
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef AX_PLATFORM_LINUX
+#    include <fcntl.h>
+#    include <sys/resource.h>
+#    include <unistd.h>
+#endif
+
+// Benchmarks are skipped by default, run them with: AxleTests --no-skip --test-case="*Bench*"
+
+using namespace Axle;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Every mapped file keeps its descriptor open, so the default limit (usually 1024) is not enough
+    bool RaiseOpenFilesLimit(u64 needed) {
+#ifdef AX_PLATFORM_LINUX
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+            return false;
+
+        if (limit.rlim_cur >= needed)
+            return true;
+
+        if (limit.rlim_max < needed)
+            return false;
+
+        limit.rlim_cur = needed;
+        return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+#else
+        (void) needed;
+        return true;
+#endif
+    }
+
+    // Creates a directory full of small files and removes it afterwards
+    struct BenchDirectory {
+        std::filesystem::path path;
+        std::vector<std::filesystem::path> files;
+
+        BenchDirectory(const std::string& name, u32 count)
+            : path("assets/tests/" + name) {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+
+            files.reserve(count);
+            for (u32 i = 0; i < count; ++i) {
+                files.push_back(path / ("file_" + std::to_string(i) + ".bin"));
+                std::ofstream file(files.back(), std::ios::binary);
+                file << "bench file " << i;
+            }
+        }
+
+        ~BenchDirectory() {
+            std::filesystem::remove_all(path);
+        }
+    };
+
+    // Creates a zero filled file through the manager and removes it afterwards
+    struct TempFile {
+        std::filesystem::path path;
+
+        TempFile(const std::string& name, u64 size)
+            : path("assets/tests/" + name) {
+            std::filesystem::remove(path);
+            ResourceManager::Create(path, size);
+        }
+
+        ~TempFile() {
+            std::filesystem::remove(path);
+        }
+    };
+
+    // Packs the given files the same way AAP's pack subcommand does, names are relative to root
+    void WritePack(const std::vector<std::filesystem::path>& files,
+                   const std::filesystem::path& root,
+                   const std::filesystem::path& output,
+                   bool compress = false) {
+        std::vector<AssetPack::TocFile> tocFiles;
+        std::vector<std::string> stored;
+
+        for (const std::filesystem::path& file : files) {
+            std::string content(std::filesystem::file_size(file), '\0');
+            std::ifstream(file, std::ios::binary).read(content.data(), content.size());
+
+            std::string compressed;
+            if (compress)
+                compressed = AssetPack::CompressChunked(content.data(), content.size(), AssetPack::DEFAULT_CHUNK_SIZE);
+
+            const bool shrank = compress && compressed.size() < content.size();
+            const std::string name = std::filesystem::relative(file, root).lexically_normal().generic_string();
+
+            tocFiles.push_back({name,
+                                content.size(),
+                                shrank ? compressed.size() : content.size(),
+                                shrank ? AssetPack::ENTRY_COMPRESSED : 0});
+            stored.push_back(shrank ? std::move(compressed) : std::move(content));
+        }
+
+        AssetPack::Toc toc = AssetPack::BuildToc(tocFiles);
+
+        std::string data(toc.header.packSize, '\0');
+        std::memcpy(data.data(), &toc.header, sizeof(toc.header));
+        std::memcpy(
+            data.data() + toc.header.tocOffset, toc.entries.data(), toc.entries.size() * sizeof(AssetPack::Entry));
+        std::memcpy(data.data() + toc.header.namesOffset, toc.names.data(), toc.names.size());
+
+        for (size_t i = 0; i < stored.size(); ++i)
+            std::memcpy(data.data() + toc.offsets[i], stored[i].data(), stored[i].size());
+
+        std::ofstream(output, std::ios::binary).write(data.data(), data.size());
+    }
+
+    // Drops the file from the page cache so the next read comes from storage
+    void EvictFromPageCache(const std::filesystem::path& path) {
+#ifdef AX_PLATFORM_LINUX
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+#else
+        (void) path;
+#endif
+    }
+
+    double MicrosecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    // Runs `threads` readers doing `iterations` DataConst calls each and returns the total amount of reads per second.
+    // When `writer` is set an extra thread keeps taking WriteGuards on an unrelated file during the whole run.
+    double MeasureReaders(u32 threads,
+                          u32 iterations,
+                          const std::vector<ResourceManager::ManagedFileHandle>& files,
+                          bool sharedFile,
+                          const ResourceManager::ManagedFileHandle* writer) {
+        std::barrier start(threads + 1);
+        std::atomic<bool> readersDone{false};
+        std::atomic<u64> checksum{0};
+        std::vector<std::thread> workers;
+
+        std::thread writerThread;
+        if (writer != nullptr) {
+            writerThread = std::thread([&]() {
+                while (!readersDone.load(std::memory_order_relaxed)) {
+                    auto guard = ResourceManager::Data(*writer);
+                    if (guard.IsOk())
+                        guard.Unwrap().Data()[0]++;
+                }
+            });
+        }
+
+        for (u32 t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                const ResourceManager::ManagedFileHandle& handle = files[sharedFile ? 0 : t % files.size()];
+                u64 sum = 0;
+
+                start.arrive_and_wait();
+                for (u32 i = 0; i < iterations; ++i) {
+                    auto guard = ResourceManager::DataConst(handle);
+                    sum += static_cast<u8>(guard.Unwrap().Data()[i % guard.Unwrap().Size()]);
+                }
+                checksum.fetch_add(sum, std::memory_order_relaxed);
+            });
+        }
+
+        start.arrive_and_wait();
+        Clock::time_point begin = Clock::now();
+        for (auto& w : workers)
+            w.join();
+        const double elapsedUs = MicrosecondsSince(begin);
+
+        readersDone.store(true, std::memory_order_relaxed);
+        if (writerThread.joinable())
+            writerThread.join();
+
+        CHECK_NE(checksum.load(), (u64) 0);
+        return (u64(threads) * iterations) / (elapsedUs / 1e6);
+    }
+} // namespace
+
+TEST_CASE("ResourceManager Bench - Load throughput with 10k open files" * doctest::skip()) {
+    constexpr u32 FileCount = 10'000;
+    constexpr u32 WindowSize = 1'000;
+
+    REQUIRE(RaiseOpenFilesLimit(FileCount + 256));
+
+    BenchDirectory dir("bench_load", FileCount);
+    ResourceManager::Init();
+
+    {
+        std::vector<ResourceManager::ManagedFileHandle> handles;
+        handles.reserve(FileCount);
+
+        // First pass: every load maps a new file while the amount of opened files keeps growing. With a hashed
+        // index the cost of the last window must be in the same ballpark as the first one.
+        std::vector<double> windows;
+        Clock::time_point total = Clock::now();
+        Clock::time_point window = total;
+
+        for (u32 i = 0; i < FileCount; ++i) {
+            Result<ResourceManager::ManagedFileHandle> handle = ResourceManager::Load(dir.files[i]);
+            REQUIRE(handle.IsOk());
+            handles.push_back(std::move(handle.Unwrap()));
+
+            if ((i + 1) % WindowSize == 0) {
+                windows.push_back(MicrosecondsSince(window));
+                window = Clock::now();
+            }
+        }
+        const double coldUs = MicrosecondsSince(total);
+
+        // Second pass: every file is already opened so each load is a pure duplicate lookup
+        Clock::time_point warm = Clock::now();
+        for (u32 i = 0; i < FileCount; ++i) {
+            Result<ResourceManager::ManagedFileHandle> handle = ResourceManager::Load(dir.files[i]);
+            REQUIRE(handle.IsOk());
+            CHECK_EQ(handle.Unwrap(), handles[i]);
+        }
+        const double warmUs = MicrosecondsSince(warm);
+
+        MESSAGE("Cold loads: " << FileCount << " files in " << coldUs / 1000.0 << " ms ("
+                               << FileCount / (coldUs / 1e6) << " loads/s)");
+        MESSAGE("Duplicate loads: " << FileCount << " files in " << warmUs / 1000.0 << " ms ("
+                                    << FileCount / (warmUs / 1e6) << " loads/s)");
+        MESSAGE("First " << WindowSize << " loads: " << windows.front() / 1000.0 << " ms, last " << WindowSize
+                         << " loads: " << windows.back() / 1000.0 << " ms");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Bench - DataConst reader scaling" * doctest::skip()) {
+    constexpr u32 Iterations = 200'000;
+    const u32 maxThreads = std::max(8u, std::thread::hardware_concurrency());
+
+    BenchDirectory dir("bench_readers", maxThreads);
+    ResourceManager::Init();
+
+    {
+        std::vector<ResourceManager::ManagedFileHandle> handles;
+        for (const std::filesystem::path& file : dir.files)
+            handles.push_back(ResourceManager::Load(file).Unwrap());
+
+        TempFile writable("bench_readers_writer.bin", 4096);
+        ResourceManager::ManagedFileHandle writer = ResourceManager::Load(writable.path, false).Unwrap();
+
+        for (u32 threads = 1; threads <= maxThreads; threads *= 2) {
+            const double same = MeasureReaders(threads, Iterations, handles, true, nullptr);
+            const double distinct = MeasureReaders(threads, Iterations, handles, false, nullptr);
+            const double contended = MeasureReaders(threads, Iterations, handles, false, &writer);
+
+            MESSAGE(threads << " readers: same file " << same / 1e6 << " M reads/s, own file " << distinct / 1e6
+                            << " M reads/s, own file + writer " << contended / 1e6 << " M reads/s");
+        }
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Bench - Loose files vs asset pack startup" * doctest::skip()) {
+    constexpr u32 FileCount = 2'000;
+
+    REQUIRE(RaiseOpenFilesLimit(FileCount + 256));
+
+    BenchDirectory dir("bench_pack", FileCount);
+    const std::filesystem::path packPath = "assets/tests/bench_pack.axpk";
+    WritePack(dir.files, dir.path, packPath);
+
+    // Loose: one open + mmap + close per file, every mapping is its own VMA
+    ResourceManager::Init();
+    {
+        std::vector<ResourceManager::ManagedFileHandle> handles;
+        handles.reserve(FileCount);
+
+        Clock::time_point start = Clock::now();
+        for (const std::filesystem::path& file : dir.files)
+            handles.push_back(ResourceManager::Load(file).Unwrap());
+        const double looseUs = MicrosecondsSince(start);
+
+        MESSAGE("Loose: " << FileCount << " files in " << looseUs / 1000.0 << " ms");
+    }
+    ResourceManager::ShutDown();
+
+    // Packed: a single mmap, every load is a TOC lookup. The loose files are hidden behind a mount point that
+    // doesn't exist on disk so the override check doesn't find them.
+    ResourceManager::Init();
+    {
+        std::vector<ResourceManager::ManagedFileHandle> handles;
+        handles.reserve(FileCount);
+
+        Clock::time_point start = Clock::now();
+        REQUIRE(ResourceManager::MountPack(packPath, "assets/tests/bench_pack_mount"));
+        for (const std::filesystem::path& file : dir.files)
+            handles.push_back(ResourceManager::Load("assets/tests/bench_pack_mount" / file.filename()).Unwrap());
+        const double packedUs = MicrosecondsSince(start);
+
+        MESSAGE("Packed: " << FileCount << " files in " << packedUs / 1000.0 << " ms (mount included)");
+    }
+    ResourceManager::ShutDown();
+
+    std::filesystem::remove(packPath);
+}
+
+TEST_CASE("ResourceManager Bench - Compressed vs uncompressed pack of assets/tests" * doctest::skip()) {
+    constexpr u32 Rounds = 5;
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& item : std::filesystem::recursive_directory_iterator("assets/tests")) {
+        if (item.is_regular_file() && item.file_size() > 0 && item.path().extension() != ".axpk")
+            files.push_back(item.path());
+    }
+
+    const std::filesystem::path rawPath = "assets/tests/bench_raw.axpk";
+    const std::filesystem::path compressedPath = "assets/tests/bench_compressed.axpk";
+    WritePack(files, "assets/tests", rawPath, false);
+    WritePack(files, "assets/tests", compressedPath, true);
+
+    // Loads every file and reads all of its bytes, returns the time in ms
+    auto loadAll = [&](const std::filesystem::path& pack, bool cold) {
+        if (cold)
+            EvictFromPageCache(pack);
+
+        ResourceManager::Init();
+        Clock::time_point start = Clock::now();
+        u64 checksum = 0;
+
+        REQUIRE(ResourceManager::MountPack(pack, "assets/bench_mount"));
+        for (const std::filesystem::path& file : files) {
+            auto handle = ResourceManager::Load("assets/bench_mount" / std::filesystem::relative(file, "assets/tests"));
+            REQUIRE(handle.IsOk());
+
+            auto guard = ResourceManager::DataConst(handle.Unwrap());
+            for (u64 i = 0; i < guard.Unwrap().Size(); i += 64)
+                checksum += static_cast<u8>(guard.Unwrap().Data()[i]);
+        }
+
+        const double elapsedMs = MicrosecondsSince(start) / 1000.0;
+        ResourceManager::ShutDown();
+
+        CHECK_NE(checksum, (u64) 0);
+        return elapsedMs;
+    };
+
+    u64 uncompressedBytes = 0;
+    for (const std::filesystem::path& file : files)
+        uncompressedBytes += std::filesystem::file_size(file);
+
+    MESSAGE(files.size() << " files, " << uncompressedBytes / 1024 << " KiB of data. Raw pack: "
+                         << std::filesystem::file_size(rawPath) / 1024
+                         << " KiB, compressed pack: " << std::filesystem::file_size(compressedPath) / 1024 << " KiB");
+
+    for (bool cold : {true, false}) {
+        double raw = 0.0;
+        double compressed = 0.0;
+
+        for (u32 round = 0; round < Rounds; ++round) {
+            raw += loadAll(rawPath, cold);
+            compressed += loadAll(compressedPath, cold);
+        }
+
+        MESSAGE((cold ? "Cold" : "Warm") << " page cache: raw " << raw / Rounds << " ms, compressed "
+                                         << compressed / Rounds << " ms");
+    }
+
+    std::filesystem::remove(rawPath);
+    std::filesystem::remove(compressedPath);
+}
+
+TEST_CASE("ResourceManager Bench - First touch latency per load mode" * doctest::skip()) {
+    constexpr u64 LargeSize = u64(64) << 20;
+    constexpr u64 SmallSize = u64(16) << 10;
+    constexpr u32 Rounds = 5;
+    constexpr u32 SmallRounds = 2000;
+
+    // Real data instead of a sparse file, so the pages come from the page cache or storage and not the zero page
+    auto writeFile = [](const std::filesystem::path& path, u64 size) {
+        std::string data(size, '\0');
+        for (u64 i = 0; i < size; ++i)
+            data[i] = static_cast<char>((i * 2654435761u) >> 13);
+        std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+    };
+
+    const std::filesystem::path large = "assets/tests/bench_large.bin";
+    const std::filesystem::path small = "assets/tests/bench_small.bin";
+    writeFile(large, LargeSize);
+    writeFile(small, SmallSize);
+
+    // Reads one byte per page, what the first pass of a decoder costs on top of its own work
+    auto touch = [](const ResourceManager::ReadGuard& guard) {
+        u64 sum = 0;
+        for (u64 i = 0; i < guard.Size(); i += 4096)
+            sum += static_cast<u8>(guard.Data()[i]);
+        return sum;
+    };
+
+    using Options = ResourceManager::LoadOptions;
+    struct Mode {
+        const char* name;
+        Options options;
+    };
+
+    std::vector<Mode> modes = {{"default", {}},
+                               {"prefault", {}},
+                               {"sequential", {}},
+                               {"random", {}},
+                               {"huge pages", {}},
+                               {"heap copy", {}}};
+    modes[1].options.prefault = true;
+    modes[2].options.access = Options::Access::Sequential;
+    modes[3].options.access = Options::Access::Random;
+    modes[4].options.hugePages = true;
+    modes[5].options.heapCopyMaxSize = LargeSize;
+
+    u64 checksum = 0;
+
+    for (bool cold : {true, false}) {
+        for (const Mode& mode : modes) {
+            double loadUs = 0.0;
+            double touchUs = 0.0;
+
+            for (u32 round = 0; round < Rounds; ++round) {
+                if (cold)
+                    EvictFromPageCache(large);
+
+                ResourceManager::Init();
+
+                Clock::time_point start = Clock::now();
+                auto handle = ResourceManager::Load(large, mode.options);
+                REQUIRE(handle.IsOk());
+                loadUs += MicrosecondsSince(start);
+
+                start = Clock::now();
+                checksum += touch(ResourceManager::DataConst(handle.Unwrap()).Unwrap());
+                touchUs += MicrosecondsSince(start);
+
+                ResourceManager::ShutDown();
+            }
+
+            MESSAGE("64 MiB, " << (cold ? "cold" : "warm") << ", " << mode.name << ": load " << loadUs / Rounds / 1000.0
+                               << " ms, first touch " << touchUs / Rounds / 1000.0 << " ms, total "
+                               << (loadUs + touchUs) / Rounds / 1000.0 << " ms");
+        }
+    }
+
+    // Small files, where setting up the mapping costs more than reading the data
+    ResourceManager::Init();
+
+    for (u32 index : {0u, 1u, 5u}) {
+        Options options = modes[index].options;
+        options.heapCopyMaxSize = index == 5 ? SmallSize : 0;
+
+        Clock::time_point start = Clock::now();
+
+        for (u32 round = 0; round < SmallRounds; ++round) {
+            auto handle = ResourceManager::Load(small, options);
+            REQUIRE(handle.IsOk());
+            checksum += touch(ResourceManager::DataConst(handle.Unwrap()).Unwrap());
+        }
+
+        MESSAGE("16 KiB, warm, " << modes[index].name << ": load + first touch + close "
+                                 << MicrosecondsSince(start) / SmallRounds << " us");
+    }
+
+    ResourceManager::ShutDown();
+
+    CHECK_NE(checksum, (u64) 0);
+    std::filesystem::remove(large);
+    std::filesystem::remove(small);
+}
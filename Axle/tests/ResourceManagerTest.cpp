@@ -3,14 +3,23 @@
 #include "Core/Logger/Log.hpp"
 #include "Core/Types.hpp"
 #include "Core/Resource/ResourceManager.hpp"
+#include "Core/Resource/FileWatcher.hpp"
+#include "Core/Resource/AssetPack.hpp"
+#include "Core/Resource/BufferPool.hpp"
+#include "Core/Resource/Lz4.hpp"
+#include "Core/Resource/XxHash.hpp"
 #include "Core/Error/Result.hpp"
 
+#include <CoroWeaver.hpp>
+
 #include <filesystem>
+#include <fstream>
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <barrier>
 #include <deque>
+#include <optional>
 
 using namespace Axle;
 
@@ -35,7 +44,7 @@ TEST_CASE("ResourceManager - Created correctly") {
     ResourceManager::Init();
 
     CHECK_EQ(ResourceManager::LargestAvailableIndex(), 0);
-    CHECK_EQ(ResourceManager::MagicNumberCounter(), 0);
+    CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 0);
     CHECK(ResourceManager::AvailableIndexes().empty());
 
     ResourceManager::ShutDown();
@@ -57,8 +66,8 @@ TEST_CASE("ResourceManager - Load valid file") {
         FileHandle handle = eHandle.Unwrap().Get();
 
         CHECK(ResourceManager::AvailableIndexes().empty());
-        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u16) 1);
-        CHECK_EQ(ResourceManager::MagicNumberCounter(), (u16) 1);
+        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 1);
+        CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 0);
 
         CHECK_EQ(ResourceManager::GetIndexFromHandle(handle), (u16) 0);
         CHECK_EQ(ResourceManager::GetMagicFromHandle(handle), (u16) 0);
@@ -100,8 +109,53 @@ TEST_CASE("ResourceManager - Load same file twice returns same handle") {
 
         // Same file — should return the same handle, no new index allocated
         CHECK_EQ(eHandle1.Unwrap(), eHandle2.Unwrap());
-        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u16) 1);
-        CHECK_EQ(ResourceManager::MagicNumberCounter(), (u16) 1);
+        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 1);
+        CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 0);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager - Different spellings of the same path return same handle") {
+    ResourceManager::Init();
+
+    {
+        Result<ResourceManager::ManagedFileHandle> eHandle1 = ResourceManager::Load("assets/tests/valid.txt");
+        Result<ResourceManager::ManagedFileHandle> eHandle2 = ResourceManager::Load("./assets/tests/../tests/valid.txt");
+        Result<ResourceManager::ManagedFileHandle> eHandle3 =
+            ResourceManager::Load(std::filesystem::absolute("assets/tests/valid.txt"));
+
+        REQUIRE(eHandle1.IsOk());
+        REQUIRE(eHandle2.IsOk());
+        REQUIRE(eHandle3.IsOk());
+
+        CHECK_EQ(eHandle1.Unwrap(), eHandle2.Unwrap());
+        CHECK_EQ(eHandle1.Unwrap(), eHandle3.Unwrap());
+        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 1);
+        CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 0);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager - Closed file is removed from the path index") {
+    ResourceManager::Init();
+
+    FileHandle h1;
+
+    {
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(eHandle.IsOk());
+        h1 = eHandle.Unwrap().Get();
+    }
+
+    {
+        // The file was closed so loading it again must map it anew instead of returning the stale handle
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(eHandle.IsOk());
+        CHECK_NE(eHandle.Unwrap().Get(), h1);
+        CHECK(ResourceManager::IsHandleValid(eHandle.Unwrap().Get()));
+        CHECK_EQ(ResourceManager::GetMagicFromHandle(eHandle.Unwrap().Get()), (u32) 1);
     }
 
     ResourceManager::ShutDown();
@@ -123,7 +177,7 @@ TEST_CASE("ResourceManager - Load multiple different files") {
         // Different handles
         CHECK_NE(h1, h2);
         CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 2);
-        CHECK_EQ(ResourceManager::MagicNumberCounter(), (u32) 2);
+        CHECK_EQ(ResourceManager::SlotGeneration(1), (u32) 0);
 
         // Different indexes
         CHECK_EQ(ResourceManager::GetIndexFromHandle(h1), (u32) 0);
@@ -185,7 +239,7 @@ TEST_CASE("ResourceManager - Close releases index for reuse") {
 
     // Index 0 should now be available again
     REQUIRE_FALSE(ResourceManager::AvailableIndexes().empty());
-    CHECK_EQ(ResourceManager::AvailableIndexes().top(), (u32) 0);
+    CHECK_EQ(ResourceManager::AvailableIndexes().front(), (u32) 0);
 
     {
         // Loading a new file should reuse index 0
@@ -200,7 +254,7 @@ TEST_CASE("ResourceManager - Close releases index for reuse") {
     CHECK_NE(ResourceManager::GetMagicFromHandle(h1h), ResourceManager::GetMagicFromHandle(h2h));
 
     CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 1);
-    CHECK_EQ(ResourceManager::MagicNumberCounter(), (u32) 2);
+    CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 2);
 
     ResourceManager::ShutDown();
 }
@@ -303,7 +357,7 @@ TEST_CASE("ResourceManager - ShutDown closes all open files") {
         // Re-init to verify clean state
         ResourceManager::Init();
         CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 0);
-        CHECK_EQ(ResourceManager::MagicNumberCounter(), (u32) 0);
+        CHECK_EQ(ResourceManager::SlotGeneration(0), (u32) 0);
     }
 
     ResourceManager::ShutDown();
@@ -340,9 +394,9 @@ TEST_CASE("ResourceManager MT - Concurrent loads of the same file return the sam
         for (int i = 1; i < THREAD_COUNT; ++i)
             CHECK_EQ(handles[i], first);
 
-        // Only one resource should have been allocated
-        CHECK_EQ(ResourceManager::LargestAvailableIndex(), (u32) 1);
-        CHECK_EQ(ResourceManager::MagicNumberCounter(), (u32) 1);
+        // Only one resource should be alive, the slots claimed by the threads that lost the race were given back
+        CHECK_EQ(ResourceManager::LargestAvailableIndex() - ResourceManager::AvailableIndexes().size(), (u32) 1);
+        CHECK_EQ(ResourceManager::SlotGeneration(ResourceManager::GetIndexFromHandle(first.Get())), (u32) 0);
     }
 
     ResourceManager::ShutDown();
@@ -394,6 +448,58 @@ TEST_CASE("ResourceManager MT - Concurrent loads of different files allocate uni
     ResourceManager::ShutDown();
 }
 
+TEST_CASE("ResourceManager MT - Concurrent loads and closes recycle the freed slots") {
+    ResourceManager::Init();
+
+    {
+        constexpr int THREAD_COUNT = 8;
+        constexpr int ROUNDS = 200;
+        std::vector<std::string> paths;
+        for (int i = 0; i < THREAD_COUNT; ++i) {
+            std::string p = "assets/tests/mt_churn_" + std::to_string(i) + ".bin";
+            ResourceManager::Create(p, 64);
+            paths.push_back(p);
+        }
+
+        std::vector<std::thread> threads;
+        std::atomic<int> failures = 0;
+
+        for (int i = 0; i < THREAD_COUNT; ++i) {
+            threads.emplace_back([&, i]() {
+                FileHandle previous = INVALID_FILE_HANDLE;
+
+                for (int round = 0; round < ROUNDS; ++round) {
+                    auto eHandle = ResourceManager::Load(paths[i]);
+                    if (eHandle.IsErr() || eHandle.Unwrap().Get() == previous) {
+                        failures.fetch_add(1);
+                        continue;
+                    }
+
+                    previous = eHandle.Unwrap().Get();
+                    // The handle is closed when it goes out of scope
+                }
+
+                // Stale handles are rejected even though their slot was reused
+                if (ResourceManager::IsHandleValid(previous))
+                    failures.fetch_add(1);
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+
+        CHECK_EQ(failures.load(), 0);
+        // Every closed slot went back to the free list instead of growing the table
+        CHECK_LE(ResourceManager::LargestAvailableIndex(), (u32) THREAD_COUNT);
+        CHECK_EQ(ResourceManager::AvailableIndexes().size(), ResourceManager::LargestAvailableIndex());
+
+        for (auto& p : paths)
+            std::filesystem::remove(p);
+    }
+
+    ResourceManager::ShutDown();
+}
+
 TEST_CASE("ResourceManager MT - Concurrent DataConst reads do not block each other") {
     ResourceManager::Init();
 
@@ -566,6 +672,43 @@ TEST_CASE("ResourceManager MT - Write guard blocks other writes") {
     ResourceManager::ShutDown();
 }
 
+TEST_CASE("ResourceManager MT - Write guard only blocks its own resource") {
+    ResourceManager::Init();
+
+    {
+        TempFile locked("mt_locked.bin", 64);
+        TempFile other("mt_other.bin", 64);
+
+        ResourceManager::ManagedFileHandle lockedHandle = ResourceManager::Load(locked.path, false).Unwrap();
+        ResourceManager::ManagedFileHandle otherHandle = ResourceManager::Load(other.path, false).Unwrap();
+
+        std::atomic<bool> done = false;
+
+        {
+            auto guard = ResourceManager::Data(lockedHandle);
+            REQUIRE(guard.IsOk());
+
+            // While the guard is alive another thread must be able to use the rest of the table
+            std::thread t([&]() {
+                CHECK(ResourceManager::DataConst(otherHandle).IsOk());
+                CHECK(ResourceManager::Data(otherHandle).IsOk());
+                CHECK_EQ(ResourceManager::Size(lockedHandle).Unwrap(), (u64) 64);
+                CHECK_FALSE(ResourceManager::IsReadOnly(lockedHandle).Unwrap());
+                CHECK(ResourceManager::IsHandleValid(lockedHandle.Get()));
+
+                ResourceManager::ManagedFileHandle copy = lockedHandle;
+                CHECK(ResourceManager::Load("assets/tests/valid.txt").IsOk());
+                done.store(true, std::memory_order_release);
+            });
+            t.join();
+        }
+
+        CHECK(done.load(std::memory_order_acquire));
+    }
+
+    ResourceManager::ShutDown();
+}
+
 TEST_CASE("ResourceManager MT - Concurrent load and read do not race") {
     ResourceManager::Init();
 
@@ -783,9 +926,9 @@ TEST_CASE("ResourceManager Resize - Multiple consecutive resizes") {
     ResourceManager::ShutDown();
 }
 
-TEST_CASE("ResourceManager Resize MT - Resize blocks until active ReadGuard is released") {
+TEST_CASE("ResourceManager Resize MT - Shrinking blocks until active ReadGuard is released") {
     ResourceManager::Init();
-    TempFile tmp("resize_mt_block_read.bin", 64);
+    TempFile tmp("resize_mt_block_read.bin", 128);
 
     {
         auto eHandle = ResourceManager::Load(tmp.path);
@@ -819,7 +962,7 @@ TEST_CASE("ResourceManager Resize MT - Resize blocks until active ReadGuard is r
             while (!resizeStarted.load())
                 std::this_thread::yield();
 
-            ResourceManager::Resize(handle.Get(), 128);
+            ResourceManager::Resize(handle.Get(), 64);
             resizeDone.store(true);
         });
 
@@ -829,15 +972,15 @@ TEST_CASE("ResourceManager Resize MT - Resize blocks until active ReadGuard is r
         // Resize must have happened after the guard was released
         CHECK(guardReleased.load());
         CHECK(resizeDone.load());
-        CHECK_EQ(ResourceManager::Size(handle).Unwrap(), (u64) 128);
+        CHECK_EQ(ResourceManager::Size(handle).Unwrap(), (u64) 64);
     }
 
     ResourceManager::ShutDown();
 }
 
-TEST_CASE("ResourceManager Resize MT - Resize blocks until active WriteGuard is released") {
+TEST_CASE("ResourceManager Resize MT - Shrinking blocks until active WriteGuard is released") {
     ResourceManager::Init();
-    TempFile tmp("resize_mt_block_write.bin", 64);
+    TempFile tmp("resize_mt_block_write.bin", 128);
 
     {
         auto eHandle = ResourceManager::Load(tmp.path, false);
@@ -864,7 +1007,7 @@ TEST_CASE("ResourceManager Resize MT - Resize blocks until active WriteGuard is
             while (!resizeStarted.load())
                 std::this_thread::yield();
 
-            ResourceManager::Resize(handle.Get(), 128);
+            ResourceManager::Resize(handle.Get(), 64);
             resizeDone.store(true);
         });
 
@@ -873,7 +1016,94 @@ TEST_CASE("ResourceManager Resize MT - Resize blocks until active WriteGuard is
 
         CHECK(guardReleased.load());
         CHECK(resizeDone.load());
-        CHECK_EQ(ResourceManager::Size(handle).Unwrap(), (u64) 128);
+        CHECK_EQ(ResourceManager::Size(handle).Unwrap(), (u64) 64);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Resize MT - Growing does not wait for guards") {
+    ResourceManager::Init();
+    TempFile tmp("resize_mt_grow_guarded.bin", 64);
+
+    {
+        auto eHandle = ResourceManager::Load(tmp.path, false);
+        REQUIRE(eHandle.IsOk());
+        ResourceManager::ManagedFileHandle handle = eHandle.Unwrap();
+
+        {
+            // Used to deadlock, the resize waited for this very guard
+            auto guard = ResourceManager::Data(handle);
+            REQUIRE(guard.IsOk());
+            REQUIRE(ResourceManager::Resize(handle, 8192));
+
+            // The guard still points to the old mapping, which sees the same pages as the new one
+            CHECK_EQ(guard.Unwrap().Size(), (u64) 64);
+            std::memcpy(guard.Unwrap().Data(), "before", 6);
+        }
+
+        auto reader = ResourceManager::DataConst(handle);
+        REQUIRE(reader.IsOk());
+        REQUIRE(ResourceManager::Resize(handle, 16384));
+
+        CHECK_EQ(reader.Unwrap().Size(), (u64) 8192);
+        CHECK_EQ(std::string_view(reader.Unwrap().Data(), 6), "before");
+
+        auto after = ResourceManager::DataConst(handle);
+        REQUIRE(after.IsOk());
+        CHECK_EQ(after.Unwrap().Size(), (u64) 16384);
+        CHECK_EQ(std::string_view(after.Unwrap().Data(), 6), "before");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Resize MT - Readers keep reading while a file grows") {
+    ResourceManager::Init();
+    TempFile tmp("resize_mt_grow_readers.bin", 4096);
+
+    {
+        auto eHandle = ResourceManager::Load(tmp.path, false);
+        REQUIRE(eHandle.IsOk());
+        ResourceManager::ManagedFileHandle handle = eHandle.Unwrap();
+
+        {
+            auto guard = ResourceManager::Data(handle);
+            REQUIRE(guard.IsOk());
+            std::memset(guard.Unwrap().Data(), 'a', guard.Unwrap().Size());
+        }
+
+        constexpr int THREAD_COUNT = 4;
+        constexpr u64 GROWTHS = 64;
+        std::atomic<bool> done = false;
+        std::atomic<int> failures = 0;
+        std::vector<std::thread> readers;
+
+        // Every reader holds its guard while the file keeps growing, the last byte it can see must stay readable
+        for (int i = 0; i < THREAD_COUNT; ++i) {
+            readers.emplace_back([&]() {
+                while (!done.load()) {
+                    auto guard = ResourceManager::DataConst(handle);
+                    if (guard.IsErr() || guard.Unwrap().Size() < 4096 || guard.Unwrap().Data()[0] != 'a') {
+                        failures.fetch_add(1);
+                        continue;
+                    }
+
+                    volatile char last = guard.Unwrap().Data()[guard.Unwrap().Size() - 1];
+                    (void) last;
+                }
+            });
+        }
+
+        for (u64 i = 2; i <= GROWTHS; ++i)
+            CHECK(ResourceManager::Resize(handle, i * 4096));
+
+        done.store(true);
+        for (auto& t : readers)
+            t.join();
+
+        CHECK_EQ(failures.load(), 0);
+        CHECK_EQ(ResourceManager::Size(handle).Unwrap(), GROWTHS * 4096);
     }
 
     ResourceManager::ShutDown();
@@ -952,3 +1182,1237 @@ TEST_CASE("ResourceManager Resize MT - Concurrent resizes on different files") {
 
     ResourceManager::ShutDown();
 }
+
+// Async loading
+// -------------
+
+using HandleResult = Result<ResourceManager::ManagedFileHandle>;
+
+static cw::JobCoroutine<void> AwaitLoadAsync(std::filesystem::path path,
+                                             std::optional<HandleResult>* out,
+                                             std::atomic<bool>* done) {
+    auto [result] = co_await cw::WhenAll(ResourceManager::LoadAsync(path, true, true));
+    out->emplace(std::move(result));
+    done->store(true, std::memory_order_release);
+}
+
+static cw::JobCoroutine<void> AwaitLoadBatchAsync(std::vector<std::filesystem::path> paths,
+                                                  std::vector<HandleResult>* out,
+                                                  std::atomic<bool>* done) {
+    auto [results] = co_await cw::WhenAll(ResourceManager::LoadBatchAsync(std::move(paths), true, true));
+    *out = std::move(results);
+    done->store(true, std::memory_order_release);
+}
+
+// The calling thread is the only worker, it runs jobs until the test coroutine is done
+static void RunJobsUntil(const std::atomic<bool>& done) {
+    while (!done.load(std::memory_order_acquire))
+        cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(5));
+}
+
+TEST_CASE("ResourceManager Async - LoadAsync returns a resident handle") {
+    ResourceManager::Init();
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        std::optional<HandleResult> result;
+        std::atomic<bool> done = false;
+
+        cw::JobCoroutine<void> job = AwaitLoadAsync("assets/tests/valid.txt", &result, &done);
+        CW_SCHEDULE(job, cw::JobPriority::Medium, cw::InvalidThreadIndex, cw::InvalidTag, "LoadAsync");
+        RunJobsUntil(done);
+
+        REQUIRE(result.has_value());
+        REQUIRE(result->IsOk());
+
+        // Same file loaded synchronously must share the handle
+        Result<ResourceManager::ManagedFileHandle> sync = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(sync.IsOk());
+        CHECK_EQ(sync.Unwrap(), result->Unwrap());
+
+        auto guard = ResourceManager::DataConst(result->Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK_EQ(guard.Unwrap().Size(), (u64) 21);
+        CHECK_EQ(std::string_view(guard.Unwrap().Data(), 5), "This ");
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Async - LoadAsync of a non-existing file fails") {
+    ResourceManager::Init();
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        std::optional<HandleResult> result;
+        std::atomic<bool> done = false;
+
+        cw::JobCoroutine<void> job = AwaitLoadAsync("assets/tests/novalid.txt", &result, &done);
+        CW_SCHEDULE(job, cw::JobPriority::Medium, cw::InvalidThreadIndex, cw::InvalidTag, "LoadAsync");
+        RunJobsUntil(done);
+
+        REQUIRE(result.has_value());
+        CHECK(result->IsErr());
+        CHECK_EQ(result->UnwrapErr().code, ErrorCode::NotFound);
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Async - LoadBatchAsync keeps the order of the paths") {
+    ResourceManager::Init();
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        std::vector<HandleResult> results;
+        std::atomic<bool> done = false;
+
+        cw::JobCoroutine<void> job = AwaitLoadBatchAsync(
+            {"assets/tests/valid.txt", "assets/tests/novalid.txt", "assets/tests/valid2.bin"}, &results, &done);
+        CW_SCHEDULE(job, cw::JobPriority::Medium, cw::InvalidThreadIndex, cw::InvalidTag, "LoadBatchAsync");
+        RunJobsUntil(done);
+
+        REQUIRE_EQ(results.size(), (size_t) 3);
+        REQUIRE(results[0].IsOk());
+        CHECK(results[1].IsErr());
+        REQUIRE(results[2].IsOk());
+
+        CHECK_EQ(ResourceManager::GetPath(results[0].Unwrap()).Unwrap(), "assets/tests/valid.txt");
+        CHECK_EQ(ResourceManager::GetPath(results[2].Unwrap()).Unwrap(), "assets/tests/valid2.bin");
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager - Prefetch") {
+    ResourceManager::Init();
+
+    {
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(eHandle.IsOk());
+
+        CHECK(ResourceManager::Prefetch(eHandle.Unwrap()));
+        CHECK(ResourceManager::Prefetch(eHandle.Unwrap(), true));
+
+        // Invalid handles are rejected
+        CHECK_FALSE(ResourceManager::Prefetch(ResourceManager::ManagedFileHandle()));
+    }
+
+    ResourceManager::ShutDown();
+}
+
+// Writes a pack the same way AAP's pack subcommand does
+struct TempPack {
+    std::filesystem::path path;
+
+    TempPack(const std::string& name,
+             const std::vector<std::pair<std::string, std::string>>& files,
+             bool compress = false,
+             u32 chunkSize = AssetPack::DEFAULT_CHUNK_SIZE)
+        : path("assets/tests/" + name) {
+        std::vector<AssetPack::TocFile> tocFiles;
+        std::vector<std::string> stored;
+
+        for (const auto& [file, content] : files) {
+            stored.push_back(compress ? AssetPack::CompressChunked(content.data(), content.size(), chunkSize)
+                                      : content);
+            tocFiles.push_back({file,
+                                content.size(),
+                                stored.back().size(),
+                                compress ? AssetPack::ENTRY_COMPRESSED : 0u,
+                                XxHash::Hash64(content.data(), content.size())});
+        }
+
+        AssetPack::Toc toc = AssetPack::BuildToc(tocFiles, AssetPack::DEFAULT_ALIGNMENT, chunkSize);
+
+        std::string data(toc.header.packSize, '\0');
+        std::memcpy(data.data(), &toc.header, sizeof(toc.header));
+        std::memcpy(
+            data.data() + toc.header.tocOffset, toc.entries.data(), toc.entries.size() * sizeof(AssetPack::Entry));
+        std::memcpy(data.data() + toc.header.namesOffset, toc.names.data(), toc.names.size());
+        for (size_t i = 0; i < stored.size(); ++i)
+            std::memcpy(data.data() + toc.offsets[i], stored[i].data(), stored[i].size());
+
+        std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+    }
+
+    ~TempPack() {
+        std::filesystem::remove(path);
+    }
+};
+
+TEST_CASE("ResourceManager Pack - Mounted files are sub-ranges of the pack") {
+    ResourceManager::Init();
+
+    {
+        TempPack pack("test.axpk", {{"a.txt", "first packed file"}, {"dir/b.bin", "second"}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        Result<ResourceManager::ManagedFileHandle> eA = ResourceManager::Load("assets/tests/packed/a.txt");
+        Result<ResourceManager::ManagedFileHandle> eB = ResourceManager::Load("assets/tests/packed/./dir/b.bin");
+        REQUIRE(eA.IsOk());
+        REQUIRE(eB.IsOk());
+        CHECK_NE(eA.Unwrap(), eB.Unwrap());
+
+        CHECK(ResourceManager::IsReadOnly(eA.Unwrap()).Unwrap());
+        CHECK_EQ(ResourceManager::Size(eB.Unwrap()).Unwrap(), (u64) 6);
+        CHECK_EQ(ResourceManager::GetPath(eA.Unwrap()).Unwrap(), "assets/tests/packed/a.txt");
+
+        auto guardA = ResourceManager::DataConst(eA.Unwrap());
+        auto guardB = ResourceManager::DataConst(eB.Unwrap());
+        REQUIRE(guardA.IsOk());
+        REQUIRE(guardB.IsOk());
+        CHECK_EQ(std::string_view(guardA.Unwrap().Data(), guardA.Unwrap().Size()), "first packed file");
+        CHECK_EQ(std::string_view(guardB.Unwrap().Data(), guardB.Unwrap().Size()), "second");
+
+        // Both live in the same mapping, each one on its own page
+        CHECK_EQ(guardB.Unwrap().Data() - guardA.Unwrap().Data(), (std::ptrdiff_t) AssetPack::DEFAULT_ALIGNMENT);
+        CHECK_EQ(reinterpret_cast<uintptr_t>(guardA.Unwrap().Data()) % AssetPack::DEFAULT_ALIGNMENT, (uintptr_t) 0);
+
+        // Paths outside the mount point or not in the pack aren't found
+        CHECK_EQ(ResourceManager::Load("assets/tests/packed/c.txt").UnwrapErr().code, ErrorCode::NotFound);
+        CHECK_EQ(ResourceManager::Load("assets/a.txt").UnwrapErr().code, ErrorCode::NotFound);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Loose files override packed ones") {
+    ResourceManager::Init();
+
+    {
+        TempPack pack("test.axpk", {{"valid.txt", "packed"}, {"only_packed.txt", "only in the pack"}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests"));
+
+        Result<ResourceManager::ManagedFileHandle> loose = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(loose.IsOk());
+        CHECK_EQ(ResourceManager::Size(loose.Unwrap()).Unwrap(), (u64) 21);
+
+        Result<ResourceManager::ManagedFileHandle> packed = ResourceManager::Load("assets/tests/only_packed.txt");
+        REQUIRE(packed.IsOk());
+        CHECK_EQ(ResourceManager::Size(packed.Unwrap()).Unwrap(), (u64) 16);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Packed files are read-only") {
+    ResourceManager::Init();
+
+    {
+        TempPack pack("test.axpk", {{"a.txt", "first packed file"}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        CHECK_EQ(ResourceManager::Load("assets/tests/packed/a.txt", false).UnwrapErr().code,
+                 ErrorCode::InvalidArgument);
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/a.txt");
+        REQUIRE(eHandle.IsOk());
+        CHECK(ResourceManager::Data(eHandle.Unwrap()).IsErr());
+        CHECK_FALSE(ResourceManager::Sync(eHandle.Unwrap()));
+        CHECK_FALSE(ResourceManager::Resize(eHandle.Unwrap(), 128));
+        CHECK(ResourceManager::Prefetch(eHandle.Unwrap(), true));
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Mounting invalid packs fails") {
+    ResourceManager::Init();
+
+    CHECK_FALSE(ResourceManager::MountPack("assets/tests/novalid.axpk", "assets"));
+    CHECK_FALSE(ResourceManager::MountPack("assets/tests/valid.txt", "assets"));
+
+    {
+        TempPack pack("test.axpk", {{"a.txt", "first packed file"}});
+        CHECK(ResourceManager::MountPack(pack.path, "assets"));
+        CHECK_FALSE(ResourceManager::MountPack("./" + pack.path.string(), "assets"));
+        CHECK(ResourceManager::UnmountPack(pack.path));
+        CHECK_FALSE(ResourceManager::UnmountPack(pack.path));
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Loaded files outlive the unmounted pack") {
+    ResourceManager::Init();
+
+    {
+        TempPack pack("test.axpk", {{"a.txt", "first packed file"}, {"b.txt", "second"}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/a.txt");
+        REQUIRE(eHandle.IsOk());
+        REQUIRE(ResourceManager::UnmountPack(pack.path));
+
+        auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK_EQ(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()), "first packed file");
+
+        CHECK(ResourceManager::Load("assets/tests/packed/b.txt").IsErr());
+    }
+
+    ResourceManager::ShutDown();
+}
+
+// Text-like data that compresses, with some noise so not every chunk is trivial
+static std::string CompressibleData(size_t size) {
+    std::string data;
+    u32 seed = 12345;
+
+    while (data.size() < size) {
+        seed = seed * 1103515245 + 12345;
+        data += "vertex " + std::to_string(seed % 1000) + " normal 0.0 1.0 0.0\n";
+    }
+
+    data.resize(size);
+    return data;
+}
+
+TEST_CASE("Lz4 - Round trip") {
+    u32 seed = 42;
+    std::string random(100'000, '\0');
+    for (char& c : random) {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>(seed >> 24);
+    }
+
+    const std::vector<std::string> inputs = {
+        "", "a", "short text", std::string(100'000, 'x'), CompressibleData(300'000), random};
+
+    for (const std::string& input : inputs) {
+        std::string compressed(Lz4::CompressBound(input.size()), '\0');
+        const size_t size = Lz4::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+        REQUIRE_NE(size, (size_t) 0);
+
+        std::string output(input.size(), '\0');
+        CHECK(Lz4::Decompress(compressed.data(), size, output.data(), output.size()));
+        CHECK(output == input);
+    }
+
+    // Repetitive data must actually shrink
+    const std::string text = CompressibleData(300'000);
+    std::string compressed(Lz4::CompressBound(text.size()), '\0');
+    CHECK_LT(Lz4::Compress(text.data(), text.size(), compressed.data(), compressed.size()), text.size() / 2);
+}
+
+TEST_CASE("Lz4 - Corrupted input is rejected") {
+    const std::string text = CompressibleData(10'000);
+    std::string compressed(Lz4::CompressBound(text.size()), '\0');
+    compressed.resize(Lz4::Compress(text.data(), text.size(), compressed.data(), compressed.size()));
+
+    std::string output(text.size(), '\0');
+
+    // Truncated
+    CHECK_FALSE(Lz4::Decompress(compressed.data(), compressed.size() / 2, output.data(), output.size()));
+    // Wrong decompressed size
+    CHECK_FALSE(Lz4::Decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+
+    // Offsets pointing before the beginning of the output
+    std::string bad = {char(0x10), 'a', char(0xFF), char(0xFF), char(0x00)};
+    CHECK_FALSE(Lz4::Decompress(bad.data(), bad.size(), output.data(), output.size()));
+}
+
+TEST_CASE("BufferPool - Released buffers are reused") {
+    BufferPool pool(1 << 20);
+
+    char* first;
+    {
+        BufferPool::Buffer buffer = pool.Acquire(10'000);
+        REQUIRE(buffer.IsValid());
+        CHECK_EQ(buffer.Size(), (u64) 10'000);
+        CHECK_GE(buffer.Capacity(), (u64) 10'000);
+        CHECK_LE(buffer.Capacity(), (u64) 12'500);
+        first = buffer.Data();
+    }
+
+    CHECK_GT(pool.GetStats().retainedBytes, (u64) 0);
+
+    // A similar size lands in the same class
+    {
+        BufferPool::Buffer buffer = pool.Acquire(9'000);
+        CHECK_EQ(buffer.Data(), first);
+        CHECK_EQ(pool.GetStats().reused, (u64) 1);
+        CHECK_EQ(pool.GetStats().retainedBytes, (u64) 0);
+    }
+
+    // Over the retention limit buffers are freed
+    { BufferPool::Buffer buffer = pool.Acquire(2 << 20); }
+    CHECK_LE(pool.GetStats().retainedBytes, (u64) 1 << 20);
+
+    pool.Trim();
+    CHECK_EQ(pool.GetStats().retainedBytes, (u64) 0);
+    CHECK_EQ(pool.GetStats().acquired, (u64) 3);
+}
+
+TEST_CASE("ResourceManager Pack - Compressed files are decompressed into pooled buffers") {
+    ResourceManager::Init();
+
+    {
+        const std::string big = CompressibleData(100'000);
+        TempPack pack("test.axpk", {{"big.txt", big}, {"small.txt", "tiny"}}, true, 4096);
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        // Only the file that shrank is smaller in the pack
+        CHECK_LT(std::filesystem::file_size(pack.path), big.size());
+
+        const char* first;
+        {
+            Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/big.txt");
+            REQUIRE(eHandle.IsOk());
+            CHECK_EQ(ResourceManager::Size(eHandle.Unwrap()).Unwrap(), (u64) big.size());
+
+            auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == big);
+            first = guard.Unwrap().Data();
+
+            auto small = ResourceManager::Load("assets/tests/packed/small.txt");
+            REQUIRE(small.IsOk());
+            auto smallGuard = ResourceManager::DataConst(small.Unwrap());
+            CHECK_EQ(std::string_view(smallGuard.Unwrap().Data(), smallGuard.Unwrap().Size()), "tiny");
+        }
+
+        // Closing the file gave the buffer back, loading it again reuses it
+        const u64 reused = ResourceManager::GetBufferPoolStats().reused;
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/big.txt");
+        REQUIRE(eHandle.IsOk());
+        CHECK_EQ(ResourceManager::DataConst(eHandle.Unwrap()).Unwrap().Data(), first);
+        CHECK_EQ(ResourceManager::GetBufferPoolStats().reused, reused + 1);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Compressed files are decompressed with the job system running") {
+    ResourceManager::Init();
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        const std::string big = CompressibleData(500'000);
+        TempPack pack("test.axpk", {{"big.txt", big}}, true, 4096);
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/big.txt");
+        REQUIRE(eHandle.IsOk());
+
+        auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+        CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == big);
+
+        // Helpers scheduled after every chunk was taken simply exit
+        cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(10));
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Pack - Corrupted compressed files fail to load") {
+    ResourceManager::Init();
+
+    {
+        const std::string big = CompressibleData(50'000);
+        TempPack pack("test.axpk", {{"big.txt", big}}, true, 4096);
+
+        // Flip the bytes of the second chunk
+        {
+            std::fstream file(pack.path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekg(0, std::ios::end);
+            const std::streamoff size = file.tellg();
+            file.seekp(size - 500);
+            const std::string garbage(64, char(0xF0));
+            file.write(garbage.data(), garbage.size());
+        }
+
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load("assets/tests/packed/big.txt");
+        REQUIRE(eHandle.IsErr());
+        CHECK_EQ(eHandle.UnwrapErr().code, ErrorCode::AssetLoadFailed);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+// Residency
+// ---------
+
+static void WriteFile(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream(path, std::ios::binary).write(content.data(), content.size());
+}
+
+TEST_CASE("ResourceManager Residency - Idle files are evicted and mapped again on access") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("residency.txt", 0);
+        const std::string content(10'000, 'r');
+        WriteFile(file.path, content);
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path);
+        REQUIRE(eHandle.IsOk());
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) content.size());
+
+        const auto before = ResourceManager::GetResidency(eHandle.Unwrap()).Unwrap().lastAccess;
+
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), (u64) content.size());
+        CHECK_FALSE(ResourceManager::GetResidency(eHandle.Unwrap()).Unwrap().resident);
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 0);
+        CHECK_EQ(ResourceManager::GetResidencyStats().evictions, (u64) 1);
+
+        // The size is still known and the handle is still valid
+        CHECK_EQ(ResourceManager::Size(eHandle.Unwrap()).Unwrap(), (u64) content.size());
+        CHECK(ResourceManager::IsHandleValid(eHandle.Unwrap().Get()));
+
+        {
+            auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == content);
+        }
+
+        ResourceManager::ResidencyInfo info = ResourceManager::GetResidency(eHandle.Unwrap()).Unwrap();
+        CHECK(info.resident);
+        CHECK_EQ(info.evictions, (u32) 1);
+        CHECK_GT(info.lastAccess, before);
+        CHECK_EQ(ResourceManager::GetResidencyStats().restores, (u64) 1);
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) content.size());
+
+        // Recently accessed files are kept
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::hours(1)), (u64) 0);
+    }
+
+    CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 0);
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - The budget evicts the least recently used files") {
+    ResourceManager::Init();
+
+    {
+        constexpr u64 Size = 8192;
+        TempFile a("residency_a.bin", Size);
+        TempFile b("residency_b.bin", Size);
+        TempFile c("residency_c.bin", Size);
+
+        ResourceManager::SetResidencyBudget(2 * Size);
+
+        auto eA = ResourceManager::Load(a.path);
+        auto eB = ResourceManager::Load(b.path);
+        REQUIRE(eA.IsOk());
+        REQUIRE(eB.IsOk());
+
+        // a is touched last so b is the least recently used one when c comes in
+        REQUIRE(ResourceManager::DataConst(eA.Unwrap()).IsOk());
+
+        auto eC = ResourceManager::Load(c.path);
+        REQUIRE(eC.IsOk());
+
+        CHECK(ResourceManager::GetResidency(eA.Unwrap()).Unwrap().resident);
+        CHECK_FALSE(ResourceManager::GetResidency(eB.Unwrap()).Unwrap().resident);
+        CHECK(ResourceManager::GetResidency(eC.Unwrap()).Unwrap().resident);
+        CHECK_LE(ResourceManager::GetResidencyStats().residentBytes, 2 * Size);
+
+        // Accessing b brings it back and evicts a, the least recently used one by now
+        REQUIRE(ResourceManager::DataConst(eB.Unwrap()).IsOk());
+        CHECK_FALSE(ResourceManager::GetResidency(eA.Unwrap()).Unwrap().resident);
+        CHECK(ResourceManager::GetResidency(eB.Unwrap()).Unwrap().resident);
+        CHECK_EQ(ResourceManager::GetResidencyStats().evictions, (u64) 2);
+        CHECK_EQ(ResourceManager::GetResidencyStats().restores, (u64) 1);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - Files with a guard held are not evicted") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("residency.bin", 4096);
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path);
+        REQUIRE(eHandle.IsOk());
+
+        auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+        REQUIRE(guard.IsOk());
+
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), (u64) 0);
+        CHECK(ResourceManager::GetResidency(eHandle.Unwrap()).Unwrap().resident);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - Writable files keep their changes across evictions") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("residency.bin", 4096);
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, false);
+        REQUIRE(eHandle.IsOk());
+
+        {
+            auto guard = ResourceManager::Data(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            std::memcpy(guard.Unwrap().Data(), "written", 7);
+        }
+
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), (u64) 4096);
+        CHECK(ResourceManager::Sync(eHandle.Unwrap()));
+
+        auto guard = ResourceManager::Data(eHandle.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK_EQ(std::string_view(guard.Unwrap().Data(), 7), "written");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - Packed files are evicted and restored") {
+    ResourceManager::Init();
+
+    {
+        const std::string big = CompressibleData(100'000);
+        TempPack pack("test.axpk", {{"big.txt", big}}, true, 4096);
+        TempPack rawPack("raw.axpk", {{"raw.txt", big}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+        REQUIRE(ResourceManager::MountPack(rawPack.path, "assets/tests/raw"));
+
+        auto compressed = ResourceManager::Load("assets/tests/packed/big.txt");
+        auto raw = ResourceManager::Load("assets/tests/raw/raw.txt");
+        REQUIRE(compressed.IsOk());
+        REQUIRE(raw.IsOk());
+
+        // The decompressed buffer goes back to the pool
+        const u64 retained = ResourceManager::GetBufferPoolStats().retainedBytes;
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), 2 * (u64) big.size());
+        CHECK_GT(ResourceManager::GetBufferPoolStats().retainedBytes, retained);
+
+        auto guard = ResourceManager::DataConst(compressed.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == big);
+
+        auto rawGuard = ResourceManager::DataConst(raw.Unwrap());
+        REQUIRE(rawGuard.IsOk());
+        CHECK(std::string_view(rawGuard.Unwrap().Data(), rawGuard.Unwrap().Size()) == big);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - Resident bytes of the mapped files") {
+    ResourceManager::Init();
+
+    {
+        constexpr u64 Size = 64 * 1024 + 100;
+        TempFile file("resident.bin", Size);
+
+        ResourceManager::LoadOptions options;
+        options.prefault = true;
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, options);
+        REQUIRE(eHandle.IsOk());
+
+        // Prefaulted, every page is there and the partial last page only counts up to the end of the file
+        CHECK_EQ(ResourceManager::GetResidentBytes(eHandle.Unwrap().Get()).Unwrap(), Size);
+
+        std::vector<ResourceManager::MappedFileInfo> files = ResourceManager::GetMappedFiles();
+        REQUIRE_EQ(files.size(), (size_t) 1);
+        CHECK_EQ(files[0].handle, eHandle.Unwrap().Get());
+        CHECK_EQ(files[0].path.filename(), "resident.bin");
+        CHECK_EQ(files[0].mappedBytes, Size);
+        CHECK_EQ(files[0].residentBytes, Size);
+
+        ResourceManager::EvictIdle(std::chrono::nanoseconds(0));
+        CHECK_EQ(ResourceManager::GetResidentBytes(eHandle.Unwrap().Get()).Unwrap(), (u64) 0);
+        CHECK_EQ(ResourceManager::GetMappedFiles()[0].mappedBytes, (u64) 0);
+    }
+
+    CHECK(ResourceManager::GetMappedFiles().empty());
+    CHECK(ResourceManager::GetResidentBytes(1).IsErr());
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Residency - Faults are counted per frame") {
+    ResourceManager::Init();
+
+    // The first sample of a thread only sets the starting point
+    ResourceManager::FaultStats first = ResourceManager::SampleFrameFaults();
+    CHECK_EQ(first.minorFaults + first.majorFaults, (u64) 0);
+
+    {
+        // Fresh pages fault on their first write
+        std::vector<char> memory(8 << 20);
+        for (u64 i = 0; i < memory.size(); i += 4096)
+            memory[i] = 1;
+
+        ResourceManager::FaultStats frame = ResourceManager::SampleFrameFaults();
+        CHECK_GT(frame.minorFaults + frame.majorFaults, (u64) 0);
+        CHECK_EQ(ResourceManager::GetFrameFaults().minorFaults, frame.minorFaults);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+// Load options
+// ------------
+
+TEST_CASE("ResourceManager LoadOptions - Every mode serves the same data") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("options.txt", 0);
+        const std::string content = CompressibleData(300'000);
+        WriteFile(file.path, content);
+
+        using Access = ResourceManager::LoadOptions::Access;
+        std::vector<ResourceManager::LoadOptions> modes(6);
+        modes[1].prefault = true;
+        modes[2].access = Access::Sequential;
+        modes[3].access = Access::Random;
+        modes[4].hugePages = true;
+        modes[5].heapCopyMaxSize = content.size();
+
+        for (const ResourceManager::LoadOptions& options : modes) {
+            const u64 acquired = ResourceManager::GetBufferPoolStats().acquired;
+
+            Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, options);
+            REQUIRE(eHandle.IsOk());
+            CHECK_EQ(ResourceManager::Size(eHandle.Unwrap()).Unwrap(), (u64) content.size());
+
+            auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == content);
+
+            // Only the heap copy takes a buffer from the pool
+            CHECK_EQ(ResourceManager::GetBufferPoolStats().acquired, acquired + (options.heapCopyMaxSize != 0));
+        }
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager LoadOptions - Heap copies are read-only and survive evictions") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("options.txt", 0);
+        WriteFile(file.path, "copied into the heap");
+
+        ResourceManager::LoadOptions options = ResourceManager::LoadOptions::For(ResourceManager::AssetType::Shader);
+
+        // Writable files are always mapped
+        {
+            const u64 acquired = ResourceManager::GetBufferPoolStats().acquired;
+            Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, options, false);
+            REQUIRE(eHandle.IsOk());
+            CHECK(ResourceManager::Data(eHandle.Unwrap()).IsOk());
+            CHECK_EQ(ResourceManager::GetBufferPoolStats().acquired, acquired);
+        }
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, options);
+        REQUIRE(eHandle.IsOk());
+        CHECK(ResourceManager::IsReadOnly(eHandle.Unwrap()).Unwrap());
+        CHECK(ResourceManager::Data(eHandle.Unwrap()).IsErr());
+
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), (u64) 20);
+
+        auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK_EQ(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()), "copied into the heap");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager LoadOptions - Resizing a heap copy reads it again") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("options.txt", 0);
+        WriteFile(file.path, "0123456789");
+
+        ResourceManager::LoadOptions options;
+        options.heapCopyMaxSize = 4096;
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, options);
+        REQUIRE(eHandle.IsOk());
+        REQUIRE(ResourceManager::Resize(eHandle.Unwrap(), 4));
+
+        auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK_EQ(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()), "0123");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+// Dirty ranges
+// ------------
+
+static std::string ReadWholeFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+TEST_CASE("ResourceManager Sync - Only the marked pages are dirty") {
+    ResourceManager::Init();
+
+    {
+        constexpr u64 Page = 4096;
+        TempFile file("dirty.bin", 8 * Page);
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, false);
+        REQUIRE(eHandle.IsOk());
+        CHECK(ResourceManager::DirtyPages(eHandle.Unwrap()).empty());
+
+        {
+            auto guard = ResourceManager::Data(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            std::memcpy(guard.Unwrap().Data() + 10, "first", 5);
+            guard.Unwrap().MarkDirty(10, 5);
+            std::memcpy(guard.Unwrap().Data() + 5 * Page - 2, "second", 6);
+            guard.Unwrap().MarkDirty(5 * Page - 2, 6);
+        }
+
+        using Ranges = std::vector<std::pair<u64, u64>>;
+        CHECK_EQ(ResourceManager::DirtyPages(eHandle.Unwrap()), Ranges{{0, Page}, {4 * Page, 6 * Page}});
+
+        // Touching ranges are merged
+        {
+            auto guard = ResourceManager::Data(eHandle.Unwrap());
+            guard.Unwrap().MarkDirty(Page, 1);
+        }
+        CHECK_EQ(ResourceManager::DirtyPages(eHandle.Unwrap()), Ranges{{0, 2 * Page}, {4 * Page, 6 * Page}});
+
+        CHECK(ResourceManager::Sync(eHandle.Unwrap()));
+        CHECK(ResourceManager::DirtyPages(eHandle.Unwrap()).empty());
+
+        const std::string content = ReadWholeFile(file.path);
+        CHECK_EQ(content.substr(10, 5), "first");
+        CHECK_EQ(content.substr(5 * Page - 2, 6), "second");
+
+        // A guard that marks nothing dirties the whole file
+        { auto guard = ResourceManager::Data(eHandle.Unwrap()); }
+        CHECK_EQ(ResourceManager::DirtyPages(eHandle.Unwrap()), Ranges{{0, 8 * Page}});
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Sync - Too many dirty ranges are merged into one") {
+    ResourceManager::Init();
+
+    {
+        constexpr u64 Page = 4096;
+        TempFile file("dirty.bin", 100 * Page);
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, false);
+        REQUIRE(eHandle.IsOk());
+
+        {
+            auto guard = ResourceManager::Data(eHandle.Unwrap());
+            for (u64 page = 0; page < 100; page += 2)
+                guard.Unwrap().MarkDirty(page * Page, 1);
+        }
+
+        const auto ranges = ResourceManager::DirtyPages(eHandle.Unwrap());
+        CHECK_LE(ranges.size(), 32);
+        CHECK_EQ(ranges.front().first, 0);
+        CHECK_EQ(ranges.back().second, 99 * Page);
+        CHECK(ResourceManager::Sync(eHandle.Unwrap()));
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Sync - SyncAsync flushes on a job") {
+    ResourceManager::Init();
+    cw::JobSystem::Init(0);
+    CW_CONVERT_TO_WORKER("Tests");
+
+    {
+        TempFile file("dirty.bin", 4096);
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path, false);
+        REQUIRE(eHandle.IsOk());
+
+        {
+            auto guard = ResourceManager::Data(eHandle.Unwrap());
+            std::memcpy(guard.Unwrap().Data(), "async", 5);
+            guard.Unwrap().MarkDirty(0, 5);
+        }
+
+        CHECK(ResourceManager::SyncAsync(eHandle.Unwrap()));
+        cw::JobSystem::RunWorkerFor(std::chrono::milliseconds(10));
+
+        // The writeback was only started, a sync still waits for it
+        CHECK_FALSE(ResourceManager::DirtyPages(eHandle.Unwrap()).empty());
+        CHECK(ResourceManager::Sync(eHandle.Unwrap()));
+        CHECK_EQ(ReadWholeFile(file.path).substr(0, 5), "async");
+
+        auto readOnly = ResourceManager::Load("assets/tests/valid.txt");
+        REQUIRE(readOnly.IsOk());
+        CHECK_FALSE(ResourceManager::SyncAsync(readOnly.Unwrap()));
+    }
+
+    CW_DEREGISTER_WORKER;
+    cw::JobSystem::Shutdown();
+    ResourceManager::ShutDown();
+}
+
+// Hot reload
+// ----------
+
+TEST_CASE("ResourceManager Reload - The handle sees the new contents") {
+    ResourceManager::Init();
+
+    {
+        TempFile file("reload.txt", 0);
+        WriteFile(file.path, "before");
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path);
+        REQUIRE(eHandle.IsOk());
+        CHECK_EQ(ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap(), (u32) 0);
+
+        // Any spelling of the path finds it, files that aren't loaded aren't
+        CHECK_EQ(ResourceManager::Find("assets/tests/../tests/reload.txt").Unwrap(), eHandle.Unwrap().Get());
+        CHECK_EQ(ResourceManager::Find("assets/tests/valid.txt").UnwrapErr().code, ErrorCode::NotFound);
+
+        WriteFile(file.path, "after, and longer");
+        CHECK(ResourceManager::Reload(eHandle.Unwrap().Get()));
+        CHECK_EQ(ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap(), (u32) 1);
+
+        {
+            auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "after, and longer");
+        }
+
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 17);
+
+        // Removed while loaded, the version is bumped anyway and the next access fails until it's back
+        std::filesystem::remove(file.path);
+        CHECK_FALSE(ResourceManager::Reload(eHandle.Unwrap().Get()));
+        CHECK_EQ(ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap(), (u32) 2);
+        CHECK(ResourceManager::DataConst(eHandle.Unwrap()).IsErr());
+
+        WriteFile(file.path, "back");
+        CHECK(ResourceManager::Reload(eHandle.Unwrap().Get()));
+        CHECK_EQ(ResourceManager::Size(eHandle.Unwrap()).Unwrap(), (u64) 4);
+    }
+
+    CHECK(ResourceManager::GetVersion(1).IsErr());
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("FileWatcher - Changes are debounced into one reload") {
+    ResourceManager::Init();
+    FileWatcher::Init(std::chrono::milliseconds(50));
+
+    {
+        TempFile file("watched.txt", 0);
+        WriteFile(file.path, "v0");
+
+        Result<ResourceManager::ManagedFileHandle> eHandle = ResourceManager::Load(file.path);
+        REQUIRE(eHandle.IsOk());
+
+        u32 calls = 0;
+        FileWatcher::Subscription subscription =
+            FileWatcher::Subscribe(eHandle.Unwrap().Get(), [&calls]() { calls++; });
+
+        // Nothing changed yet
+        FileWatcher::Update();
+        CHECK_EQ(calls, (u32) 0);
+
+        for (u32 i = 1; i <= 5; i++)
+            WriteFile(file.path, "v" + std::to_string(i));
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (calls == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            FileWatcher::Update();
+        }
+
+        // Give a second batch the chance to show up if the writes weren't coalesced
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        FileWatcher::Update();
+
+        CHECK_EQ(calls, (u32) 1);
+        CHECK_EQ(ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap(), (u32) 1);
+
+        {
+            auto guard = ResourceManager::DataConst(eHandle.Unwrap());
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "v5");
+        }
+
+        // Once unsubscribed the reload still happens but nobody is called
+        subscription.Reset();
+        WriteFile(file.path, "v6");
+
+        const auto reloaded = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap() == 1 &&
+               std::chrono::steady_clock::now() < reloaded)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        FileWatcher::Update();
+        CHECK_EQ(calls, (u32) 1);
+        CHECK_EQ(ResourceManager::GetVersion(eHandle.Unwrap().Get()).Unwrap(), (u32) 2);
+    }
+
+    FileWatcher::ShutDown();
+    ResourceManager::ShutDown();
+}
+
+// Deduplication
+// -------------
+
+TEST_CASE("XxHash - Known vectors") {
+    auto hash = [](std::string_view s) { return XxHash::Hash64(s.data(), s.size()); };
+
+    CHECK_EQ(hash(""), (u64) 0xef46db3751d8e999);
+    CHECK_EQ(hash("a"), (u64) 0xd24ec4f1a98c6e5b);
+    CHECK_EQ(hash("abc"), (u64) 0x44bc2cf5ad770999);
+    // Long enough for the 32 byte stripes
+    CHECK_EQ(hash("Nobody inspects the spammish repetition"), (u64) 0xfbcea83c8a378bf1);
+}
+
+TEST_CASE("ResourceManager Dedup - Identical files share a mapping") {
+    ResourceManager::Init();
+
+    {
+        TempFile a("dedup_a.txt", 0);
+        TempFile b("dedup_b.txt", 0);
+        TempFile c("dedup_c.txt", 0);
+        WriteFile(a.path, "identical contents");
+        WriteFile(b.path, "identical contents");
+        WriteFile(c.path, "different contents");
+
+        ResourceManager::LoadOptions options;
+        options.deduplicate = true;
+
+        Result<ResourceManager::ManagedFileHandle> eA = ResourceManager::Load(a.path, options);
+        Result<ResourceManager::ManagedFileHandle> eB = ResourceManager::Load(b.path, options);
+        Result<ResourceManager::ManagedFileHandle> eC = ResourceManager::Load(c.path, options);
+        REQUIRE(eA.IsOk());
+        REQUIRE(eB.IsOk());
+        REQUIRE(eC.IsOk());
+
+        // Every path keeps its own handle, only the memory is shared
+        CHECK_NE(eA.Unwrap(), eB.Unwrap());
+        CHECK_NE(eA.Unwrap(), eC.Unwrap());
+        CHECK_EQ(ResourceManager::DataConst(eA.Unwrap()).Unwrap().Data(),
+                 ResourceManager::DataConst(eB.Unwrap()).Unwrap().Data());
+        CHECK_NE(ResourceManager::DataConst(eA.Unwrap()).Unwrap().Data(),
+                 ResourceManager::DataConst(eC.Unwrap()).Unwrap().Data());
+        CHECK_EQ(ResourceManager::GetContentHash(eA.Unwrap().Get()).Unwrap(),
+                 XxHash::Hash64("identical contents", 18));
+        CHECK_EQ(ResourceManager::GetContentHash(eB.Unwrap().Get()).Unwrap(),
+                 XxHash::Hash64("identical contents", 18));
+        CHECK_EQ(ResourceManager::GetPath(eB.Unwrap().Get()).Unwrap(), b.path);
+
+        // The shared mapping is counted once
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 36);
+
+        CHECK_EQ(ResourceManager::Find(b.path).Unwrap(), eB.Unwrap().Get());
+        CHECK_EQ(ResourceManager::Load(b.path, options).Unwrap(), eB.Unwrap());
+
+        // Writable and plain loads get their own mapping
+        ResourceManager::LoadOptions plain;
+        TempFile d("dedup_d.txt", 0);
+        TempFile e("dedup_e.txt", 0);
+        WriteFile(d.path, "identical contents");
+        WriteFile(e.path, "identical contents");
+
+        Result<ResourceManager::ManagedFileHandle> eD = ResourceManager::Load(d.path, options, false);
+        Result<ResourceManager::ManagedFileHandle> eE = ResourceManager::Load(e.path, plain);
+        REQUIRE(eD.IsOk());
+        REQUIRE(eE.IsOk());
+        CHECK_NE(ResourceManager::DataConst(eD.Unwrap()).Unwrap().Data(),
+                 ResourceManager::DataConst(eA.Unwrap()).Unwrap().Data());
+        CHECK_NE(ResourceManager::DataConst(eE.Unwrap()).Unwrap().Data(),
+                 ResourceManager::DataConst(eA.Unwrap()).Unwrap().Data());
+        CHECK_EQ(ResourceManager::GetContentHash(eD.Unwrap().Get()).Unwrap(), (u64) 0);
+        CHECK_EQ(ResourceManager::GetContentHash(eE.Unwrap().Get()).Unwrap(), (u64) 0);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Dedup - The shared mapping lives until its last file is released") {
+    ResourceManager::Init();
+
+    {
+        TempFile a("dedup_a.txt", 0);
+        TempFile b("dedup_b.txt", 0);
+        WriteFile(a.path, "identical contents");
+        WriteFile(b.path, "identical contents");
+
+        ResourceManager::LoadOptions options;
+        options.deduplicate = true;
+
+        std::optional<ResourceManager::ManagedFileHandle> handleA = ResourceManager::Load(a.path, options).Unwrap();
+        ResourceManager::ManagedFileHandle handleB = ResourceManager::Load(b.path, options).Unwrap();
+        REQUIRE_NE(*handleA, handleB);
+
+        handleA.reset();
+        CHECK(ResourceManager::Find(a.path).IsErr());
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 18);
+
+        {
+            auto guard = ResourceManager::DataConst(handleB);
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "identical contents");
+        }
+
+        const FileHandle closed = handleB.Get();
+        handleB = ResourceManager::ManagedFileHandle();
+
+        CHECK(ResourceManager::Find(b.path).IsErr());
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 0);
+
+        ResourceManager::ManagedFileHandle reloadedB = ResourceManager::Load(b.path, options).Unwrap();
+        CHECK_NE(reloadedB.Get(), closed);
+        CHECK_EQ(ResourceManager::GetPath(reloadedB.Get()).Unwrap(), b.path);
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Dedup - Evicting a shared file keeps the mapping for the others") {
+    ResourceManager::Init();
+
+    {
+        TempFile a("dedup_a.txt", 0);
+        TempFile b("dedup_b.txt", 0);
+        WriteFile(a.path, "identical contents");
+        WriteFile(b.path, "identical contents");
+
+        ResourceManager::LoadOptions options;
+        options.deduplicate = true;
+
+        ResourceManager::ManagedFileHandle handleA = ResourceManager::Load(a.path, options).Unwrap();
+        ResourceManager::ManagedFileHandle handleB = ResourceManager::Load(b.path, options).Unwrap();
+
+        // Only the second eviction frees the mapping
+        CHECK_EQ(ResourceManager::EvictIdle(std::chrono::nanoseconds(0)), (u64) 18);
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 0);
+        CHECK_EQ(ResourceManager::GetResidencyStats().evictions, (u64) 2);
+
+        // Mapped again from its own file
+        {
+            auto guard = ResourceManager::DataConst(handleB);
+            REQUIRE(guard.IsOk());
+            CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "identical contents");
+        }
+
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 18);
+        CHECK_EQ(ResourceManager::GetContentHash(handleB.Get()).Unwrap(), XxHash::Hash64("identical contents", 18));
+
+        auto guard = ResourceManager::DataConst(handleA);
+        REQUIRE(guard.IsOk());
+        CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "identical contents");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Dedup - Packed files share the hash stored in the pack") {
+    ResourceManager::Init();
+
+    {
+        TempFile loose("dedup_loose.txt", 0);
+        WriteFile(loose.path, "first packed file");
+
+        TempPack pack("test.axpk", {{"a.txt", "first packed file"}});
+        REQUIRE(ResourceManager::MountPack(pack.path, "assets/tests/packed"));
+
+        ResourceManager::LoadOptions options;
+        options.deduplicate = true;
+
+        Result<ResourceManager::ManagedFileHandle> ePacked =
+            ResourceManager::Load("assets/tests/packed/a.txt", options);
+        Result<ResourceManager::ManagedFileHandle> eLoose = ResourceManager::Load(loose.path, options);
+        REQUIRE(ePacked.IsOk());
+        REQUIRE(eLoose.IsOk());
+
+        CHECK_EQ(ResourceManager::DataConst(ePacked.Unwrap()).Unwrap().Data(),
+                 ResourceManager::DataConst(eLoose.Unwrap()).Unwrap().Data());
+        CHECK_EQ(ResourceManager::GetContentHash(eLoose.Unwrap().Get()).Unwrap(),
+                 XxHash::Hash64("first packed file", 17));
+
+        // The loose file can still be reloaded on its own, the packed one can't
+        WriteFile(loose.path, "changed loose file");
+        CHECK(ResourceManager::Reload(eLoose.Unwrap().Get()));
+        CHECK_FALSE(ResourceManager::Reload(ePacked.Unwrap().Get()));
+
+        auto guard = ResourceManager::DataConst(ePacked.Unwrap());
+        REQUIRE(guard.IsOk());
+        CHECK(std::string_view(guard.Unwrap().Data(), guard.Unwrap().Size()) == "first packed file");
+    }
+
+    ResourceManager::ShutDown();
+}
+
+TEST_CASE("ResourceManager Dedup - Reloading a file splits it off from the ones sharing its mapping") {
+    ResourceManager::Init();
+
+    {
+        TempFile a("dedup_a.txt", 0);
+        TempFile b("dedup_b.txt", 0);
+        TempFile c("dedup_c.txt", 0);
+        WriteFile(a.path, "identical contents");
+        WriteFile(b.path, "identical contents");
+        WriteFile(c.path, "identical contents");
+
+        ResourceManager::LoadOptions options;
+        options.deduplicate = true;
+
+        ResourceManager::ManagedFileHandle handleA = ResourceManager::Load(a.path, options).Unwrap();
+        ResourceManager::ManagedFileHandle handleB = ResourceManager::Load(b.path, options).Unwrap();
+
+        auto read = [](const ResourceManager::ManagedFileHandle& handle) {
+            auto guard = ResourceManager::DataConst(handle);
+            REQUIRE(guard.IsOk());
+            return std::string(guard.Unwrap().Data(), guard.Unwrap().Size());
+        };
+
+        // B changes on disk and is reloaded the way the file watcher does it
+        WriteFile(b.path, "changed contents of b");
+        REQUIRE(ResourceManager::Reload(ResourceManager::Find(b.path).Unwrap()));
+
+        CHECK(read(handleB) == "changed contents of b");
+        CHECK(read(handleA) == "identical contents");
+        CHECK_EQ(ResourceManager::GetVersion(handleB.Get()).Unwrap(), (u32) 1);
+        CHECK_EQ(ResourceManager::GetVersion(handleA.Get()).Unwrap(), (u32) 0);
+        CHECK_EQ(ResourceManager::GetContentHash(handleB.Get()).Unwrap(), (u64) 0);
+        CHECK_EQ(ResourceManager::GetContentHash(handleA.Get()).Unwrap(), XxHash::Hash64("identical contents", 18));
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 18 + 21);
+
+        // A file loaded afterwards with the old contents still shares A's mapping
+        ResourceManager::ManagedFileHandle handleC = ResourceManager::Load(c.path, options).Unwrap();
+        CHECK_NE(handleC, handleA);
+        CHECK_EQ(ResourceManager::DataConst(handleC).Unwrap().Data(),
+                 ResourceManager::DataConst(handleA).Unwrap().Data());
+
+        // Now A, whose file C's contents are mapped from, changes. C maps its own file again and reads the same.
+        WriteFile(a.path, "changed contents of a");
+        REQUIRE(ResourceManager::Reload(handleA.Get()));
+
+        CHECK(read(handleA) == "changed contents of a");
+        CHECK(read(handleC) == "identical contents");
+        CHECK(read(handleB) == "changed contents of b");
+        CHECK_EQ(ResourceManager::GetVersion(handleC.Get()).Unwrap(), (u32) 0);
+        CHECK_EQ(ResourceManager::GetContentHash(handleA.Get()).Unwrap(), (u64) 0);
+        CHECK_EQ(ResourceManager::GetResidencyStats().residentBytes, (u64) 18 + 21 + 21);
+    }
+
+    ResourceManager::ShutDown();
+}
+
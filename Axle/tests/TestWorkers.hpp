@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Core/Types.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <atomic>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Extra threads converted to workers, the hardware check in Init doesn't allow spawning them on small machines. They
+// run jobs from construction until the pool is destroyed, which has to happen before cw::JobSystem::Shutdown.
+struct WorkerPool {
+    std::stop_source stop;
+    std::vector<std::thread> threads;
+
+    explicit WorkerPool(Axle::u32 count, const char* name = "Test worker") {
+        std::atomic<Axle::u32> ready{0};
+
+        for (Axle::u32 i = 0; i < count; ++i) {
+            threads.emplace_back([this, &ready, name]() {
+                CW_CONVERT_TO_WORKER(name);
+                ready.fetch_add(1, std::memory_order_release);
+                cw::JobSystem::RunWorkerUntil(stop.get_token());
+                CW_DEREGISTER_WORKER;
+            });
+        }
+
+        while (ready.load(std::memory_order_acquire) != count)
+            std::this_thread::yield();
+    }
+
+    ~WorkerPool() {
+        stop.request_stop();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+};
@@ -0,0 +1,121 @@
+#include <doctest.h>
+
+#include "Core/Types.hpp"
+#include "Core/Parallel/Parallel.hpp"
+#include "Core/Threading/ThreadPlacement.hpp"
+#include "TestWorkers.hpp"
+
+#include <CoroWeaver.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Benchmarks are skipped by default, run them with: AxleTests --no-skip --test-case="*Bench*"
+
+using namespace Axle;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct FrameTimes {
+        f64 meanUs;
+        f64 stddevUs;
+        f64 p99Us;
+    };
+
+    std::atomic<u64> s_Sink{0};
+
+    // Some arithmetic over a buffer that fits in the L2 of most CPUs, so losing the cache to a migration shows
+    u64 Work(std::vector<u32>& data, u32 passes) {
+        u64 sum = 0;
+        for (u32 pass = 0; pass < passes; ++pass) {
+            for (u32& value : data) {
+                value = value * 1664525u + 1013904223u;
+                sum += value >> 16;
+            }
+        }
+        return sum;
+    }
+
+    // Frames shaped like the engine's: the render thread works on its own data while the main thread splits the
+    // update across the workers with ParallelFor
+    FrameTimes RunFrames(u32 frames) {
+        constexpr u32 Chunks = 64;
+
+        std::vector<std::vector<u32>> updateData(Chunks, std::vector<u32>(4096, 1));
+        std::vector<u32> renderData(64 * 1024, 1);
+        std::vector<f64> times;
+        times.reserve(frames);
+
+        for (u32 frame = 0; frame < frames; ++frame) {
+            const Clock::time_point start = Clock::now();
+
+            cw::JobCounter rendered(1);
+            auto render = [&renderData, &rendered]() {
+                s_Sink.fetch_add(Work(renderData, 4), std::memory_order_relaxed);
+                rendered.Decrement();
+            };
+            CW_SCHEDULE(render, cw::JobPriority::High, RENDER_THREAD_ID, cw::InvalidTag, "Bench render");
+
+            ParallelFor(0, Chunks, 1, [&updateData](u64 chunk) {
+                s_Sink.fetch_add(Work(updateData[chunk], 4), std::memory_order_relaxed);
+            });
+            rendered.Wait();
+
+            times.push_back(std::chrono::duration<f64, std::micro>(Clock::now() - start).count());
+        }
+
+        f64 mean = 0.0;
+        for (f64 time : times)
+            mean += time;
+        mean /= times.size();
+
+        f64 variance = 0.0;
+        for (f64 time : times)
+            variance += (time - mean) * (time - mean);
+        variance /= times.size();
+
+        std::sort(times.begin(), times.end());
+        return {mean, std::sqrt(variance), times[times.size() * 99 / 100]};
+    }
+} // namespace
+
+TEST_CASE("ThreadPlacement Bench - Frame time variance with and without pinning" * doctest::skip()) {
+    constexpr u32 Frames = 2000;
+    // Same amount of workers as the engine's default config, worker RENDER_THREAD_ID plays the render thread
+    constexpr u32 Workers = 3;
+
+    cw::JobSystem::Init(0);
+
+    {
+        // This thread stays out of the job system, like the main thread while Apply runs
+        WorkerPool pool(Workers, "Bench worker");
+
+        const CpuTopology topology = CpuTopology::Probe();
+        const ThreadPlacement pinned = ThreadPlacement::Plan(topology, Workers);
+        ThreadPlacement unpinned;
+        unpinned.workers.resize(Workers);
+
+        // Warm up the caches and the allocator
+        RunFrames(100);
+
+        REQUIRE(unpinned.Apply());
+        const FrameTimes free = RunFrames(Frames);
+
+        const bool applied = pinned.Apply();
+        const FrameTimes placed = RunFrames(Frames);
+
+        unpinned.Apply();
+
+        MESSAGE(topology.GetCores().size() << " cores, pinning " << (applied ? "applied" : "failed"));
+        MESSAGE("Unpinned: " << free.meanUs << " us mean, " << free.stddevUs << " us stddev, " << free.p99Us
+                             << " us p99");
+        MESSAGE("Pinned:   " << placed.meanUs << " us mean, " << placed.stddevUs << " us stddev, " << placed.p99Us
+                             << " us p99");
+    }
+
+    cw::JobSystem::Shutdown();
+}
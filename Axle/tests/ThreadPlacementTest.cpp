@@ -0,0 +1,143 @@
+#include <doctest.h>
+
+#include "Core/Types.hpp"
+#include "Core/Threading/ThreadPlacement.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Axle;
+
+namespace {
+    struct FakeCpu {
+        u32 core;
+        u64 maxFreq;
+        /// Last level cache, as the kernel lists it
+        std::string sharedCache;
+    };
+
+    // A sysfs CPU directory with just the files the probe reads, removed afterwards
+    struct FakeSysfs {
+        std::filesystem::path root;
+
+        FakeSysfs(const std::string& name, const std::string& online, const std::vector<FakeCpu>& cpus)
+            : root("assets/tests/" + name) {
+            std::filesystem::remove_all(root);
+            std::filesystem::create_directories(root);
+            Write(root / "online", online);
+
+            const std::vector<u32> ids = CpuTopology::ParseCpuList(online);
+            for (u64 i = 0; i < ids.size(); ++i) {
+                const std::filesystem::path cpu = root / ("cpu" + std::to_string(ids[i]));
+                Write(cpu / "topology" / "core_id", std::to_string(cpus[i].core));
+                Write(cpu / "topology" / "physical_package_id", "0");
+                Write(cpu / "cpufreq" / "cpuinfo_max_freq", std::to_string(cpus[i].maxFreq));
+                Write(cpu / "cache" / "index0" / "level", "1");
+                Write(cpu / "cache" / "index0" / "shared_cpu_list", std::to_string(ids[i]));
+                Write(cpu / "cache" / "index3" / "level", "3");
+                Write(cpu / "cache" / "index3" / "shared_cpu_list", cpus[i].sharedCache);
+            }
+        }
+
+        ~FakeSysfs() {
+            std::filesystem::remove_all(root);
+        }
+
+        static void Write(const std::filesystem::path& path, const std::string& content) {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream(path) << content << "\n";
+        }
+    };
+} // namespace
+
+TEST_CASE("ThreadPlacement - CPU lists are parsed like the kernel writes them") {
+    CHECK(CpuTopology::ParseCpuList("0-3,8,10-11\n") == std::vector<u32>{0, 1, 2, 3, 8, 10, 11});
+    CHECK(CpuTopology::ParseCpuList("5") == std::vector<u32>{5});
+    CHECK(CpuTopology::ParseCpuList("").empty());
+    CHECK(CpuTopology::ParseCpuList("3-1").empty());
+    CHECK(CpuTopology::ParseCpuList("0-x").empty());
+    CHECK(CpuTopology::ParseCpuList("0,,1").empty());
+}
+
+TEST_CASE("ThreadPlacement - Render and main get the fastest cores of a hybrid CPU") {
+    // Two performance cores with two threads each, then four efficiency cores, cpu 5 is offline
+    FakeSysfs sysfs("fake_cpu_hybrid",
+                    "0-4,6-7",
+                    {{0, 5'000'000, "0-7"},
+                     {0, 5'000'000, "0-7"},
+                     {1, 5'000'000, "0-7"},
+                     {1, 5'000'000, "0-7"},
+                     {8, 3'000'000, "0-7"},
+                     {10, 3'000'000, "0-7"},
+                     {11, 3'000'000, "0-7"}});
+
+    CpuTopology topology = CpuTopology::Probe(sysfs.root);
+    REQUIRE_EQ(topology.GetCpus().size(), (std::size_t) 7);
+    CHECK_EQ(topology.GetCpus()[4].capacity, (u64) 3'000'000);
+
+    std::vector<std::vector<u32>> cores = topology.GetCores();
+    REQUIRE_EQ(cores.size(), (std::size_t) 5);
+    CHECK(cores[0] == std::vector<u32>{0, 1});
+    CHECK(cores[1] == std::vector<u32>{2, 3});
+
+    ThreadPlacement placement = ThreadPlacement::Plan(topology, 3);
+    REQUIRE_EQ(placement.workers.size(), (std::size_t) 3);
+    CHECK(placement.workers[RENDER_THREAD_ID] == std::vector<u32>{0, 1});
+    CHECK(placement.main == std::vector<u32>{2, 3});
+    CHECK(placement.workers[1] == std::vector<u32>{4});
+    CHECK(placement.workers[2] == std::vector<u32>{6});
+
+    // More workers than cores left, they share them instead of doubling up on some
+    placement = ThreadPlacement::Plan(topology, 5);
+    for (u32 worker = 1; worker < 5; ++worker)
+        CHECK(placement.workers[worker] == std::vector<u32>{4, 6, 7});
+}
+
+TEST_CASE("ThreadPlacement - Cores sharing a cache are placed together") {
+    // Two cache groups with interleaved CPU ids, like some multi-CCX parts
+    FakeSysfs sysfs("fake_cpu_ccx",
+                    "0-3",
+                    {{0, 4'000'000, "0,2"}, {1, 4'000'000, "1,3"}, {2, 4'000'000, "0,2"}, {3, 4'000'000, "1,3"}});
+
+    CpuTopology topology = CpuTopology::Probe(sysfs.root);
+    CHECK_EQ(topology.GetCpus()[3].cacheGroup, (u32) 1);
+
+    ThreadPlacement placement = ThreadPlacement::Plan(topology, 3);
+    CHECK(placement.workers[RENDER_THREAD_ID] == std::vector<u32>{0});
+    CHECK(placement.main == std::vector<u32>{2});
+    CHECK(placement.workers[1] == std::vector<u32>{1});
+    CHECK(placement.workers[2] == std::vector<u32>{3});
+}
+
+TEST_CASE("ThreadPlacement - Small or unknown machines aren't pinned") {
+    ThreadPlacement placement = ThreadPlacement::Plan(CpuTopology::Probe("assets/tests/missing_cpu_dir"), 3);
+    CHECK(placement.main.empty());
+    for (const std::vector<u32>& cpus : placement.workers)
+        CHECK(cpus.empty());
+
+    FakeSysfs sysfs("fake_cpu_dual", "0-1", {{0, 0, "0-1"}, {1, 0, "0-1"}});
+    placement = ThreadPlacement::Plan(CpuTopology::Probe(sysfs.root), 2);
+    CHECK(placement.main.empty());
+    CHECK(placement.workers[RENDER_THREAD_ID].empty());
+}
+
+#ifdef AX_PLATFORM_LINUX
+TEST_CASE("ThreadPlacement - A thread can be pinned and unpinned") {
+    // On its own thread so the test runner keeps its affinity
+    std::thread thread([]() {
+        const std::vector<u32> allowed = GetCurrentThreadAffinity();
+        REQUIRE_FALSE(allowed.empty());
+
+        const std::vector<u32> single{allowed.back()};
+        CHECK(SetCurrentThreadAffinity(single));
+        CHECK(GetCurrentThreadAffinity() == single);
+
+        CHECK(SetCurrentThreadAffinity({}));
+        CHECK(GetCurrentThreadAffinity() == allowed);
+    });
+    thread.join();
+}
+#endif
@@ -26,7 +26,9 @@ public:
         : Layer("Learn") {}
     ~LearnLayer() override = default;
 
-    void OnAttach() override {}
+    void OnAttach() override {
+        SubscribeEvents(Events::Mask);
+    }
     void OnUpdate(f64 fixedDeltaTime) override {}
     void OnDettach() override {
         AX_INFO("Learn layer detached");
@@ -98,12 +100,12 @@ public:
     }
 
     void OnEvent(Event& event) override {
-        EventDispatcher dispatcher(event);
-        dispatcher.Dispatch<FrameBufferResizeEvent>(AX_BIND_EVENT_FN(OnFrameBufferResize));
-        dispatcher.Dispatch<KeyPressedEvent>(AX_BIND_EVENT_FN(OnKeyPressedEvent));
+        Events::Dispatch(event, AX_BIND_EVENT_FN(OnFrameBufferResize), AX_BIND_EVENT_FN(OnKeyPressedEvent));
     }
 
 private:
+    using Events = TypedEventDispatcher<FrameBufferResizeEvent, KeyPressedEvent>;
+
     Model model;
     Ref<Skybox> skybox;
     Ref<Shader> shader;